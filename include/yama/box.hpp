@@ -90,6 +90,18 @@ public:
         return true;
     }
 
+    // other is inside this or touches its sides from the inside
+    bool contains(const boxnt& other) const
+    {
+        for(size_t i=0; i<dimension; ++i)
+        {
+            if (other.min.at(i) < min.at(i) || other.max.at(i) > max.at(i))
+                return false;
+        }
+
+        return true;
+    }
+
     dim_vector size() const
     {
         return max - min;
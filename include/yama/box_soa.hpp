@@ -0,0 +1,293 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "box.hpp"
+#include "vector_soa.hpp"
+
+#include <cstdint>
+#include <limits>
+
+// Structure-of-arrays containers of D-dimensional boxes
+//
+// box_soa<D, T> holds the min and max corners of the boxes in two vector_soa_t streams
+// (separate min x, min y... lanes), so a box can be tested against all of them a pack at a time.
+// The results of the queries are either hit bits in 32-bit words (bit i % 32 of word i / 32)
+// or lists of indices.
+
+namespace yama
+{
+
+template <size_t D, typename T>
+class box_soa
+{
+public:
+    static constexpr size_t dimension = D;
+    using value_type = T;
+    using box = boxnt<D, T>;
+    using dim_vector = typename box::dim_vector;
+    using lanes = vector_soa_t<D, T>;
+    using pack = typename lanes::pack;
+
+    box_soa() = default;
+
+    box_soa(const box* in, size_t count)
+    {
+        assign(in, count);
+    }
+
+    ////////////////////////////////////////////////////////
+    // size
+
+    size_t size() const { return m_min.size(); }
+    size_t capacity() const { return m_min.capacity(); }
+    bool empty() const { return m_min.empty(); }
+
+    void reserve(size_t capacity)
+    {
+        m_min.reserve(capacity);
+        m_max.reserve(capacity);
+    }
+
+    // new boxes are zero
+    void resize(size_t size)
+    {
+        m_min.resize(size);
+        m_max.resize(size);
+    }
+
+    void clear()
+    {
+        m_min.clear();
+        m_max.clear();
+    }
+
+    void push_back(const box& b)
+    {
+        m_min.push_back(b.min);
+        m_max.push_back(b.max);
+    }
+
+    ////////////////////////////////////////////////////////
+    // access
+
+    box get(size_t i) const
+    {
+        return box::min_max(m_min.get(i), m_max.get(i));
+    }
+
+    void set(size_t i, const box& b)
+    {
+        m_min.set(i, b.min);
+        m_max.set(i, b.max);
+    }
+
+    lanes& min_corners() { return m_min; }
+    const lanes& min_corners() const { return m_min; }
+    lanes& max_corners() { return m_max; }
+    const lanes& max_corners() const { return m_max; }
+
+    ////////////////////////////////////////////////////////
+    // conversion from and to arrays of boxes
+
+    void assign(const box* in, size_t count)
+    {
+        clear();
+        resize(count);
+
+        size_t i = 0;
+        if constexpr (D == 3)
+        {
+            static_assert(sizeof(box) == 6 * sizeof(T), "yama::box_soa boxes must be arrays of 6 values");
+            const T* src = reinterpret_cast<const T*>(in);
+            for (; i + pack::width <= count; i += pack::width)
+            {
+                pack l[6];
+                simd::load3_pairs(src + 6 * i, l[0], l[1], l[2], l[3], l[4], l[5]);
+                for (size_t d = 0; d < 3; ++d)
+                {
+                    m_min.store_pack(d, i, l[d]);
+                    m_max.store_pack(d, i, l[3 + d]);
+                }
+            }
+        }
+        for (; i < count; ++i) set(i, in[i]);
+    }
+
+    // out must have room for size() boxes
+    void copy_to(box* out) const
+    {
+        for (size_t i = 0; i < size(); ++i) out[i] = get(i);
+    }
+
+private:
+    lanes m_min;
+    lanes m_max;
+};
+
+namespace impl
+{
+// the masks of the boxes in the pack at i which intersect b (as in boxnt::intersects)
+template <size_t D, typename T, typename P = typename box_soa<D, T>::pack>
+P soa_intersects(const box_soa<D, T>& boxes, const P (&bmin)[D], const P (&bmax)[D], size_t i)
+{
+    P ret = (boxes.min_corners().load_pack(0, i) < bmax[0]) & (boxes.max_corners().load_pack(0, i) > bmin[0]);
+    for (size_t d = 1; d < D; ++d)
+    {
+        ret = ret & (boxes.min_corners().load_pack(d, i) < bmax[d]) & (boxes.max_corners().load_pack(d, i) > bmin[d]);
+    }
+    return ret;
+}
+
+// calls f(i, bits) for each pack of the boxes with the bits of the ones which intersect b
+template <size_t D, typename T, typename F>
+void soa_intersect_packs(const box_soa<D, T>& boxes, const boxnt<D, T>& b, F f)
+{
+    using pack = typename box_soa<D, T>::pack;
+    pack bmin[D], bmax[D];
+    for (size_t d = 0; d < D; ++d)
+    {
+        bmin[d] = pack::uniform(b.min.at(d));
+        bmax[d] = pack::uniform(b.max.at(d));
+    }
+
+    const size_t size = boxes.size();
+    for (size_t i = 0; i < size; i += pack::width)
+    {
+        uint32_t bits = uint32_t(mask_bits(soa_intersects(boxes, bmin, bmax, i)));
+        if (size - i < pack::width) bits &= (uint32_t(1) << (size - i)) - 1; // the padding
+        f(i, bits);
+    }
+}
+}
+
+// sets bit i of the hits if box i intersects b (as in boxnt::intersects)
+// hits must have room for (size() + 31) / 32 words
+template <size_t D, typename T>
+void intersects(const box_soa<D, T>& boxes, const boxnt<D, T>& b, uint32_t* hits)
+{
+    static_assert(32 % box_soa<D, T>::pack::width == 0, "yama::box_soa packs must fill the hit words");
+    impl::soa_intersect_packs(boxes, b, [&](size_t i, uint32_t bits) {
+        if (i % 32 == 0) hits[i / 32] = 0;
+        hits[i / 32] |= bits << (i % 32);
+    });
+}
+
+// writes the indices of the boxes which intersect b in ascending order and returns their count
+// indices must have room for size() elements
+template <size_t D, typename T>
+size_t intersecting(const box_soa<D, T>& boxes, const boxnt<D, T>& b, uint32_t* indices)
+{
+    constexpr size_t W = box_soa<D, T>::pack::width;
+    size_t count = 0;
+    impl::soa_intersect_packs(boxes, b, [&](size_t i, uint32_t bits) {
+        if (!bits) return;
+        // write every index and advance past the hits (no branches)
+        // the writes after the last hit are overwritten or beyond the count
+        const size_t n = boxes.size() - i < W ? boxes.size() - i : W;
+        for (size_t j = 0; j < n; ++j)
+        {
+            indices[count] = uint32_t(i + j);
+            count += (bits >> j) & 1;
+        }
+    });
+    return count;
+}
+
+// the bounds of all boxes (inverted if there are none)
+template <size_t D, typename T>
+boxnt<D, T> bounds(const box_soa<D, T>& boxes)
+{
+    using pack = typename box_soa<D, T>::pack;
+    constexpr size_t W = pack::width;
+
+    // all packs are full here
+    const size_t full = boxes.size() / W * W;
+    const auto inv = boxnt<D, T>::inverted();
+    pack lo[D], hi[D];
+    for (size_t d = 0; d < D; ++d)
+    {
+        lo[d] = pack::uniform(inv.min.at(d));
+        hi[d] = pack::uniform(inv.max.at(d));
+    }
+    for (size_t i = 0; i < full; i += W)
+    {
+        for (size_t d = 0; d < D; ++d)
+        {
+            lo[d] = min(boxes.min_corners().load_pack(d, i), lo[d]);
+            hi[d] = max(boxes.max_corners().load_pack(d, i), hi[d]);
+        }
+    }
+
+    auto ret = inv;
+    for (size_t d = 0; d < D; ++d)
+    {
+        ret.min.at(d) = hmin(lo[d]);
+        ret.max.at(d) = hmax(hi[d]);
+    }
+    for (size_t i = full; i < boxes.size(); ++i) ret.merge(boxes.get(i));
+    return ret;
+}
+
+// the bounds of the boxes whose bits are set (as in the hits of intersects)
+// mask must have (size() + 31) / 32 words
+template <size_t D, typename T>
+boxnt<D, T> bounds(const box_soa<D, T>& boxes, const uint32_t* mask)
+{
+    using pack = typename box_soa<D, T>::pack;
+    constexpr size_t W = pack::width;
+    static_assert(32 % W == 0, "yama::box_soa packs must fill the mask words");
+
+    const auto inv = boxnt<D, T>::inverted();
+    pack lo[D], hi[D], inv_lo[D], inv_hi[D];
+    for (size_t d = 0; d < D; ++d)
+    {
+        lo[d] = inv_lo[d] = pack::uniform(inv.min.at(d));
+        hi[d] = inv_hi[d] = pack::uniform(inv.max.at(d));
+    }
+
+    const size_t size = boxes.size();
+    for (size_t i = 0; i < size; i += W)
+    {
+        uint32_t bits = (mask[i / 32] >> (i % 32)) & ((uint64_t(1) << W) - 1);
+        if (size - i < W) bits &= (uint32_t(1) << (size - i)) - 1;
+        if (!bits) continue;
+
+        // the boxes which are not in the subset are replaced by inverted ones
+        const pack m = pack::from_mask_bits(int(bits));
+        for (size_t d = 0; d < D; ++d)
+        {
+            lo[d] = min(select(m, boxes.min_corners().load_pack(d, i), inv_lo[d]), lo[d]);
+            hi[d] = max(select(m, boxes.max_corners().load_pack(d, i), inv_hi[d]), hi[d]);
+        }
+    }
+
+    auto ret = inv;
+    for (size_t d = 0; d < D; ++d)
+    {
+        ret.min.at(d) = hmin(lo[d]);
+        ret.max.at(d) = hmax(hi[d]);
+    }
+    return ret;
+}
+
+// the bounds of count boxes given by their indices (as in the output of intersecting)
+template <size_t D, typename T>
+boxnt<D, T> bounds(const box_soa<D, T>& boxes, const uint32_t* indices, size_t count)
+{
+    auto ret = boxnt<D, T>::inverted();
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t d = 0; d < D; ++d)
+        {
+            const T lo = boxes.min_corners().lane(d)[indices[i]];
+            const T hi = boxes.max_corners().lane(d)[indices[i]];
+            ret.min.at(d) = lo < ret.min.at(d) ? lo : ret.min.at(d);
+            ret.max.at(d) = hi > ret.max.at(d) ? hi : ret.max.at(d);
+        }
+    }
+    return ret;
+}
+
+}
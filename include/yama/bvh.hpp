@@ -0,0 +1,429 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "box.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+// Bounding volume hierarchy of D-dimensional boxes
+//
+// It's built once from an array of boxes with a binned surface area heuristic.
+// The nodes are stored in a flat array with the two children of a node next to each other.
+// The boxes of the items are copied in leaf order, so a leaf tests a contiguous range.
+// Queries traverse the tree with an explicit stack (no recursion) and report the indices
+// of the items in the original array.
+// When the items move, the tree can be refit to their new boxes without rebuilding it.
+// For items which come and go, see dynamic_bvh.hpp.
+
+namespace yama
+{
+
+namespace impl
+{
+// a stack for the tree traversals
+// it lives on the stack of the caller unless the tree is very deep
+template <typename E>
+class bvh_stack
+{
+public:
+    explicit bvh_stack(size_t capacity)
+    {
+        if (capacity > local_capacity)
+        {
+            m_heap.resize(capacity);
+            m_data = m_heap.data();
+        }
+    }
+
+    void push(const E& e) { m_data[m_size++] = e; }
+    E pop() { return m_data[--m_size]; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    static constexpr size_t local_capacity = 64;
+    E m_local[local_capacity];
+    E* m_data = m_local;
+    size_t m_size = 0;
+    std::vector<E> m_heap;
+};
+
+// query callbacks may return void or a bool (false to stop the query)
+template <typename F, typename... Args>
+bool bvh_visit(F& f, Args&&... args)
+{
+    if constexpr (std::is_void<decltype(f(std::forward<Args>(args)...))>::value)
+    {
+        f(std::forward<Args>(args)...);
+        return true;
+    }
+    else
+    {
+        return f(std::forward<Args>(args)...);
+    }
+}
+
+// half of the surface area of a box (the perimeter in 2d)
+template <size_t D, typename T>
+T half_area(const boxnt<D, T>& b)
+{
+    const auto s = b.size();
+    T ret = 0;
+    for (size_t i = 0; i < D; ++i)
+    {
+        T face = 1;
+        for (size_t j = 0; j < D; ++j)
+        {
+            if (j != i) face *= s.at(j);
+        }
+        ret += face;
+    }
+    return ret;
+}
+
+// slab test of the segment origin + t * direction, t in [0, max_t]
+// inv_dir is the per-component inverse of the direction
+// on a hit returns true and the t at which the segment enters the box
+template <size_t D, typename T, typename V>
+bool ray_hits(const boxnt<D, T>& b, const V& origin, const V& inv_dir, T max_t, T& t_enter)
+{
+    T t0 = 0, t1 = max_t;
+    for (size_t i = 0; i < D; ++i)
+    {
+        T t_near = (b.min.at(i) - origin.at(i)) * inv_dir.at(i);
+        T t_far = (b.max.at(i) - origin.at(i)) * inv_dir.at(i);
+        if (t_near > t_far) std::swap(t_near, t_far);
+        // written so that NaN (from 0 * inf) leaves the interval as it is
+        t0 = t_near > t0 ? t_near : t0;
+        t1 = t_far < t1 ? t_far : t1;
+    }
+    t_enter = t0;
+    return t0 <= t1;
+}
+}
+
+template <size_t D, typename T>
+class bvh
+{
+public:
+    static const size_t dimension = D;
+    using box = boxnt<D, T>;
+    using dim_vector = typename box::dim_vector;
+    using index_type = uint32_t;
+
+    struct node
+    {
+        box bounds;
+        index_type first; // leaf: the first item in leaf order, inner node: the left child (the right one is next)
+        index_type count; // leaf: the number of items, inner node: 0
+
+        bool is_leaf() const { return count != 0; }
+    };
+
+    // the number of bins per axis of the surface area heuristic
+    static constexpr size_t bin_count = 16;
+
+    bvh() = default;
+
+    bvh(const box* boxes, size_t count, size_t max_leaf_size = 4)
+    {
+        build(boxes, count, max_leaf_size);
+    }
+
+    void build(const box* boxes, size_t count, size_t max_leaf_size = 4)
+    {
+        YAMA_ASSERT_CRIT(count < std::numeric_limits<index_type>::max(), "yama::bvh too many items");
+        YAMA_ASSERT_CRIT(max_leaf_size > 0, "yama::bvh leaves must be able to hold items");
+
+        m_nodes.clear();
+        m_items.resize(count);
+        std::iota(m_items.begin(), m_items.end(), index_type(0));
+        m_depth = 0;
+
+        if (count == 0)
+        {
+            m_boxes.clear();
+            return;
+        }
+
+        std::vector<dim_vector> centers(count);
+        for (size_t i = 0; i < count; ++i) centers[i] = boxes[i].center();
+
+        m_nodes.reserve(2 * count - 1);
+        m_nodes.emplace_back();
+
+        struct task { index_type node, begin, end, depth; };
+        std::vector<task> tasks = {{0, 0, index_type(count), 1}};
+        while (!tasks.empty())
+        {
+            const auto t = tasks.back();
+            tasks.pop_back();
+            m_depth = std::max(m_depth, size_t(t.depth));
+
+            auto bounds = box::inverted();
+            auto center_bounds = box::inverted();
+            for (index_type i = t.begin; i < t.end; ++i)
+            {
+                bounds.merge(boxes[m_items[i]]);
+                center_bounds.add_point(centers[m_items[i]]);
+            }
+
+            auto& n = m_nodes[t.node];
+            n.bounds = bounds;
+
+            if (t.end - t.begin <= max_leaf_size)
+            {
+                n.first = t.begin;
+                n.count = t.end - t.begin;
+                continue;
+            }
+
+            const index_type mid = split(boxes, centers.data(), t.begin, t.end, center_bounds);
+
+            n.first = index_type(m_nodes.size());
+            n.count = 0;
+            tasks.push_back({n.first + 1, mid, t.end, t.depth + 1});
+            tasks.push_back({n.first, t.begin, mid, t.depth + 1});
+            m_nodes.emplace_back();
+            m_nodes.emplace_back();
+        }
+
+        m_boxes.resize(count);
+        for (size_t i = 0; i < count; ++i) m_boxes[i] = boxes[m_items[i]];
+    }
+
+    // updates the bounds of the nodes after the boxes have moved, keeping the structure of the tree
+    // the boxes are in the original order and as many as the ones given to build
+    // the tree gets worse as the boxes move away from where they were when it was built,
+    // so it's a good idea to rebuild it from time to time
+    void refit(const box* boxes)
+    {
+        for (size_t i = 0; i < m_boxes.size(); ++i) m_boxes[i] = boxes[m_items[i]];
+
+        // bottom-up: the children of a node are always after it in the array
+        for (size_t i = m_nodes.size(); i-- > 0; )
+        {
+            auto& n = m_nodes[i];
+            if (n.is_leaf())
+            {
+                n.bounds = m_boxes[n.first];
+                for (size_t j = n.first + 1; j < n.first + n.count; ++j) n.bounds.merge(m_boxes[j]);
+            }
+            else
+            {
+                n.bounds = m_nodes[n.first].bounds;
+                n.bounds.merge(m_nodes[n.first + 1].bounds);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////
+    // queries
+    // the callbacks may return void, or a bool: false to stop the query
+
+    // calls f(index) for the items whose boxes intersect b
+    template <typename F>
+    void query(const box& b, F f) const
+    {
+        traverse([&](const box& bounds) { return bounds.intersects(b); },
+            [&](size_t i) { return !m_boxes[i].intersects(b) || impl::bvh_visit(f, size_t(m_items[i])); });
+    }
+
+    // calls f(index) for the items whose boxes contain p
+    template <typename F>
+    void query(const dim_vector& p, F f) const
+    {
+        traverse([&](const box& bounds) { return bounds.is_inside(p); },
+            [&](size_t i) { return !m_boxes[i].is_inside(p) || impl::bvh_visit(f, size_t(m_items[i])); });
+    }
+
+    // calls f(index, max_t) for the items whose boxes are hit by origin + t * direction, t in [0, max_t]
+    // the nodes are visited front to back
+    // f can reduce max_t (say to the distance of a hit for the closest hit), which prunes the rest of the traversal
+    template <typename F>
+    void query_ray(const dim_vector& origin, const dim_vector& direction, T max_t, F f) const
+    {
+        if (m_nodes.empty()) return;
+
+        dim_vector inv_dir;
+        for (size_t i = 0; i < D; ++i) inv_dir.at(i) = T(1) / direction.at(i);
+
+        struct entry { index_type node; T t; };
+        impl::bvh_stack<entry> stack(m_depth + 1);
+
+        T t;
+        if (!impl::ray_hits(m_nodes.front().bounds, origin, inv_dir, max_t, t)) return;
+        stack.push({0, t});
+
+        while (!stack.empty())
+        {
+            const auto e = stack.pop();
+            if (e.t > max_t) continue; // max_t was reduced after it was pushed
+
+            const auto& n = m_nodes[e.node];
+            if (n.is_leaf())
+            {
+                for (size_t i = n.first; i < n.first + n.count; ++i)
+                {
+                    if (!impl::ray_hits(m_boxes[i], origin, inv_dir, max_t, t)) continue;
+                    if (!impl::bvh_visit(f, size_t(m_items[i]), max_t)) return;
+                }
+                continue;
+            }
+
+            T tl, tr;
+            const bool hl = impl::ray_hits(m_nodes[n.first].bounds, origin, inv_dir, max_t, tl);
+            const bool hr = impl::ray_hits(m_nodes[n.first + 1].bounds, origin, inv_dir, max_t, tr);
+
+            // push the far one first, so that the near one is popped first
+            if (hl && hr)
+            {
+                if (tl <= tr)
+                {
+                    stack.push({n.first + 1, tr});
+                    stack.push({n.first, tl});
+                }
+                else
+                {
+                    stack.push({n.first, tl});
+                    stack.push({n.first + 1, tr});
+                }
+            }
+            else if (hl) stack.push({n.first, tl});
+            else if (hr) stack.push({n.first + 1, tr});
+        }
+    }
+
+    ////////////////////////////////////////////////////////
+    // access
+
+    bool empty() const { return m_items.empty(); }
+    size_t size() const { return m_items.size(); }
+
+    // the number of levels
+    size_t depth() const { return m_depth; }
+
+    // the bounds of all items
+    box bounds() const { return m_nodes.empty() ? box::inverted() : m_nodes.front().bounds; }
+
+    // the root is the first node
+    const std::vector<node>& nodes() const { return m_nodes; }
+
+    // the indices of the items in leaf order
+    const std::vector<index_type>& items() const { return m_items; }
+
+private:
+    // depth-first traversal
+    // enter(bounds) decides whether to enter a node, item(i) is called for the items (in leaf order)
+    // of the entered leaves and returns false to stop
+    template <typename Enter, typename Item>
+    void traverse(Enter enter, Item item) const
+    {
+        if (m_nodes.empty() || !enter(m_nodes.front().bounds)) return;
+
+        impl::bvh_stack<index_type> stack(m_depth + 1);
+        stack.push(0);
+        while (!stack.empty())
+        {
+            const auto& n = m_nodes[stack.pop()];
+            if (n.is_leaf())
+            {
+                for (size_t i = n.first; i < n.first + n.count; ++i)
+                {
+                    if (!item(i)) return;
+                }
+                continue;
+            }
+
+            if (enter(m_nodes[n.first + 1].bounds)) stack.push(n.first + 1);
+            if (enter(m_nodes[n.first].bounds)) stack.push(n.first);
+        }
+    }
+
+    // partitions the items in [begin, end) and returns the start of the second half
+    index_type split(const box* boxes, const dim_vector* centers, index_type begin, index_type end, const box& center_bounds)
+    {
+        struct bin
+        {
+            box bounds = box::inverted();
+            size_t count = 0;
+        };
+
+        auto bin_of = [&](index_type item, size_t axis, T lo, T scale) {
+            const auto b = size_t((centers[item].at(axis) - lo) * scale);
+            return std::min(b, bin_count - 1);
+        };
+
+        T best_cost = std::numeric_limits<T>::max();
+        size_t best_axis = D, best_split = 0;
+
+        for (size_t axis = 0; axis < D; ++axis)
+        {
+            const T lo = center_bounds.min.at(axis);
+            const T extent = center_bounds.max.at(axis) - lo;
+            if (extent <= 0) continue;
+            const T scale = T(bin_count) / extent;
+
+            bin bins[bin_count];
+            for (index_type i = begin; i < end; ++i)
+            {
+                auto& b = bins[bin_of(m_items[i], axis, lo, scale)];
+                b.bounds.merge(boxes[m_items[i]]);
+                ++b.count;
+            }
+
+            // sweep from the right to get the costs of the right sides, then from the left
+            T right_cost[bin_count];
+            auto acc = box::inverted();
+            size_t acc_count = 0;
+            for (size_t s = bin_count - 1; s > 0; --s)
+            {
+                acc.merge(bins[s].bounds);
+                acc_count += bins[s].count;
+                right_cost[s] = acc_count ? impl::half_area(acc) * T(acc_count) : 0;
+            }
+
+            acc = box::inverted();
+            acc_count = 0;
+            for (size_t s = 1; s < bin_count; ++s)
+            {
+                acc.merge(bins[s - 1].bounds);
+                acc_count += bins[s - 1].count;
+                if (acc_count == 0 || acc_count == size_t(end - begin)) continue;
+                const T cost = impl::half_area(acc) * T(acc_count) + right_cost[s];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = s;
+                }
+            }
+        }
+
+        if (best_axis == D)
+        {
+            // all centers are the same: any split is as good as another
+            return begin + (end - begin) / 2;
+        }
+
+        const T lo = center_bounds.min.at(best_axis);
+        const T scale = T(bin_count) / (center_bounds.max.at(best_axis) - lo);
+        const auto mid = std::partition(m_items.begin() + begin, m_items.begin() + end, [&](index_type item) {
+            return bin_of(item, best_axis, lo, scale) < best_split;
+        });
+        return index_type(mid - m_items.begin());
+    }
+
+    std::vector<node> m_nodes;
+    std::vector<index_type> m_items; // leaf order
+    std::vector<box> m_boxes; // leaf order
+    size_t m_depth = 0;
+};
+
+}
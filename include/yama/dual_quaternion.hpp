@@ -0,0 +1,303 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "util.hpp"
+#include "shorthand.hpp"
+#include "type_traits.hpp"
+
+#include "quaternion.hpp"
+#include "matrix3x4.hpp"
+
+// Dual quaternions represent rigid transformations (rotation and translation) with 8 values.
+// A unit dual quaternion has a unit real part and a dual part orthogonal to it.
+// Unlike matrices, they can be blended (a weighted sum, followed by normalization)
+// without skewing the result, which makes them good for skinning.
+
+namespace yama
+{
+
+template <typename T>
+class dual_quaternion_t
+{
+public:
+    quaternion_t<T> real; // the rotation
+    quaternion_t<T> dual; // half the translation times the rotation
+
+    using value_type = T;
+    using size_type = size_t;
+
+    static constexpr size_type value_count = 8;
+
+    constexpr size_type max_size() const { return value_count; }
+    constexpr size_type size() const { return max_size(); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // named constructors
+    static constexpr dual_quaternion_t real_dual(const quaternion_t<T>& real, const quaternion_t<T>& dual)
+    {
+        return{ real, dual };
+    }
+
+    static constexpr dual_quaternion_t identity()
+    {
+        return real_dual(quaternion_t<T>::identity(), quaternion_t<T>::zero());
+    }
+
+    static constexpr dual_quaternion_t zero()
+    {
+        return real_dual(quaternion_t<T>::zero(), quaternion_t<T>::zero());
+    }
+
+    static dual_quaternion_t from_ptr(const value_type* ptr)
+    {
+        YAMA_ASSERT_CRIT(ptr, "Constructing yama::dual_quaternion_t from nullptr");
+        return real_dual(quaternion_t<T>::from_ptr(ptr), quaternion_t<T>::from_ptr(ptr + 4));
+    }
+
+    static constexpr dual_quaternion_t rotation(const quaternion_t<T>& q)
+    {
+        return real_dual(q, quaternion_t<T>::zero());
+    }
+
+    static constexpr dual_quaternion_t translation(const vector3_t<T>& t)
+    {
+        return real_dual(quaternion_t<T>::identity(), quaternion_t<T>::xyzw(t.x / 2, t.y / 2, t.z / 2, 0));
+    }
+
+    // rotation by q, followed by translation by t
+    static dual_quaternion_t rotation_translation(const quaternion_t<T>& q, const vector3_t<T>& t)
+    {
+        YAMA_ASSERT_BAD(q.is_normalized(), "yama::dual_quaternion_t with a non-normalized rotation");
+        return real_dual(q, quaternion_t<T>::xyzw(t.x / 2, t.y / 2, t.z / 2, 0) * q);
+    }
+
+    // the matrix must be a rigid transformation (rotation and translation)
+    static dual_quaternion_t rigid_matrix(const matrix3x4_t<T>& m)
+    {
+        // Shepperd's method: start from the largest of the diagonal-based terms
+        const T trace = m.m00 + m.m11 + m.m22;
+        quaternion_t<T> q;
+        if (trace > 0)
+        {
+            const T s = 2 * std::sqrt(trace + 1);
+            q = quaternion_t<T>::xyzw((m.m21 - m.m12) / s, (m.m02 - m.m20) / s, (m.m10 - m.m01) / s, s / 4);
+        }
+        else if (m.m00 > m.m11 && m.m00 > m.m22)
+        {
+            const T s = 2 * std::sqrt(1 + m.m00 - m.m11 - m.m22);
+            q = quaternion_t<T>::xyzw(s / 4, (m.m01 + m.m10) / s, (m.m02 + m.m20) / s, (m.m21 - m.m12) / s);
+        }
+        else if (m.m11 > m.m22)
+        {
+            const T s = 2 * std::sqrt(1 + m.m11 - m.m00 - m.m22);
+            q = quaternion_t<T>::xyzw((m.m01 + m.m10) / s, s / 4, (m.m12 + m.m21) / s, (m.m02 - m.m20) / s);
+        }
+        else
+        {
+            const T s = 2 * std::sqrt(1 + m.m22 - m.m00 - m.m11);
+            q = quaternion_t<T>::xyzw((m.m02 + m.m20) / s, (m.m12 + m.m21) / s, s / 4, (m.m10 - m.m01) / s);
+        }
+
+        return rotation_translation(yama::normalize(q), vector3_t<T>::coord(m.m03, m.m13, m.m23));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // access
+    value_type* data()
+    {
+        return real.data();
+    }
+
+    constexpr const value_type* data() const
+    {
+        return real.data();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // arithmetic
+
+    constexpr dual_quaternion_t operator-() const
+    {
+        return real_dual(-real, -dual);
+    }
+
+    dual_quaternion_t& operator+=(const dual_quaternion_t& b)
+    {
+        real += b.real;
+        dual += b.dual;
+        return *this;
+    }
+
+    dual_quaternion_t& operator-=(const dual_quaternion_t& b)
+    {
+        real -= b.real;
+        dual -= b.dual;
+        return *this;
+    }
+
+    dual_quaternion_t& operator*=(const value_type& s)
+    {
+        real *= s;
+        dual *= s;
+        return *this;
+    }
+
+    // composition: the result transforms by b, then by this
+    dual_quaternion_t& operator*=(const dual_quaternion_t& b)
+    {
+        dual = real * b.dual + dual * b.real;
+        real *= b.real;
+        return *this;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // utils
+
+    vector3_t<T> translation() const
+    {
+        const auto t = dual * yama::conjugate(real);
+        return vector3_t<T>::coord(2 * t.x, 2 * t.y, 2 * t.z);
+    }
+
+    matrix3x4_t<T> to_matrix3x4() const
+    {
+        auto ret = matrix3x4_t<T>::rotation_quaternion(real);
+        const auto t = translation();
+        ret.m03 = t.x;
+        ret.m13 = t.y;
+        ret.m23 = t.z;
+        return ret;
+    }
+
+    // the inverse of a unit dual quaternion
+    dual_quaternion_t& conjugate()
+    {
+        real.conjugate();
+        dual.conjugate();
+        return *this;
+    }
+
+    // makes the real part unit and the dual part orthogonal to it
+    // returns the length of the real part before that
+    value_type normalize()
+    {
+        const auto l = real.length();
+        YAMA_ASSERT_WARN(l, "Normalizing a yama::dual_quaternion_t with a zero-length real part");
+        real /= l;
+        dual /= l;
+        dual -= real * yama::dot(real, dual);
+        return l;
+    }
+
+    bool is_normalized() const
+    {
+        return real.is_normalized() && close(yama::dot(real, dual), value_type(0));
+    }
+};
+
+template <typename T>
+dual_quaternion_t<T> operator+(const dual_quaternion_t<T>& a, const dual_quaternion_t<T>& b)
+{
+    return dual_quaternion_t<T>::real_dual(a.real + b.real, a.dual + b.dual);
+}
+
+template <typename T>
+dual_quaternion_t<T> operator-(const dual_quaternion_t<T>& a, const dual_quaternion_t<T>& b)
+{
+    return dual_quaternion_t<T>::real_dual(a.real - b.real, a.dual - b.dual);
+}
+
+template <typename T>
+dual_quaternion_t<T> operator*(const dual_quaternion_t<T>& a, const T& s)
+{
+    return dual_quaternion_t<T>::real_dual(a.real * s, a.dual * s);
+}
+
+template <typename T>
+dual_quaternion_t<T> operator*(const T& s, const dual_quaternion_t<T>& b)
+{
+    return dual_quaternion_t<T>::real_dual(s * b.real, s * b.dual);
+}
+
+// composition: the result transforms by b, then by a
+template <typename T>
+dual_quaternion_t<T> operator*(const dual_quaternion_t<T>& a, const dual_quaternion_t<T>& b)
+{
+    return dual_quaternion_t<T>::real_dual(a.real * b.real, a.real * b.dual + a.dual * b.real);
+}
+
+template <typename T>
+bool operator==(const dual_quaternion_t<T>& a, const dual_quaternion_t<T>& b)
+{
+    return a.real == b.real && a.dual == b.dual;
+}
+
+template <typename T>
+bool operator!=(const dual_quaternion_t<T>& a, const dual_quaternion_t<T>& b)
+{
+    return a.real != b.real || a.dual != b.dual;
+}
+
+template <typename T>
+bool close(const dual_quaternion_t<T>& a, const dual_quaternion_t<T>& b, const T& epsilon = constants_t<T>::EPSILON)
+{
+    return close(a.real, b.real, epsilon) && close(a.dual, b.dual, epsilon);
+}
+
+template <typename T>
+bool isfinite(const dual_quaternion_t<T>& a)
+{
+    return isfinite(a.real) && isfinite(a.dual);
+}
+
+template <typename T>
+dual_quaternion_t<T> conjugate(const dual_quaternion_t<T>& a)
+{
+    return dual_quaternion_t<T>::real_dual(conjugate(a.real), conjugate(a.dual));
+}
+
+template <typename T>
+dual_quaternion_t<T> normalize(const dual_quaternion_t<T>& a)
+{
+    auto ret = a;
+    ret.normalize();
+    return ret;
+}
+
+template <typename T>
+vector3_t<T> transform_coord(const vector3_t<T>& v, const dual_quaternion_t<T>& dq)
+{
+    const auto& r = dq.real;
+    const auto& d = dq.dual;
+    const auto rv = vector3_t<T>::coord(r.x, r.y, r.z);
+    const auto dv = vector3_t<T>::coord(d.x, d.y, d.z);
+
+    // rotate(v, r) + 2 * (d * conjugate(r))
+    const auto t = cross(rv, v) * T(2);
+    const auto rotated = v + t * r.w + cross(rv, t);
+    return rotated + (dv * r.w - rv * d.w + cross(rv, dv)) * T(2);
+}
+
+template <typename T>
+vector3_t<T> transform_normal(const vector3_t<T>& v, const dual_quaternion_t<T>& dq)
+{
+    return rotate(v, dq.real);
+}
+
+// type traits
+template <typename T>
+struct is_yama<dual_quaternion_t<T>> : public std::true_type {};
+
+// shorthand
+#if !defined(YAMA_NO_SHORTHAND)
+
+using dual_quaternion = dual_quaternion_t<preferred_type>;
+
+#endif
+
+}
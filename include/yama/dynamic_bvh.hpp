@@ -0,0 +1,437 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "bvh.hpp"
+
+// Dynamic bounding volume hierarchy of D-dimensional boxes
+//
+// Items can be inserted, removed, and moved one by one. Each leaf stores a fat box: the box
+// of the item grown by a margin. Moving an item within its fat box costs nothing and only
+// the items which leave theirs are reinserted. Insertion picks the sibling with the smallest
+// increase of surface area. On the way up the nodes are rotated when that reduces the areas
+// of their children, which keeps the tree good when the items come in an unlucky order.
+//
+// The nodes live in an array with a free list. The leaf ids returned by insert stay the
+// same until the item is removed, and are reused after that.
+
+namespace yama
+{
+
+template <size_t D, typename T>
+class dynamic_bvh
+{
+public:
+    static const size_t dimension = D;
+    using box = boxnt<D, T>;
+    using dim_vector = typename box::dim_vector;
+    using index_type = uint32_t;
+
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+
+    struct node
+    {
+        box bounds; // leaf: the fat box
+        index_type parent; // free node: the next free node
+        index_type children[2]; // leaf: null_index
+        int32_t height; // leaf: 0, free node: -1
+
+        bool is_leaf() const { return children[0] == null_index; }
+    };
+
+    // margin is added on all sides of the boxes of the items
+    explicit dynamic_bvh(T margin = T(0.1))
+        : m_margin(margin)
+    {}
+
+    void clear()
+    {
+        m_nodes.clear();
+        m_root = null_index;
+        m_free = null_index;
+        m_size = 0;
+    }
+
+    // returns the id of the leaf of the item
+    index_type insert(const box& b)
+    {
+        const auto leaf = allocate();
+        auto& n = m_nodes[leaf];
+        n.bounds = fatten(b);
+        n.children[0] = n.children[1] = null_index;
+        n.height = 0;
+        insert_leaf(leaf);
+        ++m_size;
+        return leaf;
+    }
+
+    void remove(index_type id)
+    {
+        YAMA_ASSERT_CRIT(id < m_nodes.size() && m_nodes[id].is_leaf() && m_nodes[id].height == 0, "yama::dynamic_bvh removing a bad id");
+        remove_leaf(id);
+        release(id);
+        --m_size;
+    }
+
+    // b is the new box of the item, displacement its expected movement until the next update (it grows the fat box)
+    // the item is reinserted only if b is no longer in its fat box, or if the fat box became much larger than needed
+    // returns whether it was reinserted
+    bool update(index_type id, const box& b, const dim_vector& displacement = dim_vector::zero())
+    {
+        YAMA_ASSERT_CRIT(id < m_nodes.size() && m_nodes[id].is_leaf() && m_nodes[id].height == 0, "yama::dynamic_bvh updating a bad id");
+
+        auto new_fat = fatten(b);
+        new_fat.min += yama::min(displacement, dim_vector::zero());
+        new_fat.max += yama::max(displacement, dim_vector::zero());
+
+        auto& fat = m_nodes[id].bounds;
+        if (fat.contains(b))
+        {
+            // an item which slowed down or shrunk keeps its larger box unless it gets too loose
+            const auto m = dim_vector::uniform(4 * m_margin);
+            if (box::min_max(new_fat.min - m, new_fat.max + m).contains(fat)) return false;
+        }
+
+        remove_leaf(id);
+        fat = new_fat;
+        insert_leaf(id);
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////
+    // queries
+    // they report the ids of the leaves whose fat boxes pass the test
+    // the callbacks may return void, or a bool: false to stop the query
+
+    // calls f(id) for the items whose fat boxes intersect b
+    template <typename F>
+    void query(const box& b, F f) const
+    {
+        traverse([&](const box& bounds) { return bounds.intersects(b); }, f);
+    }
+
+    // calls f(id) for the items whose fat boxes contain p
+    template <typename F>
+    void query(const dim_vector& p, F f) const
+    {
+        traverse([&](const box& bounds) { return bounds.is_inside(p); }, f);
+    }
+
+    // calls f(id, max_t) for the items whose fat boxes are hit by origin + t * direction, t in [0, max_t]
+    // the nodes are visited front to back and f can reduce max_t to prune the rest of the traversal
+    template <typename F>
+    void query_ray(const dim_vector& origin, const dim_vector& direction, T max_t, F f) const
+    {
+        if (m_root == null_index) return;
+
+        dim_vector inv_dir;
+        for (size_t i = 0; i < D; ++i) inv_dir.at(i) = T(1) / direction.at(i);
+
+        struct entry { index_type node; T t; };
+        impl::bvh_stack<entry> stack(size_t(height()) + 1);
+
+        T t;
+        if (!impl::ray_hits(m_nodes[m_root].bounds, origin, inv_dir, max_t, t)) return;
+        stack.push({m_root, t});
+
+        while (!stack.empty())
+        {
+            const auto e = stack.pop();
+            if (e.t > max_t) continue; // max_t was reduced after it was pushed
+
+            const auto& n = m_nodes[e.node];
+            if (n.is_leaf())
+            {
+                if (!impl::bvh_visit(f, size_t(e.node), max_t)) return;
+                continue;
+            }
+
+            T t0, t1;
+            const bool h0 = impl::ray_hits(m_nodes[n.children[0]].bounds, origin, inv_dir, max_t, t0);
+            const bool h1 = impl::ray_hits(m_nodes[n.children[1]].bounds, origin, inv_dir, max_t, t1);
+
+            // push the far one first, so that the near one is popped first
+            if (h0 && h1)
+            {
+                if (t0 <= t1)
+                {
+                    stack.push({n.children[1], t1});
+                    stack.push({n.children[0], t0});
+                }
+                else
+                {
+                    stack.push({n.children[0], t0});
+                    stack.push({n.children[1], t1});
+                }
+            }
+            else if (h0) stack.push({n.children[0], t0});
+            else if (h1) stack.push({n.children[1], t1});
+        }
+    }
+
+    ////////////////////////////////////////////////////////
+    // access
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    T margin() const { return m_margin; }
+
+    // the number of levels above the leaves
+    int32_t height() const { return m_root == null_index ? 0 : m_nodes[m_root].height; }
+
+    // the bounds of all fat boxes
+    box bounds() const { return m_root == null_index ? box::inverted() : m_nodes[m_root].bounds; }
+
+    const box& fat_bounds(index_type id) const { return m_nodes[id].bounds; }
+
+    index_type root() const { return m_root; }
+
+    // includes the free nodes
+    const std::vector<node>& nodes() const { return m_nodes; }
+
+private:
+    box fatten(const box& b) const
+    {
+        const auto m = dim_vector::uniform(m_margin);
+        return box::min_max(b.min - m, b.max + m);
+    }
+
+    static box merged(const box& a, const box& b)
+    {
+        auto ret = a;
+        ret.merge(b);
+        return ret;
+    }
+
+    index_type allocate()
+    {
+        if (m_free == null_index)
+        {
+            YAMA_ASSERT_CRIT(m_nodes.size() < null_index, "yama::dynamic_bvh too many nodes");
+            m_nodes.emplace_back();
+            return index_type(m_nodes.size() - 1);
+        }
+        const auto ret = m_free;
+        m_free = m_nodes[ret].parent;
+        return ret;
+    }
+
+    void release(index_type i)
+    {
+        m_nodes[i].parent = m_free;
+        m_nodes[i].height = -1;
+        m_free = i;
+    }
+
+    // bounds and height from the children
+    void fix(index_type i)
+    {
+        auto& n = m_nodes[i];
+        const auto& c0 = m_nodes[n.children[0]];
+        const auto& c1 = m_nodes[n.children[1]];
+        n.bounds = merged(c0.bounds, c1.bounds);
+        n.height = 1 + std::max(c0.height, c1.height);
+    }
+
+    void replace_child(index_type parent, index_type old_child, index_type new_child)
+    {
+        if (parent == null_index)
+        {
+            m_root = new_child;
+            return;
+        }
+        auto& p = m_nodes[parent];
+        p.children[p.children[0] == old_child ? 0 : 1] = new_child;
+    }
+
+    // fixes the ancestors of i, rotating them on the way
+    void fix_upwards(index_type i)
+    {
+        while (i != null_index)
+        {
+            rotate(i);
+            fix(i);
+            i = m_nodes[i].parent;
+        }
+    }
+
+    void insert_leaf(index_type leaf)
+    {
+        if (m_root == null_index)
+        {
+            m_root = leaf;
+            m_nodes[leaf].parent = null_index;
+            return;
+        }
+
+        // find the best sibling by descending to the child with the lowest cost
+        // the cost of a sibling is the area of the new parent, plus the increase of the areas of its ancestors
+        const auto b = m_nodes[leaf].bounds;
+        auto sibling = m_root;
+        while (!m_nodes[sibling].is_leaf())
+        {
+            const auto& n = m_nodes[sibling];
+            const T combined = impl::half_area(merged(n.bounds, b));
+
+            // a new parent of this node and the leaf
+            const T cost = 2 * combined;
+
+            // the minimum cost of pushing the leaf further down
+            const T inheritance = 2 * (combined - impl::half_area(n.bounds));
+
+            T child_cost[2];
+            for (int c = 0; c < 2; ++c)
+            {
+                const auto& child = m_nodes[n.children[c]];
+                child_cost[c] = impl::half_area(merged(child.bounds, b)) + inheritance;
+                if (!child.is_leaf()) child_cost[c] -= impl::half_area(child.bounds);
+            }
+
+            if (cost < child_cost[0] && cost < child_cost[1]) break;
+            sibling = n.children[child_cost[0] < child_cost[1] ? 0 : 1];
+        }
+
+        const auto old_parent = m_nodes[sibling].parent;
+        const auto new_parent = allocate();
+        auto& p = m_nodes[new_parent];
+        p.parent = old_parent;
+        p.children[0] = sibling;
+        p.children[1] = leaf;
+        replace_child(old_parent, sibling, new_parent);
+        m_nodes[sibling].parent = new_parent;
+        m_nodes[leaf].parent = new_parent;
+
+        fix_upwards(new_parent);
+    }
+
+    void remove_leaf(index_type leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = null_index;
+            return;
+        }
+
+        // the sibling takes the place of the parent
+        const auto parent = m_nodes[leaf].parent;
+        const auto& p = m_nodes[parent];
+        const auto sibling = p.children[p.children[0] == leaf ? 1 : 0];
+        const auto grandparent = p.parent;
+
+        replace_child(grandparent, parent, sibling);
+        m_nodes[sibling].parent = grandparent;
+        release(parent);
+
+        fix_upwards(grandparent);
+    }
+
+    // swaps a grandchild of a with its aunt, or two grandchildren of a, if that makes
+    // the children of a smaller (the area of a stays the same)
+    void rotate(index_type a)
+    {
+        const auto& an = m_nodes[a];
+        if (an.height < 2) return;
+
+        enum { none, with_aunt, grandchildren } best = none;
+        T best_delta = 0;
+        int best_side = 0, best_k = 0;
+
+        for (int side = 0; side < 2; ++side)
+        {
+            const auto& aunt = m_nodes[an.children[side]];
+            const auto& other = m_nodes[an.children[1 - side]];
+            if (other.is_leaf()) continue;
+
+            // other.children[k] goes up, aunt goes down and is merged with the rest of other
+            for (int k = 0; k < 2; ++k)
+            {
+                const T delta = impl::half_area(merged(aunt.bounds, m_nodes[other.children[1 - k]].bounds)) - impl::half_area(other.bounds);
+                if (delta < best_delta)
+                {
+                    best = with_aunt;
+                    best_delta = delta;
+                    best_side = side;
+                    best_k = k;
+                }
+            }
+        }
+
+        const auto& b = m_nodes[an.children[0]];
+        const auto& c = m_nodes[an.children[1]];
+        if (!b.is_leaf() && !c.is_leaf())
+        {
+            // b.children[0] and c.children[k] change places
+            const T old_area = impl::half_area(b.bounds) + impl::half_area(c.bounds);
+            for (int k = 0; k < 2; ++k)
+            {
+                const T delta = impl::half_area(merged(m_nodes[c.children[k]].bounds, m_nodes[b.children[1]].bounds))
+                    + impl::half_area(merged(m_nodes[b.children[0]].bounds, m_nodes[c.children[1 - k]].bounds))
+                    - old_area;
+                if (delta < best_delta)
+                {
+                    best = grandchildren;
+                    best_delta = delta;
+                    best_k = k;
+                }
+            }
+        }
+
+        if (best == with_aunt)
+        {
+            const auto other = an.children[1 - best_side];
+            swap_children(a, best_side, other, best_k);
+            fix(other);
+        }
+        else if (best == grandchildren)
+        {
+            const auto bi = an.children[0];
+            const auto ci = an.children[1];
+            swap_children(bi, 0, ci, best_k);
+            fix(bi);
+            fix(ci);
+        }
+    }
+
+    // swaps p.children[i] and q.children[j]
+    void swap_children(index_type p, int i, index_type q, int j)
+    {
+        auto& x = m_nodes[p].children[i];
+        auto& y = m_nodes[q].children[j];
+        std::swap(x, y);
+        m_nodes[x].parent = p;
+        m_nodes[y].parent = q;
+    }
+
+    // depth-first traversal which reports the leaves
+    template <typename Enter, typename F>
+    void traverse(Enter enter, F& f) const
+    {
+        if (m_root == null_index || !enter(m_nodes[m_root].bounds)) return;
+
+        impl::bvh_stack<index_type> stack(size_t(height()) + 1);
+        stack.push(m_root);
+        while (!stack.empty())
+        {
+            const auto i = stack.pop();
+            const auto& n = m_nodes[i];
+            if (n.is_leaf())
+            {
+                if (!impl::bvh_visit(f, size_t(i))) return;
+                continue;
+            }
+
+            if (enter(m_nodes[n.children[1]].bounds)) stack.push(n.children[1]);
+            if (enter(m_nodes[n.children[0]].bounds)) stack.push(n.children[0]);
+        }
+    }
+
+    T m_margin;
+    std::vector<node> m_nodes;
+    index_type m_root = null_index;
+    index_type m_free = null_index; // the first free node
+    size_t m_size = 0;
+};
+
+}
@@ -0,0 +1,20 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <ostream>
+#include "quaternion_ostream.hpp"
+#include "../dual_quaternion.hpp"
+
+namespace yama
+{
+
+template <typename T>
+::std::ostream& operator<<(::std::ostream& o, const dual_quaternion_t<T>& v)
+{
+    o << '(' << v.real << ", " << v.dual << ')';
+    return o;
+}
+
+}
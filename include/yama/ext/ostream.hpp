@@ -7,6 +7,7 @@
 #include "vector3_ostream.hpp"
 #include "vector4_ostream.hpp"
 #include "quaternion_ostream.hpp"
+#include "dual_quaternion_ostream.hpp"
 #include "matrix3x3_ostream.hpp"
 #include "matrix3x4_ostream.hpp"
 #include "matrix4x4_ostream.hpp"
@@ -0,0 +1,180 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+#include "util.hpp"
+#include "shorthand.hpp"
+#include "type_traits.hpp"
+
+#include "vector3.hpp"
+#include "vector4.hpp"
+#include "matrix4x4.hpp"
+#include "box.hpp"
+#include "simd/frustum.hpp"
+
+// View frustums as 6 planes extracted from a view-projection matrix
+//
+// A plane is a vector4 (a, b, c, d) with a normalized (a, b, c), so that a * x + b * y + c * z + d
+// is the signed distance of a point, positive on the inside. The planes are in the order left,
+// right, bottom, top, near, far.
+// An object is culled if it's completely on the outside of a plane. This is conservative: large
+// objects near the corners of the frustum may pass although they're outside.
+
+namespace yama
+{
+
+template <typename T>
+class frustum_t
+{
+public:
+    vector4_t<T> planes[6];
+
+    using value_type = T;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // named constructors
+    // view_projection transforms world coordinates to clip space: projection * view
+
+    // for the projections with depth in [0, 1] (perspective_lh and the like)
+    static frustum_t from_matrix(const matrix4x4_t<T>& view_projection)
+    {
+        return from_rows(view_projection, false);
+    }
+
+    // for the projections with depth in [-1, 1] (perspective_lh_cube and the like)
+    static frustum_t from_matrix_cube(const matrix4x4_t<T>& view_projection)
+    {
+        return from_rows(view_projection, true);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // tests
+
+    value_type distance(size_t plane, const vector3_t<T>& p) const
+    {
+        const auto& pl = planes[plane];
+        return pl.x * p.x + pl.y * p.y + pl.z * p.z + pl.w;
+    }
+
+    bool contains(const vector3_t<T>& p) const
+    {
+        for (size_t i = 0; i < 6; ++i)
+        {
+            if (distance(i, p) < 0) return false;
+        }
+        return true;
+    }
+
+    // false if the object is culled
+    // hint is optional: the plane which culled the object the last time, tested first
+    // it's updated when another plane culls the object (the near and far planes are tested before the sides)
+    bool intersects(const vector3_t<T>& center, const value_type& radius, uint8_t* hint = nullptr) const
+    {
+        return test(hint, [&](size_t i) { return distance(i, center) < -radius; });
+    }
+
+    bool intersects(const boxnt<3, T>& b, uint8_t* hint = nullptr) const
+    {
+        const auto c = (b.min + b.max) * T(0.5);
+        const auto e = (b.max - b.min) * T(0.5);
+        return test(hint, [&](size_t i) {
+            const auto& pl = planes[i];
+            return distance(i, c) < -(std::abs(pl.x) * e.x + std::abs(pl.y) * e.y + std::abs(pl.z) * e.z);
+        });
+    }
+
+private:
+    // the planes are sums and differences of the rows of the matrix (Gribb and Hartmann)
+    static frustum_t from_rows(const matrix4x4_t<T>& m, bool cube)
+    {
+        vector4_t<T> rows[4];
+        for (size_t r = 0; r < 4; ++r) rows[r] = vector4_t<T>::coord(m(r, 0), m(r, 1), m(r, 2), m(r, 3));
+
+        frustum_t ret;
+        ret.planes[0] = rows[3] + rows[0];
+        ret.planes[1] = rows[3] - rows[0];
+        ret.planes[2] = rows[3] + rows[1];
+        ret.planes[3] = rows[3] - rows[1];
+        ret.planes[4] = cube ? rows[3] + rows[2] : rows[2];
+        ret.planes[5] = rows[3] - rows[2];
+
+        for (auto& p : ret.planes)
+        {
+            p /= std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        }
+        return ret;
+    }
+
+    template <typename Outside>
+    bool test(uint8_t* hint, Outside outside) const
+    {
+        if (hint && *hint < 6 && outside(*hint)) return false;
+        for (int i : simd::frustum_test_order)
+        {
+            if (outside(size_t(i)))
+            {
+                if (hint) *hint = uint8_t(i);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// batch culling
+// bit i % 32 of hits[i / 32] is set if object i is not culled, so hits must have room for (count + 31) / 32 words
+// hints are optional: a plane per object as in frustum_t::intersects (start them at zero)
+// the float versions test packs of objects and may pick other planes which cull the objects as their hints
+
+// count spheres given by their centers and radii
+template <typename T>
+void intersects(const frustum_t<T>& f, const vector3_t<T>* centers, const T* radii, size_t count, uint32_t* hits, uint8_t* hints = nullptr)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i % 32 == 0) hits[i / 32] = 0;
+        hits[i / 32] |= uint32_t(f.intersects(centers[i], radii[i], hints ? hints + i : nullptr)) << (i % 32);
+    }
+}
+
+inline void intersects(const frustum_t<float>& f, const vector3_t<float>* centers, const float* radii, size_t count, uint32_t* hits, uint8_t* hints = nullptr)
+{
+    static_assert(sizeof(frustum_t<float>) == 24 * sizeof(float), "yama::frustum_t planes must be arrays of 24 floats");
+    simd::frustum_spheres(reinterpret_cast<const float*>(&f), reinterpret_cast<const float*>(centers), radii, count, hits, hints);
+}
+
+// count boxes
+template <typename T>
+void intersects(const frustum_t<T>& f, const boxnt<3, T>* boxes, size_t count, uint32_t* hits, uint8_t* hints = nullptr)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i % 32 == 0) hits[i / 32] = 0;
+        hits[i / 32] |= uint32_t(f.intersects(boxes[i], hints ? hints + i : nullptr)) << (i % 32);
+    }
+}
+
+inline void intersects(const frustum_t<float>& f, const boxnt<3, float>* boxes, size_t count, uint32_t* hits, uint8_t* hints = nullptr)
+{
+    static_assert(sizeof(boxnt<3, float>) == 6 * sizeof(float), "yama::frustum_t boxes must be arrays of 6 floats");
+    simd::frustum_boxes(reinterpret_cast<const float*>(&f), reinterpret_cast<const float*>(boxes), count, hits, hints);
+}
+
+// type traits
+template <typename T>
+struct is_yama<frustum_t<T>> : public std::true_type {};
+
+// shorthand
+#if !defined(YAMA_NO_SHORTHAND)
+
+using frustum = frustum_t<preferred_type>;
+
+#endif
+
+}
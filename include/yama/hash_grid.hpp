@@ -0,0 +1,210 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "vector3.hpp"
+#include "box.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+// Uniform spatial hash grid of 3d points
+//
+// Space is split into cubic cells and the integer coordinates of a cell are hashed to one of
+// the buckets of a table. The grid is built with a counting sort: the points are counted per
+// bucket, the counts become offsets, and the points are copied in bucket order. So the points
+// of a bucket are contiguous and there are no allocations per cell.
+//
+// Different cells may share a bucket. The queries check the cells of the points, so they never
+// report a point twice or from a cell which isn't in their range.
+// Queries are cheapest when their radius (or half the size of their box) is about the cell size.
+// Queries which span more cells than there are buckets check the cells of all points instead.
+
+namespace yama
+{
+
+template <typename T>
+class hash_grid
+{
+public:
+    using value_type = T;
+    using vector = vector3_t<T>;
+    using box = boxnt<3, T>;
+    using index_type = uint32_t;
+
+    struct cell
+    {
+        int32_t x, y, z;
+        bool operator==(const cell& c) const { return x == c.x && y == c.y && z == c.z; }
+    };
+
+    hash_grid() = default;
+
+    hash_grid(const vector* points, size_t count, T cell_size, size_t bucket_count = 0)
+    {
+        build(points, count, cell_size, bucket_count);
+    }
+
+    // the number of buckets is rounded up to a power of two (by default the one above count)
+    void build(const vector* points, size_t count, T cell_size, size_t bucket_count = 0)
+    {
+        YAMA_ASSERT_CRIT(cell_size > 0, "yama::hash_grid cell size must be positive");
+
+        m_cell_size = cell_size;
+        m_inv_cell_size = T(1) / cell_size;
+
+        size_t table = 1;
+        while (table < (bucket_count ? bucket_count : count)) table *= 2;
+        m_mask = uint32_t(table - 1);
+
+        // count
+        m_starts.assign(table + 1, 0);
+        std::vector<cell> cells(count);
+        std::vector<uint32_t> keys(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            cells[i] = cell_of(points[i]);
+            keys[i] = bucket(cells[i]);
+            ++m_starts[keys[i] + 1];
+        }
+
+        // offsets
+        for (size_t i = 1; i <= table; ++i) m_starts[i] += m_starts[i - 1];
+
+        // scatter
+        std::vector<uint32_t> next(m_starts.begin(), m_starts.end() - 1);
+        m_points.resize(count);
+        m_cells.resize(count);
+        m_indices.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto dst = next[keys[i]]++;
+            m_points[dst] = points[i];
+            m_cells[dst] = cells[i];
+            m_indices[dst] = index_type(i);
+        }
+    }
+
+    void clear()
+    {
+        m_starts.clear();
+        m_points.clear();
+        m_cells.clear();
+        m_indices.clear();
+    }
+
+    size_t size() const { return m_points.size(); }
+    size_t buckets() const { return m_starts.empty() ? 0 : m_starts.size() - 1; }
+    T cell_size() const { return m_cell_size; }
+
+    // the coordinates are clamped to the range of int32_t, so far away points share the border cells
+    cell cell_of(const vector& p) const
+    {
+        return {
+            cell_coord(p.x * m_inv_cell_size),
+            cell_coord(p.y * m_inv_cell_size),
+            cell_coord(p.z * m_inv_cell_size),
+        };
+    }
+
+    uint32_t bucket(const cell& c) const
+    {
+        // the primes of Teschner et al.
+        return (uint32_t(c.x) * 73856093u ^ uint32_t(c.y) * 19349663u ^ uint32_t(c.z) * 83492791u) & m_mask;
+    }
+
+    ////////////////////////////////////////////////////////
+    // queries
+    // they report the indices of the points in the array the grid was built from
+
+    // calls f(index, distance_sq) for the points with distance_sq(p, center) <= radius * radius
+    template <typename F>
+    void query_radius(const vector& center, T radius, F f) const
+    {
+        const T r2 = radius * radius;
+        for_each_cell(vector::uniform(-radius) + center, vector::uniform(radius) + center, [&](size_t i) {
+            const T d2 = distance_sq(m_points[i], center);
+            if (d2 <= r2) f(m_indices[i], d2);
+        });
+    }
+
+    // calls f(index) for the points in b (as in boxnt::is_inside)
+    template <typename F>
+    void query(const box& b, F f) const
+    {
+        for_each_cell(b.min, b.max, [&](size_t i) {
+            if (b.is_inside(m_points[i])) f(m_indices[i]);
+        });
+    }
+
+    ////////////////////////////////////////////////////////
+    // the sorted contents: bucket i is the range [bucket_starts()[i], bucket_starts()[i + 1])
+
+    const std::vector<uint32_t>& bucket_starts() const { return m_starts; }
+    const std::vector<vector>& points() const { return m_points; }
+    const std::vector<cell>& cells() const { return m_cells; }
+    const std::vector<index_type>& indices() const { return m_indices; }
+
+private:
+    static int32_t cell_coord(T v)
+    {
+        const T f = std::floor(v);
+        if (!(f >= T(-2147483648.0))) return INT32_MIN; // also NaN
+        if (f >= T(2147483648.0)) return INT32_MAX;
+        return int32_t(f);
+    }
+
+    // calls f(i) for the sorted points in the cells which contain [lo, hi]
+    template <typename F>
+    void for_each_cell(const vector& lo, const vector& hi, F f) const
+    {
+        if (m_points.empty()) return;
+        const auto a = cell_of(lo), b = cell_of(hi);
+        if (a.x > b.x || a.y > b.y || a.z > b.z) return;
+
+        // with more cells than buckets visiting the cells costs more than checking all points once
+        const uint64_t nb = buckets();
+        uint64_t n = uint64_t(int64_t(b.x) - a.x + 1);
+        if (n <= nb) n *= uint64_t(int64_t(b.y) - a.y + 1);
+        if (n <= nb) n *= uint64_t(int64_t(b.z) - a.z + 1);
+        if (n > nb)
+        {
+            for (uint32_t i = 0; i < m_cells.size(); ++i)
+            {
+                const auto& c = m_cells[i];
+                if (c.x >= a.x && c.x <= b.x && c.y >= a.y && c.y <= b.y && c.z >= a.z && c.z <= b.z) f(i);
+            }
+            return;
+        }
+
+        // 64-bit counters, so the loops end at INT32_MAX
+        for (int64_t z = a.z; z <= b.z; ++z)
+        {
+            for (int64_t y = a.y; y <= b.y; ++y)
+            {
+                for (int64_t x = a.x; x <= b.x; ++x)
+                {
+                    const cell c = {int32_t(x), int32_t(y), int32_t(z)};
+                    const auto k = bucket(c);
+                    for (uint32_t i = m_starts[k]; i < m_starts[k + 1]; ++i)
+                    {
+                        if (m_cells[i] == c) f(i);
+                    }
+                }
+            }
+        }
+    }
+
+    T m_cell_size = 1;
+    T m_inv_cell_size = 1;
+    uint32_t m_mask = 0;
+
+    std::vector<uint32_t> m_starts; // buckets + 1 offsets
+    std::vector<vector> m_points; // in bucket order
+    std::vector<cell> m_cells; // the cells of the points
+    std::vector<index_type> m_indices; // the indices of the points in the original array
+};
+
+}
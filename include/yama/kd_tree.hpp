@@ -0,0 +1,227 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "dim.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+// Static k-d tree of D-dimensional points
+//
+// The tree is implicit: the points are reordered so that the node of the range [begin, end)
+// is the point at (begin + end) / 2, the median along its split axis, and its subtrees are
+// the ranges on each side of it. So there are no child links, only a split axis per node.
+// The split axis of a range is the one along which its points spread the most.
+// Ranges of up to leaf_size points are leaves and are not split: the queries test all of their
+// points, which is faster than walking a few more levels and jumping around the array.
+//
+// Queries traverse the tree with an explicit stack (no recursion), the nearer subtree first,
+// and skip the subtrees which are farther than the current result. They report the indices
+// of the points in the original array.
+
+namespace yama
+{
+
+template <size_t D, typename T>
+class kd_tree
+{
+public:
+    static const size_t dimension = D;
+    using value_type = T;
+    using dim_vector = typename dim<D>::template vector_t<T>;
+    using index_type = uint32_t;
+
+    static constexpr size_t leaf_size = 8;
+
+    kd_tree() = default;
+
+    kd_tree(const dim_vector* points, size_t count)
+    {
+        build(points, count);
+    }
+
+    void build(const dim_vector* points, size_t count)
+    {
+        m_points.assign(points, points + count);
+        m_indices.resize(count);
+        std::iota(m_indices.begin(), m_indices.end(), index_type(0));
+        m_axes.assign(count, 0);
+
+        // the order of the ranges doesn't matter, so a plain stack will do
+        struct range { size_t begin, end; };
+        std::vector<range> ranges;
+        std::vector<std::pair<T, index_type>> keys;
+        if (count > leaf_size) ranges.push_back({0, count});
+        while (!ranges.empty())
+        {
+            const auto r = ranges.back();
+            ranges.pop_back();
+
+            auto lo = m_points[r.begin], hi = lo;
+            for (size_t i = r.begin + 1; i < r.end; ++i)
+            {
+                lo = yama::min(lo, m_points[i]);
+                hi = yama::max(hi, m_points[i]);
+            }
+            const auto extent = hi - lo;
+            size_t axis = 0;
+            for (size_t d = 1; d < D; ++d)
+            {
+                if (extent.at(d) > extent.at(axis)) axis = d;
+            }
+
+            // partition the indices and apply the order to the points
+            const size_t mid = (r.begin + r.end) / 2;
+            keys.clear();
+            for (size_t i = r.begin; i < r.end; ++i) keys.push_back({m_points[i].at(axis), m_indices[i]});
+            std::nth_element(keys.begin(), keys.begin() + (mid - r.begin), keys.end());
+            for (size_t i = r.begin; i < r.end; ++i)
+            {
+                m_indices[i] = keys[i - r.begin].second;
+                m_points[i] = points[m_indices[i]];
+            }
+            m_axes[mid] = uint8_t(axis);
+
+            if (mid - r.begin > leaf_size) ranges.push_back({r.begin, mid});
+            if (r.end - (mid + 1) > leaf_size) ranges.push_back({mid + 1, r.end});
+        }
+    }
+
+    void clear()
+    {
+        m_points.clear();
+        m_indices.clear();
+        m_axes.clear();
+    }
+
+    size_t size() const { return m_points.size(); }
+    bool empty() const { return m_points.empty(); }
+
+    // the number of levels of the tree (with the leaves)
+    int depth() const
+    {
+        int ret = size() ? 1 : 0;
+        for (size_t n = size(); n > leaf_size; n /= 2) ++ret;
+        return ret;
+    }
+
+    ////////////////////////////////////////////////////////
+    // queries
+
+    // the index of the nearest point with distance_sq < max_distance_sq, or -1 if there is none
+    // distance_sq gets its squared distance
+    index_type nearest(const dim_vector& p, T& distance_sq, T max_distance_sq = std::numeric_limits<T>::max()) const
+    {
+        index_type ret = index_type(-1);
+        T best = max_distance_sq;
+        traverse(p, [&]() { return best; }, [&](size_t i, T d2) {
+            if (d2 < best)
+            {
+                best = d2;
+                ret = m_indices[i];
+            }
+        });
+        distance_sq = best;
+        return ret;
+    }
+
+    index_type nearest(const dim_vector& p) const
+    {
+        T d2;
+        return nearest(p, d2);
+    }
+
+    // writes the indices and squared distances of the k nearest points with distance_sq < max_distance_sq,
+    // nearest first, and returns their count (less than k if there aren't enough)
+    // indices and distances_sq must have room for k elements
+    size_t nearest_k(const dim_vector& p, size_t k, index_type* indices, T* distances_sq,
+        T max_distance_sq = std::numeric_limits<T>::max()) const
+    {
+        if (!k) return 0;
+
+        // the results are kept sorted with insertion (k is small)
+        size_t count = 0;
+        traverse(p, [&]() { return count == k ? distances_sq[k - 1] : max_distance_sq; }, [&](size_t i, T d2) {
+            if (d2 >= (count == k ? distances_sq[k - 1] : max_distance_sq)) return;
+            size_t j = count < k ? count++ : k - 1;
+            for (; j > 0 && distances_sq[j - 1] > d2; --j)
+            {
+                distances_sq[j] = distances_sq[j - 1];
+                indices[j] = indices[j - 1];
+            }
+            distances_sq[j] = d2;
+            indices[j] = m_indices[i];
+        });
+        return count;
+    }
+
+    // calls f(index, distance_sq) for the points with distance_sq(point, p) <= radius * radius (in no particular order)
+    template <typename F>
+    void query_radius(const dim_vector& p, T radius, F f) const
+    {
+        const T r2 = radius * radius;
+        // the traversal prunes with < on its bound, and the points on the sphere must pass
+        const T bound = std::nextafter(r2, std::numeric_limits<T>::max());
+        traverse(p, [&]() { return bound; }, [&](size_t i, T d2) {
+            if (d2 <= r2) f(m_indices[i], d2);
+        });
+    }
+
+    ////////////////////////////////////////////////////////
+    // the tree: the points and their original indices in tree order, and the split axes of the nodes
+    // (the axes of the points in the leaves are zero)
+
+    const std::vector<dim_vector>& points() const { return m_points; }
+    const std::vector<index_type>& indices() const { return m_indices; }
+    const std::vector<uint8_t>& axes() const { return m_axes; }
+
+private:
+    // visits the nodes which may be closer than bound() and calls visit(i, distance_sq) for their points
+    template <typename Bound, typename Visit>
+    void traverse(const dim_vector& p, Bound bound, Visit visit) const
+    {
+        // a subtree with the squared distance to the plane which separates it from p
+        struct entry { index_type begin, end; T d2; };
+        entry stack[64]; // the tree is balanced, so depth() + 1 entries are enough
+        int top = 0;
+        if (!m_points.empty()) stack[top++] = {0, index_type(m_points.size()), 0};
+
+        while (top)
+        {
+            const auto e = stack[--top];
+            if (e.d2 >= bound()) continue;
+
+            if (e.end - e.begin <= leaf_size)
+            {
+                for (index_type i = e.begin; i < e.end; ++i) visit(i, distance_sq(m_points[i], p));
+                continue;
+            }
+
+            const index_type mid = (e.begin + e.end) / 2;
+            visit(mid, distance_sq(m_points[mid], p));
+
+            const auto axis = m_axes[mid];
+            const T diff = p.at(axis) - m_points[mid].at(axis);
+            const T diff2 = diff * diff;
+
+            entry left = {e.begin, mid, e.d2}, right = {mid + 1, e.end, e.d2};
+            auto& far_child = diff < 0 ? right : left;
+            far_child.d2 = std::max(far_child.d2, diff2);
+            const auto& near_child = diff < 0 ? left : right;
+            if (far_child.begin < far_child.end) stack[top++] = far_child;
+            if (near_child.begin < near_child.end) stack[top++] = near_child;
+        }
+    }
+
+    std::vector<dim_vector> m_points;
+    std::vector<index_type> m_indices;
+    std::vector<uint8_t> m_axes;
+};
+
+}
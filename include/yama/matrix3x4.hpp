@@ -5,6 +5,7 @@
 
 #include "dim.hpp"
 #include "quaternion.hpp"
+#include "simd/transform.hpp"
 
 namespace yama
 {
@@ -266,6 +267,19 @@ public:
         );
     }
 
+    // translation(t) * rotation_quaternion(q) * scaling(s)
+    static matrix3x4_t translation_rotation_scaling(const vector3_t<T>& t, const quaternion_t<T>& q, const vector3_t<T>& s)
+    {
+        auto ret = rotation_quaternion(q);
+        ret.m00 *= s.x; ret.m10 *= s.x; ret.m20 *= s.x;
+        ret.m01 *= s.y; ret.m11 *= s.y; ret.m21 *= s.y;
+        ret.m02 *= s.z; ret.m12 *= s.z; ret.m22 *= s.z;
+        ret.m03 = t.x;
+        ret.m13 = t.y;
+        ret.m23 = t.z;
+        return ret;
+    }
+
     ///////////////////////////
     // attach
     static matrix3x4_t& attach_to_ptr(value_type* ptr)
@@ -628,28 +642,47 @@ public:
     // returns determinant
     value_type inverse()
     {
-        auto det = determinant();
-
-        auto c00 = -m12*m21 + m11*m22;
-        auto c10 =  m12*m20 - m10*m22;
-        auto c20 = -m11*m20 + m10*m21;
-        auto c01 =  m02*m21 - m01*m22;
-        auto c11 = -m02*m20 + m00*m22;
-        auto c21 =  m01*m20 - m00*m21;
-        auto c02 = -m02*m11 + m01*m12;
-        auto c12 =  m02*m10 - m00*m12;
-        auto c22 = -m01*m10 + m00*m11;
-        auto c03 = m03*m12*m21 - m02*m13*m21 - m03*m11*m22 + m01*m13*m22 + m02*m11*m23 - m01*m12*m23;
-        auto c13 = -(m03*m12*m20) + m02*m13*m20 + m03*m10*m22 - m00*m13*m22 - m02*m10*m23 + m00*m12*m23;
-        auto c23 = m03*m11*m20 - m01*m13*m20 - m03*m10*m21 + m00*m13*m21 + m01*m10*m23 - m00*m11*m23;
-
-        m00 = c00 / det; m10 = c10 / det; m20 = c20 / det;
-        m01 = c01 / det; m11 = c11 / det; m21 = c21 / det;
-        m02 = c02 / det; m12 = c12 / det; m22 = c22 / det;
-        m03 = c03 / det; m13 = c13 / det; m23 = c23 / det;
+        const value_type a00 = m11*m22 - m12*m21;
+        const value_type a01 = m02*m21 - m01*m22;
+        const value_type a02 = m01*m12 - m02*m11;
+        const value_type a10 = m12*m20 - m10*m22;
+        const value_type a11 = m00*m22 - m02*m20;
+        const value_type a12 = m02*m10 - m00*m12;
+        const value_type a20 = m10*m21 - m11*m20;
+        const value_type a21 = m01*m20 - m00*m21;
+        const value_type a22 = m00*m11 - m01*m10;
+
+        const value_type det = m00*a00 + m01*a10 + m02*a20;
+        const value_type rdet = value_type(1) / det;
+
+        m00 = a00 * rdet; m01 = a01 * rdet; m02 = a02 * rdet;
+        m10 = a10 * rdet; m11 = a11 * rdet; m12 = a12 * rdet;
+        m20 = a20 * rdet; m21 = a21 * rdet; m22 = a22 * rdet;
+
+        // the translation of the inverse is the inverted negative translation
+        const value_type tx = m03, ty = m13, tz = m23;
+        m03 = -(m00*tx + m01*ty + m02*tz);
+        m13 = -(m10*tx + m11*ty + m12*tz);
+        m23 = -(m20*tx + m21*ty + m22*tz);
 
         return det;
     }
+
+    // for when you're sure that the matrix is a rotation followed by a translation
+    // the inverse is the transposed rotation and the negated translation, rotated by it
+    matrix3x4_t& inverse_rigid()
+    {
+        std::swap(m10, m01);
+        std::swap(m20, m02);
+        std::swap(m21, m12);
+
+        const value_type tx = m03, ty = m13, tz = m23;
+        m03 = -(m00*tx + m01*ty + m02*tz);
+        m13 = -(m10*tx + m11*ty + m12*tz);
+        m23 = -(m20*tx + m21*ty + m22*tz);
+
+        return *this;
+    }
 };
 
 template <typename T>
@@ -812,22 +845,9 @@ bool isfinite(const matrix3x4_t<T>& a)
 template <typename T>
 matrix3x4_t<T> inverse(const matrix3x4_t<T>& a, T& out_determinant)
 {
-    out_determinant = a.determinant();
-
-    return matrix3x4_t<T>::columns(
-        (-a.m12*a.m21 + a.m11*a.m22) / out_determinant,
-        (a.m12*a.m20 - a.m10*a.m22) / out_determinant,
-        (-a.m11*a.m20 + a.m10*a.m21) / out_determinant,
-        (a.m02*a.m21 - a.m01*a.m22) / out_determinant,
-        (-a.m02*a.m20 + a.m00*a.m22) / out_determinant,
-        (a.m01*a.m20 - a.m00*a.m21) / out_determinant,
-        (-a.m02*a.m11 + a.m01*a.m12) / out_determinant,
-        (a.m02*a.m10 - a.m00*a.m12) / out_determinant,
-        (-a.m01*a.m10 + a.m00*a.m11) / out_determinant,
-        (a.m03*a.m12*a.m21 - a.m02*a.m13*a.m21 - a.m03*a.m11*a.m22 + a.m01*a.m13*a.m22 + a.m02*a.m11*a.m23 - a.m01*a.m12*a.m23) / out_determinant,
-        (-(a.m03*a.m12*a.m20) + a.m02*a.m13*a.m20 + a.m03*a.m10*a.m22 - a.m00*a.m13*a.m22 - a.m02*a.m10*a.m23 + a.m00*a.m12*a.m23) / out_determinant,
-        (a.m03*a.m11*a.m20 - a.m01*a.m13*a.m20 - a.m03*a.m10*a.m21 + a.m00*a.m13*a.m21 + a.m01*a.m10*a.m23 - a.m00*a.m11*a.m23) / out_determinant
-    );
+    auto ret = a;
+    out_determinant = ret.inverse();
+    return ret;
 }
 
 template <typename T>
@@ -837,6 +857,13 @@ matrix3x4_t<T> inverse(const matrix3x4_t<T>& a)
     return inverse(a, det);
 }
 
+template <typename T>
+matrix3x4_t<T> inverse_rigid(const matrix3x4_t<T>& a)
+{
+    auto ret = a;
+    return ret.inverse_rigid();
+}
+
 template <typename T>
 vector3_t<T> transform_coord(const vector3_t<T>& v, const matrix3x4_t<T>& m)
 {
@@ -861,6 +888,62 @@ vector3_t<T> transform_normal(const vector3_t<T>& v, const matrix3x4_t<T>& m)
     return out;
 }
 
+// transforms count coordinates from in to out
+// out may be the same as in
+template <typename T>
+void transform_coord(const vector3_t<T>* in, size_t count, const matrix3x4_t<T>& m, vector3_t<T>* out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = transform_coord(in[i], m);
+    }
+}
+
+// transforms count normals from in to out
+// out may be the same as in
+template <typename T>
+void transform_normal(const vector3_t<T>* in, size_t count, const matrix3x4_t<T>& m, vector3_t<T>* out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = transform_normal(in[i], m);
+    }
+}
+
+// out[i] = translation_rotation_scaling(t[i], q[i], s[i]) for count matrices
+// t and s may be null for no translation and no scaling
+// this is how a skinning palette is built from animated bones
+// (T is deduced from q only, so that t and s can be nullptr)
+template <typename T>
+void translation_rotation_scaling(const vector3_t<typename quaternion_t<T>::value_type>* t, const quaternion_t<T>* q,
+    const vector3_t<typename quaternion_t<T>::value_type>* s, size_t count, matrix3x4_t<T>* out)
+{
+    const auto zero = vector3_t<T>::zero();
+    const auto one = vector3_t<T>::uniform(1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = matrix3x4_t<T>::translation_rotation_scaling(t ? t[i] : zero, q[i], s ? s[i] : one);
+    }
+}
+
+// the float version converts several quaternions at once
+inline void translation_rotation_scaling(const vector3_t<float>* t, const quaternion_t<float>* q, const vector3_t<float>* s, size_t count, matrix3x4_t<float>* out)
+{
+    simd::quaternion_to_matrix3x4(reinterpret_cast<const float*>(q), reinterpret_cast<const float*>(t), reinterpret_cast<const float*>(s), count, reinterpret_cast<float*>(out));
+}
+
+#if YAMA_USE_SIMD
+inline void transform_coord(const vector3_t<float>* in, size_t count, const matrix3x4_t<float>& m, vector3_t<float>* out)
+{
+    simd::transform_coord<3>(m.data(), reinterpret_cast<const float*>(in), count, reinterpret_cast<float*>(out), false);
+}
+
+inline void transform_normal(const vector3_t<float>* in, size_t count, const matrix3x4_t<float>& m, vector3_t<float>* out)
+{
+    simd::transform_normal<3>(m.data(), reinterpret_cast<const float*>(in), count, reinterpret_cast<float*>(out));
+}
+#endif
+
 
 // type traits
 template <typename T>
@@ -5,6 +5,8 @@
 
 #include "dim.hpp"
 #include "quaternion.hpp"
+#include "simd/matrix4x4.hpp"
+#include "simd/transform.hpp"
 
 namespace yama
 {
@@ -977,48 +979,157 @@ public:
 
     value_type determinant() const
     {
-        return
-            m03*m12*m21*m30 - m02*m13*m21*m30 - m03*m11*m22*m30 +
-            m01*m13*m22*m30 + m02*m11*m23*m30 - m01*m12*m23*m30 -
-            m03*m12*m20*m31 + m02*m13*m20*m31 + m03*m10*m22*m31 -
-            m00*m13*m22*m31 - m02*m10*m23*m31 + m00*m12*m23*m31 +
-            m03*m11*m20*m32 - m01*m13*m20*m32 - m03*m10*m21*m32 +
-            m00*m13*m21*m32 + m01*m10*m23*m32 - m00*m11*m23*m32 -
-            m02*m11*m20*m33 + m01*m12*m20*m33 + m02*m10*m21*m33 -
-            m00*m12*m21*m33 - m01*m10*m22*m33 + m00*m11*m22*m33;
+        // laplace expansion by the 2x2 minors of the first two and the last two rows
+        const value_type s0 = m00*m11 - m10*m01;
+        const value_type s1 = m00*m12 - m10*m02;
+        const value_type s2 = m00*m13 - m10*m03;
+        const value_type s3 = m01*m12 - m11*m02;
+        const value_type s4 = m01*m13 - m11*m03;
+        const value_type s5 = m02*m13 - m12*m03;
+
+        const value_type c5 = m22*m33 - m32*m23;
+        const value_type c4 = m21*m33 - m31*m23;
+        const value_type c3 = m21*m32 - m31*m22;
+        const value_type c2 = m20*m33 - m30*m23;
+        const value_type c1 = m20*m32 - m30*m22;
+        const value_type c0 = m20*m31 - m30*m21;
+
+        return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
     }
 
     // returns determinant
     value_type inverse()
     {
-        auto det = determinant();
-
-        auto c00 = -(m13*m22*m31) + m12*m23*m31 + m13*m21*m32 - m11*m23*m32 - m12*m21*m33 + m11*m22*m33;
-        auto c10 = m13*m22*m30 - m12*m23*m30 - m13*m20*m32 + m10*m23*m32 + m12*m20*m33 - m10*m22*m33;
-        auto c20 = -(m13*m21*m30) + m11*m23*m30 + m13*m20*m31 - m10*m23*m31 - m11*m20*m33 + m10*m21*m33;
-        auto c30 = m12*m21*m30 - m11*m22*m30 - m12*m20*m31 + m10*m22*m31 + m11*m20*m32 - m10*m21*m32;
-        auto c01 = m03*m22*m31 - m02*m23*m31 - m03*m21*m32 + m01*m23*m32 + m02*m21*m33 - m01*m22*m33;
-        auto c11 = -(m03*m22*m30) + m02*m23*m30 + m03*m20*m32 - m00*m23*m32 - m02*m20*m33 + m00*m22*m33;
-        auto c21 = m03*m21*m30 - m01*m23*m30 - m03*m20*m31 + m00*m23*m31 + m01*m20*m33 - m00*m21*m33;
-        auto c31 = -(m02*m21*m30) + m01*m22*m30 + m02*m20*m31 - m00*m22*m31 - m01*m20*m32 + m00*m21*m32;
-        auto c02 = -(m03*m12*m31) + m02*m13*m31 + m03*m11*m32 - m01*m13*m32 - m02*m11*m33 + m01*m12*m33;
-        auto c12 = m03*m12*m30 - m02*m13*m30 - m03*m10*m32 + m00*m13*m32 + m02*m10*m33 - m00*m12*m33;
-        auto c22 = -(m03*m11*m30) + m01*m13*m30 + m03*m10*m31 - m00*m13*m31 - m01*m10*m33 + m00*m11*m33;
-        auto c32 = m02*m11*m30 - m01*m12*m30 - m02*m10*m31 + m00*m12*m31 + m01*m10*m32 - m00*m11*m32;
-        auto c03 = m03*m12*m21 - m02*m13*m21 - m03*m11*m22 + m01*m13*m22 + m02*m11*m23 - m01*m12*m23;
-        auto c13 = -(m03*m12*m20) + m02*m13*m20 + m03*m10*m22 - m00*m13*m22 - m02*m10*m23 + m00*m12*m23;
-        auto c23 = m03*m11*m20 - m01*m13*m20 - m03*m10*m21 + m00*m13*m21 + m01*m10*m23 - m00*m11*m23;
-        auto c33 = -(m02*m11*m20) + m01*m12*m20 + m02*m10*m21 - m00*m12*m21 - m01*m10*m22 + m00*m11*m22;
-
-        m00 = c00 / det; m10 = c10 / det; m20 = c20 / det; m30 = c30 / det;
-        m01 = c01 / det; m11 = c11 / det; m21 = c21 / det; m31 = c31 / det;
-        m02 = c02 / det; m12 = c12 / det; m22 = c22 / det; m32 = c32 / det;
-        m03 = c03 / det; m13 = c13 / det; m23 = c23 / det; m33 = c33 / det;
+        // the 2x2 minors are shared between the determinant and the cofactors
+        const value_type s0 = m00*m11 - m10*m01;
+        const value_type s1 = m00*m12 - m10*m02;
+        const value_type s2 = m00*m13 - m10*m03;
+        const value_type s3 = m01*m12 - m11*m02;
+        const value_type s4 = m01*m13 - m11*m03;
+        const value_type s5 = m02*m13 - m12*m03;
+
+        const value_type c5 = m22*m33 - m32*m23;
+        const value_type c4 = m21*m33 - m31*m23;
+        const value_type c3 = m21*m32 - m31*m22;
+        const value_type c2 = m20*m33 - m30*m23;
+        const value_type c1 = m20*m32 - m30*m22;
+        const value_type c0 = m20*m31 - m30*m21;
+
+        const value_type det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+        const value_type rdet = value_type(1) / det;
+
+        auto i00 = ( m11*c5 - m12*c4 + m13*c3) * rdet;
+        auto i01 = (-m01*c5 + m02*c4 - m03*c3) * rdet;
+        auto i02 = ( m31*s5 - m32*s4 + m33*s3) * rdet;
+        auto i03 = (-m21*s5 + m22*s4 - m23*s3) * rdet;
+        auto i10 = (-m10*c5 + m12*c2 - m13*c1) * rdet;
+        auto i11 = ( m00*c5 - m02*c2 + m03*c1) * rdet;
+        auto i12 = (-m30*s5 + m32*s2 - m33*s1) * rdet;
+        auto i13 = ( m20*s5 - m22*s2 + m23*s1) * rdet;
+        auto i20 = ( m10*c4 - m11*c2 + m13*c0) * rdet;
+        auto i21 = (-m00*c4 + m01*c2 - m03*c0) * rdet;
+        auto i22 = ( m30*s4 - m31*s2 + m33*s0) * rdet;
+        auto i23 = (-m20*s4 + m21*s2 - m23*s0) * rdet;
+        auto i30 = (-m10*c3 + m11*c1 - m12*c0) * rdet;
+        auto i31 = ( m00*c3 - m01*c1 + m02*c0) * rdet;
+        auto i32 = (-m30*s3 + m31*s1 - m32*s0) * rdet;
+        auto i33 = ( m20*s3 - m21*s1 + m22*s0) * rdet;
+
+        m00 = i00; m10 = i10; m20 = i20; m30 = i30;
+        m01 = i01; m11 = i11; m21 = i21; m31 = i31;
+        m02 = i02; m12 = i12; m22 = i22; m32 = i32;
+        m03 = i03; m13 = i13; m23 = i23; m33 = i33;
+
+        return det;
+    }
+
+    // true if the last row is exactly (0, 0, 0, 1)
+    constexpr bool is_affine() const
+    {
+        return m30 == 0 && m31 == 0 && m32 == 0 && m33 == 1;
+    }
+
+    // for when you're sure that the matrix is affine
+    // inverts the upper 3x3 part and transforms the negated translation with it
+    // returns determinant
+    value_type inverse_affine()
+    {
+        YAMA_ASSERT_BAD(is_affine(), "affine inverse of a non-affine matrix");
+
+        const value_type a00 = m11*m22 - m12*m21;
+        const value_type a01 = m02*m21 - m01*m22;
+        const value_type a02 = m01*m12 - m02*m11;
+        const value_type a10 = m12*m20 - m10*m22;
+        const value_type a11 = m00*m22 - m02*m20;
+        const value_type a12 = m02*m10 - m00*m12;
+        const value_type a20 = m10*m21 - m11*m20;
+        const value_type a21 = m01*m20 - m00*m21;
+        const value_type a22 = m00*m11 - m01*m10;
+
+        const value_type det = m00*a00 + m01*a10 + m02*a20;
+        const value_type rdet = value_type(1) / det;
+
+        m00 = a00 * rdet; m01 = a01 * rdet; m02 = a02 * rdet;
+        m10 = a10 * rdet; m11 = a11 * rdet; m12 = a12 * rdet;
+        m20 = a20 * rdet; m21 = a21 * rdet; m22 = a22 * rdet;
+
+        const value_type tx = m03, ty = m13, tz = m23;
+        m03 = -(m00*tx + m01*ty + m02*tz);
+        m13 = -(m10*tx + m11*ty + m12*tz);
+        m23 = -(m20*tx + m21*ty + m22*tz);
 
         return det;
     }
+
+    // for when you're sure that the matrix is a rotation followed by a translation
+    // the inverse is the transposed rotation and the negated translation, rotated by it
+    matrix4x4_t& inverse_rigid()
+    {
+        YAMA_ASSERT_BAD(is_affine(), "rigid inverse of a non-affine matrix");
+
+        std::swap(m10, m01);
+        std::swap(m20, m02);
+        std::swap(m21, m12);
+
+        const value_type tx = m03, ty = m13, tz = m23;
+        m03 = -(m00*tx + m01*ty + m02*tz);
+        m13 = -(m10*tx + m11*ty + m12*tz);
+        m23 = -(m20*tx + m21*ty + m22*tz);
+
+        return *this;
+    }
+
+    // affine inverse if the matrix is affine and general inverse otherwise
+    // (telling rigid matrices from affine ones costs about as much as the affine inverse,
+    // so use inverse_rigid explicitly for them)
+    // returns determinant
+    value_type inverse_auto()
+    {
+        return is_affine() ? inverse_affine() : inverse();
+    }
 };
 
+#if YAMA_USE_SIMD
+template <>
+inline matrix4x4_t<float>& matrix4x4_t<float>::operator*=(const matrix4x4_t<float>& b)
+{
+    simd::matrix4x4_mul(data(), data(), b.data());
+    return *this;
+}
+
+template <>
+inline float matrix4x4_t<float>::determinant() const
+{
+    return simd::matrix4x4_determinant_sse(data());
+}
+
+template <>
+inline float matrix4x4_t<float>::inverse()
+{
+    return simd::matrix4x4_inverse_sse(data(), data());
+}
+#endif
+
 template <typename T>
 bool operator==(const matrix4x4_t<T>& a, const matrix4x4_t<T>& b)
 {
@@ -1138,6 +1249,15 @@ matrix4x4_t<T> operator*(const matrix4x4_t<T>& a, const matrix4x4_t<T>& b)
     );
 }
 
+#if YAMA_USE_SIMD
+inline matrix4x4_t<float> operator*(const matrix4x4_t<float>& a, const matrix4x4_t<float>& b)
+{
+    matrix4x4_t<float> ret;
+    simd::matrix4x4_mul(ret.data(), a.data(), b.data());
+    return ret;
+}
+#endif
+
 template <typename T>
 matrix4x4_t<T> abs(const matrix4x4_t<T>& a)
 {
@@ -1183,26 +1303,9 @@ bool isfinite(const matrix4x4_t<T>& a)
 template <typename T>
 matrix4x4_t<T> inverse(const matrix4x4_t<T>& a, T& out_determinant)
 {
-    out_determinant = a.determinant();
-
-    return matrix4x4_t<T>::columns(
-        (-(a.m13*a.m22*a.m31) + a.m12*a.m23*a.m31 + a.m13*a.m21*a.m32 - a.m11*a.m23*a.m32 - a.m12*a.m21*a.m33 + a.m11*a.m22*a.m33) / out_determinant,
-        (a.m13*a.m22*a.m30 - a.m12*a.m23*a.m30 - a.m13*a.m20*a.m32 + a.m10*a.m23*a.m32 + a.m12*a.m20*a.m33 - a.m10*a.m22*a.m33) / out_determinant,
-        (-(a.m13*a.m21*a.m30) + a.m11*a.m23*a.m30 + a.m13*a.m20*a.m31 - a.m10*a.m23*a.m31 - a.m11*a.m20*a.m33 + a.m10*a.m21*a.m33) / out_determinant,
-        (a.m12*a.m21*a.m30 - a.m11*a.m22*a.m30 - a.m12*a.m20*a.m31 + a.m10*a.m22*a.m31 + a.m11*a.m20*a.m32 - a.m10*a.m21*a.m32) / out_determinant,
-        (a.m03*a.m22*a.m31 - a.m02*a.m23*a.m31 - a.m03*a.m21*a.m32 + a.m01*a.m23*a.m32 + a.m02*a.m21*a.m33 - a.m01*a.m22*a.m33) / out_determinant,
-        (-(a.m03*a.m22*a.m30) + a.m02*a.m23*a.m30 + a.m03*a.m20*a.m32 - a.m00*a.m23*a.m32 - a.m02*a.m20*a.m33 + a.m00*a.m22*a.m33) / out_determinant,
-        (a.m03*a.m21*a.m30 - a.m01*a.m23*a.m30 - a.m03*a.m20*a.m31 + a.m00*a.m23*a.m31 + a.m01*a.m20*a.m33 - a.m00*a.m21*a.m33) / out_determinant,
-        (-(a.m02*a.m21*a.m30) + a.m01*a.m22*a.m30 + a.m02*a.m20*a.m31 - a.m00*a.m22*a.m31 - a.m01*a.m20*a.m32 + a.m00*a.m21*a.m32) / out_determinant,
-        (-(a.m03*a.m12*a.m31) + a.m02*a.m13*a.m31 + a.m03*a.m11*a.m32 - a.m01*a.m13*a.m32 - a.m02*a.m11*a.m33 + a.m01*a.m12*a.m33) / out_determinant,
-        (a.m03*a.m12*a.m30 - a.m02*a.m13*a.m30 - a.m03*a.m10*a.m32 + a.m00*a.m13*a.m32 + a.m02*a.m10*a.m33 - a.m00*a.m12*a.m33) / out_determinant,
-        (-(a.m03*a.m11*a.m30) + a.m01*a.m13*a.m30 + a.m03*a.m10*a.m31 - a.m00*a.m13*a.m31 - a.m01*a.m10*a.m33 + a.m00*a.m11*a.m33) / out_determinant,
-        (a.m02*a.m11*a.m30 - a.m01*a.m12*a.m30 - a.m02*a.m10*a.m31 + a.m00*a.m12*a.m31 + a.m01*a.m10*a.m32 - a.m00*a.m11*a.m32) / out_determinant,
-        (a.m03*a.m12*a.m21 - a.m02*a.m13*a.m21 - a.m03*a.m11*a.m22 + a.m01*a.m13*a.m22 + a.m02*a.m11*a.m23 - a.m01*a.m12*a.m23) / out_determinant,
-        (-(a.m03*a.m12*a.m20) + a.m02*a.m13*a.m20 + a.m03*a.m10*a.m22 - a.m00*a.m13*a.m22 - a.m02*a.m10*a.m23 + a.m00*a.m12*a.m23) / out_determinant,
-        (a.m03*a.m11*a.m20 - a.m01*a.m13*a.m20 - a.m03*a.m10*a.m21 + a.m00*a.m13*a.m21 + a.m01*a.m10*a.m23 - a.m00*a.m11*a.m23) / out_determinant,
-        (-(a.m02*a.m11*a.m20) + a.m01*a.m12*a.m20 + a.m02*a.m10*a.m21 - a.m00*a.m12*a.m21 - a.m01*a.m10*a.m22 + a.m00*a.m11*a.m22) / out_determinant
-    );
+    auto ret = a;
+    out_determinant = ret.inverse();
+    return ret;
 }
 
 template <typename T>
@@ -1212,6 +1315,61 @@ matrix4x4_t<T> inverse(const matrix4x4_t<T>& a)
     return inverse(a, det);
 }
 
+template <typename T>
+matrix4x4_t<T> inverse_affine(const matrix4x4_t<T>& a, T& out_determinant)
+{
+    auto ret = a;
+    out_determinant = ret.inverse_affine();
+    return ret;
+}
+
+template <typename T>
+matrix4x4_t<T> inverse_affine(const matrix4x4_t<T>& a)
+{
+    T det;
+    return inverse_affine(a, det);
+}
+
+template <typename T>
+matrix4x4_t<T> inverse_rigid(const matrix4x4_t<T>& a)
+{
+    auto ret = a;
+    return ret.inverse_rigid();
+}
+
+template <typename T>
+matrix4x4_t<T> inverse_auto(const matrix4x4_t<T>& a, T& out_determinant)
+{
+    auto ret = a;
+    out_determinant = ret.inverse_auto();
+    return ret;
+}
+
+template <typename T>
+matrix4x4_t<T> inverse_auto(const matrix4x4_t<T>& a)
+{
+    T det;
+    return inverse_auto(a, det);
+}
+
+// inverts count matrices from in to out
+// out may be the same as in
+template <typename T>
+void inverse(const matrix4x4_t<T>* in, size_t count, matrix4x4_t<T>* out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = inverse(in[i]);
+    }
+}
+
+#if YAMA_USE_SIMD
+inline void inverse(const matrix4x4_t<float>* in, size_t count, matrix4x4_t<float>* out)
+{
+    simd::matrix4x4_inverse(reinterpret_cast<float*>(out), reinterpret_cast<const float*>(in), count);
+}
+#endif
+
 template <typename T>
 vector3_t<T> transform_coord(const vector3_t<T>& v, const matrix4x4_t<T>& m)
 {
@@ -1239,6 +1397,53 @@ vector3_t<T> transform_normal(const vector3_t<T>& v, const matrix4x4_t<T>& m)
     return out;
 }
 
+// transforms count coordinates from in to out
+// the division by w is skipped for affine matrices
+// out may be the same as in
+template <typename T>
+void transform_coord(const vector3_t<T>* in, size_t count, const matrix4x4_t<T>& m, vector3_t<T>* out)
+{
+    if (!m.is_affine())
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = transform_coord(in[i], m);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto v = in[i];
+        out[i].x = m(0, 0) * v.x + m(0, 1) * v.y + m(0, 2) * v.z + m(0, 3);
+        out[i].y = m(1, 0) * v.x + m(1, 1) * v.y + m(1, 2) * v.z + m(1, 3);
+        out[i].z = m(2, 0) * v.x + m(2, 1) * v.y + m(2, 2) * v.z + m(2, 3);
+    }
+}
+
+// transforms count normals from in to out
+// out may be the same as in
+template <typename T>
+void transform_normal(const vector3_t<T>* in, size_t count, const matrix4x4_t<T>& m, vector3_t<T>* out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = transform_normal(in[i], m);
+    }
+}
+
+#if YAMA_USE_SIMD
+inline void transform_coord(const vector3_t<float>* in, size_t count, const matrix4x4_t<float>& m, vector3_t<float>* out)
+{
+    simd::transform_coord<4>(m.data(), reinterpret_cast<const float*>(in), count, reinterpret_cast<float*>(out), !m.is_affine());
+}
+
+inline void transform_normal(const vector3_t<float>* in, size_t count, const matrix4x4_t<float>& m, vector3_t<float>* out)
+{
+    simd::transform_normal<4>(m.data(), reinterpret_cast<const float*>(in), count, reinterpret_cast<float*>(out));
+}
+#endif
+
 // type traits
 template <typename T>
 struct is_yama<matrix4x4_t<T>> : public std::true_type {};
@@ -0,0 +1,148 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+#include "type_traits.hpp"
+
+#include "vector3.hpp"
+#include "simd/packed_normal.hpp"
+
+// Unit vectors (normals, tangents) packed in 16 or 32 bits with the octahedral encoding
+//
+// The two components are 8 or 16-bit signed normalized integers. The vectors don't need to be
+// normalized for packing (but can't be zero), and unpacking gives normalized vectors.
+// pack rounds to the nearest code of the projected vector and pack_precise picks the code around
+// it which unpacks closest to the vector. The largest angle between a vector and its unpacked one
+// is about 0.95 degrees with 16 bits and 0.0037 with 32 bits, and a third less with the precise codes.
+
+namespace yama
+{
+
+template <int Bits>
+struct packed_normal_t
+{
+    using codec = simd::impl::octahedral<Bits>;
+    using component_type = typename codec::component_type;
+
+    static constexpr int component_bits = Bits / 2;
+
+    component_type x, y;
+
+    template <typename T>
+    static packed_normal_t pack(const vector3_t<T>& n)
+    {
+        YAMA_ASSERT_BAD(!close(n.length_sq(), T(0)), "yama::packed_normal_t packing a zero vector");
+
+        T u, v;
+        project(n, u, v);
+        return {quantize(u), quantize(v)};
+    }
+
+    template <typename T>
+    static packed_normal_t pack_precise(const vector3_t<T>& n)
+    {
+        YAMA_ASSERT_BAD(!close(n.length_sq(), T(0)), "yama::packed_normal_t packing a zero vector");
+
+        T u, v;
+        project(n, u, v);
+        const T m = T(codec::component_max);
+        u = std::fmin(std::fmax(u * m, -m), m);
+        v = std::fmin(std::fmax(v * m, -m), m);
+
+        // the other candidates are a step towards the projected point on each axis
+        const T cu = std::nearbyint(u), cv = std::nearbyint(v);
+        const T du = u > cu ? T(1) : T(-1), dv = v > cv ? T(1) : T(-1);
+        const T nn = std::sqrt(n.length_sq());
+
+        packed_normal_t ret = {component_type(cu), component_type(cv)};
+        T best = dot(ret.template unpack<T>(), n) / nn;
+        for (int k = 1; k < 4; ++k)
+        {
+            const T a = std::fmin(std::fmax(cu + (k & 1 ? du : 0), -m), m);
+            const T b = std::fmin(std::fmax(cv + (k & 2 ? dv : 0), -m), m);
+            const packed_normal_t c = {component_type(a), component_type(b)};
+            const T d = dot(c.template unpack<T>(), n) / nn;
+            if (d > best)
+            {
+                best = d;
+                ret = c;
+            }
+        }
+        return ret;
+    }
+
+    template <typename T = float>
+    vector3_t<T> unpack() const
+    {
+        const T inv_m = T(1) / T(codec::component_max);
+        const T u = T(x) * inv_m, v = T(y) * inv_m;
+        auto ret = vector3_t<T>::coord(u, v, 1 - std::abs(u) - std::abs(v));
+        const T t = std::fmax(-ret.z, T(0));
+        ret.x -= std::copysign(t, u);
+        ret.y -= std::copysign(t, v);
+        return normalize(ret);
+    }
+
+    bool operator==(const packed_normal_t& b) const
+    {
+        return x == b.x && y == b.y;
+    }
+
+    bool operator!=(const packed_normal_t& b) const
+    {
+        return !operator==(b);
+    }
+
+private:
+    // the octahedral coordinates in [-1, 1]
+    template <typename T>
+    static void project(const vector3_t<T>& n, T& u, T& v)
+    {
+        const T s = T(1) / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+        const T px = n.x * s, py = n.y * s;
+        u = n.z < 0 ? std::copysign(1 - std::abs(py), px) : px;
+        v = n.z < 0 ? std::copysign(1 - std::abs(px), py) : py;
+    }
+
+    template <typename T>
+    static component_type quantize(T c)
+    {
+        const T m = T(codec::component_max);
+        return component_type(std::nearbyint(std::fmin(std::fmax(c * m, -m), m)));
+    }
+};
+
+using packed_normal16 = packed_normal_t<16>;
+using packed_normal32 = packed_normal_t<32>;
+
+// out[i] = packed_normal_t<Bits>::pack(in[i]), several at a time
+template <int Bits, typename T>
+void pack(const vector3_t<T>* in, size_t count, packed_normal_t<Bits>* out)
+{
+    static_assert(sizeof(packed_normal_t<Bits>) == Bits / 8, "yama::packed_normal_t must be a pair of components");
+    simd::pack_octahedral<Bits, false>(reinterpret_cast<const T*>(in), count, reinterpret_cast<typename packed_normal_t<Bits>::component_type*>(out));
+}
+
+// out[i] = packed_normal_t<Bits>::pack_precise(in[i]), several at a time
+template <int Bits, typename T>
+void pack_precise(const vector3_t<T>* in, size_t count, packed_normal_t<Bits>* out)
+{
+    simd::pack_octahedral<Bits, true>(reinterpret_cast<const T*>(in), count, reinterpret_cast<typename packed_normal_t<Bits>::component_type*>(out));
+}
+
+// out[i] = in[i].unpack<T>(), several at a time
+template <int Bits, typename T>
+void unpack(const packed_normal_t<Bits>* in, size_t count, vector3_t<T>* out)
+{
+    simd::unpack_octahedral<Bits>(reinterpret_cast<const typename packed_normal_t<Bits>::component_type*>(in), count, reinterpret_cast<T*>(out));
+}
+
+// type traits
+template <int Bits>
+struct is_yama<packed_normal_t<Bits>> : public std::true_type {};
+
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+#include "type_traits.hpp"
+
+#include "quaternion.hpp"
+#include "simd/packed_quaternion.hpp"
+
+// Unit quaternions packed in 32 or 48 bits with the smallest three encoding
+//
+// The three smaller components get 10 bits each in 32 bits, and 15 bits each in 48 bits.
+// The index of the largest one takes the remaining bits and it's restored from the unit length.
+// Unpacking gives a unit quaternion which is the same rotation as the packed one: each component
+// is within max_error of the packed quaternion or its negation.
+
+namespace yama
+{
+
+template <int Bits>
+struct packed_quaternion_t
+{
+    using codec = simd::impl::smallest_three<Bits>;
+
+    static constexpr int component_bits = codec::component_bits;
+
+    // the error of the three smaller components is up to half a step: e = 1 / (sqrt(2) * (2^bits - 1))
+    // the error of the largest one is up to 3e (to first order, as it's at least 1/2)
+    static constexpr float component_error = simd::impl::inv_sqrt2<float> / codec::component_mask;
+    static constexpr float max_error = 3 * component_error * (1 + 4 * component_error) + 1e-6f;
+
+    uint16_t words[codec::words];
+
+    template <typename T>
+    static packed_quaternion_t pack(const quaternion_t<T>& q)
+    {
+        YAMA_ASSERT_BAD(q.is_normalized(), "yama::packed_quaternion_t packing a non-normalized quaternion");
+
+        // the first largest, made positive
+        int index = 0;
+        for (int k = 1; k < 4; ++k)
+        {
+            if (std::abs(q[k]) > std::abs(q[index])) index = k;
+        }
+        const T sign = q[index] < 0 ? T(-1) : T(1);
+
+        uint64_t abc[3];
+        for (int k = 0, j = 0; k < 4; ++k)
+        {
+            if (k == index) continue;
+            T e = (q[k] * sign + simd::impl::inv_sqrt2<T>) * codec::template encode_scale<T>;
+            e = std::nearbyint(std::fmin(std::fmax(e, T(0)), T(codec::component_mask)));
+            abc[j++] = uint64_t(e);
+        }
+
+        packed_quaternion_t ret;
+        codec::write(codec::join(uint64_t(index), abc[0], abc[1], abc[2]), ret.words);
+        return ret;
+    }
+
+    template <typename T = float>
+    quaternion_t<T> unpack() const
+    {
+        const uint64_t v = codec::read(words);
+        const int index = int(v >> 3 * component_bits);
+
+        quaternion_t<T> ret;
+        T sum = 0;
+        for (int k = 0, j = 0; k < 4; ++k)
+        {
+            if (k == index) continue;
+            const auto c = T((v >> (2 - j++) * component_bits) & codec::component_mask);
+            ret[k] = c * codec::template decode_scale<T> - simd::impl::inv_sqrt2<T>;
+            sum += ret[k] * ret[k];
+        }
+        ret[index] = std::sqrt(std::fmax(1 - sum, T(0)));
+        return ret;
+    }
+
+    bool operator==(const packed_quaternion_t& b) const
+    {
+        return codec::read(words) == codec::read(b.words);
+    }
+
+    bool operator!=(const packed_quaternion_t& b) const
+    {
+        return !operator==(b);
+    }
+};
+
+using packed_quaternion32 = packed_quaternion_t<32>;
+using packed_quaternion48 = packed_quaternion_t<48>;
+
+// out[i] = packed_quaternion_t<Bits>::pack(in[i]), several at a time
+template <int Bits, typename T>
+void pack(const quaternion_t<T>* in, size_t count, packed_quaternion_t<Bits>* out)
+{
+    static_assert(sizeof(packed_quaternion_t<Bits>) == Bits / 8, "yama::packed_quaternion_t must be an array of words");
+    simd::pack_smallest_three<Bits>(reinterpret_cast<const T*>(in), count, reinterpret_cast<uint16_t*>(out));
+}
+
+// out[i] = in[i].unpack<T>(), several at a time
+template <int Bits, typename T>
+void unpack(const packed_quaternion_t<Bits>* in, size_t count, quaternion_t<T>* out)
+{
+    simd::unpack_smallest_three<Bits>(reinterpret_cast<const uint16_t*>(in), count, reinterpret_cast<T*>(out));
+}
+
+// type traits
+template <int Bits>
+struct is_yama<packed_quaternion_t<Bits>> : public std::true_type {};
+
+}
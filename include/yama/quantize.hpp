@@ -0,0 +1,51 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstddef>
+
+#include "vector3.hpp"
+#include "box.hpp"
+#include "simd/quantize.hpp"
+
+// Quantization of positions to unsigned integers of Bits bits relative to a box
+//
+// Each coordinate is mapped linearly from [min, max] of the box along its axis to
+// [0, 2^Bits - 1] and rounded, so the positions inside the box are restored within
+// quantization_error of the original ones. Positions outside of the box are clamped to it.
+// The integers are the smallest unsigned type of Bits bits, 3 per position.
+
+namespace yama
+{
+
+using simd::quantized_t;
+
+// the largest error along each axis for positions inside the box: half a step
+template <int Bits = 16, typename T>
+vector3_t<T> quantization_error(const boxnt<3, T>& bounds)
+{
+    return bounds.size() / (2 * simd::impl::quantized_max<Bits, T>());
+}
+
+// out gets 3 integers per position
+// returns the largest difference between the positions and the dequantized ones along each axis
+template <int Bits = 16, typename T>
+vector3_t<T> quantize(const boxnt<3, T>& bounds, const vector3_t<T>* in, size_t count, quantized_t<Bits>* out)
+{
+    static_assert(sizeof(vector3_t<T>) == 3 * sizeof(T), "yama::vector3_t must be an array of 3 values");
+    const auto size = bounds.size();
+    vector3_t<T> ret;
+    simd::quantize3<Bits>(bounds.min.data(), size.data(), reinterpret_cast<const T*>(in), count, out, ret.data());
+    return ret;
+}
+
+// in has 3 integers per position
+template <int Bits = 16, typename T>
+void dequantize(const boxnt<3, T>& bounds, const quantized_t<Bits>* in, size_t count, vector3_t<T>* out)
+{
+    const auto size = bounds.size();
+    simd::dequantize3<Bits>(bounds.min.data(), size.data(), in, count, reinterpret_cast<T*>(out));
+}
+
+}
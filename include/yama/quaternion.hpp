@@ -15,6 +15,8 @@
 #include "vector3.hpp"
 #include "vector4.hpp"
 
+#include "simd/quaternion.hpp"
+
 namespace yama
 {
 
@@ -672,19 +674,34 @@ quaternion_t<T> lerp(const quaternion_t<T>& from, const quaternion_t<T>& to, con
     return normalize(q);
 }
 
+// normalized lerp along the shorter arc
+template <typename T>
+quaternion_t<T> nlerp(const quaternion_t<T>& from, const quaternion_t<T>& to, const T& ratio)
+{
+    // q and -q are the same rotation
+    auto target = dot(from, to) < 0 ? -to : to;
+    return lerp(from, target, ratio);
+}
+
 template <typename T>
 quaternion_t<T> slerp(const quaternion_t<T>& from, const quaternion_t<T>& to, T ratio)
 {
     T cos_angle = dot(from, to);
 
-    // if the angle is small (ie cos_angle is close to -1 or 1),
-    // could use lerp, instead of slerp:
-    // if(cos_angle < -0.99 || cos_angle > 0.99) return lerp(from, to, ratio)
-    // need to test how this works
+    // q and -q are the same rotation: take the shorter arc
+    auto target = to;
+    if (cos_angle < 0)
+    {
+        cos_angle = -cos_angle;
+        target = -to;
+    }
+
+    // if the angle is small, sin(angle) is close to zero and lerp is just as good
+    if (cos_angle > simd::slerp_nlerp_threshold<T>) return lerp(from, target, ratio);
 
     T angle = std::acos(cos_angle);
 
-    return (from*std::sin((1 - ratio)*angle) + to*std::sin(angle*ratio)) / std::sin(angle);
+    return (from*std::sin((1 - ratio)*angle) + target*std::sin(angle*ratio)) / std::sin(angle);
 }
 
 template <typename T>
@@ -720,6 +737,53 @@ vector3_t<T> rotate(const vector3_t<T>& v, const quaternion_t<T>& q)
     return v + ((c1 * q.w) + c2) * T(2);
 }
 
+// rotates count vectors from in to out by q
+// out may be the same as in
+template <typename T>
+void rotate(const vector3_t<T>* in, size_t count, const quaternion_t<T>& q, vector3_t<T>* out)
+{
+    simd::rotate_by_quaternion(q.data(), reinterpret_cast<const T*>(in), count, reinterpret_cast<T*>(out));
+}
+
+// out[i] = rotate(in[i], q[i])
+// out may be the same as in
+template <typename T>
+void rotate(const vector3_t<T>* in, size_t count, const quaternion_t<T>* q, vector3_t<T>* out)
+{
+    simd::rotate_by_quaternions(reinterpret_cast<const T*>(q), reinterpret_cast<const T*>(in), count, reinterpret_cast<T*>(out));
+}
+
+// batch interpolation of count quaternions from from and to into out
+// out may be the same as from or to
+// these take the shorter arc, and slerp falls back to nlerp for small angles like the functions above
+// but they process several quaternions at once and slerp for float uses polynomial approximations of acos and sin
+// (absolute error below 1e-6)
+template <typename T>
+void slerp(const quaternion_t<T>* from, const quaternion_t<T>* to, size_t count, T ratio, quaternion_t<T>* out)
+{
+    simd::quaternion_slerp(reinterpret_cast<const T*>(from), reinterpret_cast<const T*>(to), count, ratio, reinterpret_cast<T*>(out));
+}
+
+// out[i] = slerp(from[i], to[i], ratios[i])
+template <typename T>
+void slerp(const quaternion_t<T>* from, const quaternion_t<T>* to, size_t count, const T* ratios, quaternion_t<T>* out)
+{
+    simd::quaternion_slerp(reinterpret_cast<const T*>(from), reinterpret_cast<const T*>(to), count, ratios, reinterpret_cast<T*>(out));
+}
+
+template <typename T>
+void nlerp(const quaternion_t<T>* from, const quaternion_t<T>* to, size_t count, T ratio, quaternion_t<T>* out)
+{
+    simd::quaternion_nlerp(reinterpret_cast<const T*>(from), reinterpret_cast<const T*>(to), count, ratio, reinterpret_cast<T*>(out));
+}
+
+// out[i] = nlerp(from[i], to[i], ratios[i])
+template <typename T>
+void nlerp(const quaternion_t<T>* from, const quaternion_t<T>* to, size_t count, const T* ratios, quaternion_t<T>* out)
+{
+    simd::quaternion_nlerp(reinterpret_cast<const T*>(from), reinterpret_cast<const T*>(to), count, ratios, reinterpret_cast<T*>(out));
+}
+
 // type traits
 template <typename T>
 struct is_yama<quaternion_t<T>> : public std::true_type {};
@@ -0,0 +1,154 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "util.hpp"
+#include "shorthand.hpp"
+#include "type_traits.hpp"
+
+#include "vector3.hpp"
+#include "box.hpp"
+#include "simd/ray.hpp"
+
+// Rays in 3d space: origin + t * direction
+// They cache the inverse of the direction and its signs for the slab tests against boxes
+
+namespace yama
+{
+
+template <typename T>
+class ray_t
+{
+public:
+    vector3_t<T> origin;
+    vector3_t<T> direction;
+    vector3_t<T> inv_direction; // 1 / direction per component (zero components give infinity)
+    int sign[3]; // 1 for the negative components of the direction
+
+    using value_type = T;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // named constructors
+    // the direction doesn't need to be normalized: t is in units of its length
+
+    static ray_t origin_direction(const vector3_t<T>& origin, const vector3_t<T>& direction)
+    {
+        ray_t ret;
+        ret.origin = origin;
+        ret.direction = direction;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            ret.inv_direction.at(i) = T(1) / direction.at(i);
+            ret.sign[i] = ret.inv_direction.at(i) < 0;
+        }
+        return ret;
+    }
+
+    // t in [0, 1] is the segment from a to b
+    static ray_t from_to(const vector3_t<T>& a, const vector3_t<T>& b)
+    {
+        return origin_direction(a, b - a);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // utils
+
+    vector3_t<T> at(const value_type& t) const
+    {
+        return origin + direction * t;
+    }
+
+    // slab test of the box and the part of the ray with t in [0, max_t]
+    // on a hit returns true and sets t_enter to the t at which the ray enters the box (0 if it starts in it)
+    // a ray which lies on a side of the box hits it
+    bool intersects(const boxnt<3, T>& b, const value_type& max_t, value_type& t_enter) const
+    {
+        // the near and far planes are indexed by the signs, so there are no branches
+        // a NaN (0 * inf, when the ray lies on a plane) fails the comparisons and leaves t0 and t1 as they are
+        const vector3_t<T>* planes[2] = {&b.min, &b.max};
+        T t0 = 0, t1 = max_t;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            const T t_near = (planes[sign[i]]->at(i) - origin.at(i)) * inv_direction.at(i);
+            const T t_far = (planes[1 - sign[i]]->at(i) - origin.at(i)) * inv_direction.at(i);
+            t0 = t_near > t0 ? t_near : t0;
+            t1 = t_far < t1 ? t_far : t1;
+        }
+        t_enter = t0;
+        return t0 <= t1;
+    }
+
+    bool intersects(const boxnt<3, T>& b, const value_type& max_t = std::numeric_limits<T>::max()) const
+    {
+        T t;
+        return intersects(b, max_t, t);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// batch slab tests
+// bit i % 32 of hits[i / 32] is set for a hit of test i, so hits must have room for (count + 31) / 32 words
+// t_enter is optional and gets the distances at which the rays enter the boxes (infinity for the misses)
+
+// one ray against count boxes
+template <typename T>
+void intersects(const ray_t<T>& ray, const boxnt<3, T>* boxes, size_t count, const T& max_t, uint32_t* hits, T* t_enter = nullptr)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i % 32 == 0) hits[i / 32] = 0;
+        T t;
+        const bool hit = ray.intersects(boxes[i], max_t, t);
+        hits[i / 32] |= uint32_t(hit) << (i % 32);
+        if (t_enter) t_enter[i] = hit ? t : std::numeric_limits<T>::infinity();
+    }
+}
+
+inline void intersects(const ray_t<float>& ray, const boxnt<3, float>* boxes, size_t count, float max_t, uint32_t* hits, float* t_enter = nullptr)
+{
+    static_assert(sizeof(boxnt<3, float>) == 6 * sizeof(float), "boxes must be arrays of 6 floats");
+    const float r[6] = {ray.origin.x, ray.origin.y, ray.origin.z, ray.inv_direction.x, ray.inv_direction.y, ray.inv_direction.z};
+    simd::ray_boxes(r, reinterpret_cast<const float*>(boxes), count, max_t, hits, t_enter);
+}
+
+// count rays, given by their origins and inverse directions, against one box
+template <typename T>
+void intersects(const vector3_t<T>* origins, const vector3_t<T>* inv_directions, size_t count, const boxnt<3, T>& box, const T& max_t, uint32_t* hits, T* t_enter = nullptr)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        ray_t<T> ray;
+        ray.origin = origins[i];
+        ray.inv_direction = inv_directions[i];
+        for (size_t k = 0; k < 3; ++k) ray.sign[k] = inv_directions[i].at(k) < 0;
+
+        if (i % 32 == 0) hits[i / 32] = 0;
+        T t;
+        const bool hit = ray.intersects(box, max_t, t);
+        hits[i / 32] |= uint32_t(hit) << (i % 32);
+        if (t_enter) t_enter[i] = hit ? t : std::numeric_limits<T>::infinity();
+    }
+}
+
+inline void intersects(const vector3_t<float>* origins, const vector3_t<float>* inv_directions, size_t count, const boxnt<3, float>& box, float max_t, uint32_t* hits, float* t_enter = nullptr)
+{
+    simd::rays_box(reinterpret_cast<const float*>(origins), reinterpret_cast<const float*>(inv_directions), count, reinterpret_cast<const float*>(&box), max_t, hits, t_enter);
+}
+
+// type traits
+template <typename T>
+struct is_yama<ray_t<T>> : public std::true_type {};
+
+// shorthand
+#if !defined(YAMA_NO_SHORTHAND)
+
+using ray = ray_t<preferred_type>;
+
+#endif
+
+}
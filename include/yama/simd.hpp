@@ -0,0 +1,49 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+// Instruction set detection for the SIMD kernels in yama/simd/
+//
+// YAMA_SIMD_SSE and YAMA_SIMD_AVX are always defined (to 0 or 1) and tell which
+// kernels are available for the current compilation target. The kernels themselves
+// can always be called directly when available.
+//
+// Routing of the regular operators of the float types (say matrix4x4_t<float>::operator*=)
+// through the kernels is opt-in. Define YAMA_SIMD before including yama to enable it.
+// As with YAMA_ASSERT_LEVEL, all translation units of a program must agree on it.
+//
+// Define YAMA_SIMD_NO_AVX to only use SSE even if the target supports AVX.
+//
+// YAMA_SIMD_F16C tells whether the conversions between float and half-precision floats
+// have instructions (the target supports F16C).
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define YAMA_SIMD_SSE 1
+#else
+#   define YAMA_SIMD_SSE 0
+#endif
+
+#if YAMA_SIMD_SSE && !defined(YAMA_SIMD_NO_AVX) && defined(__AVX__) && (defined(__FMA__) || defined(__AVX2__))
+#   define YAMA_SIMD_AVX 1
+#else
+#   define YAMA_SIMD_AVX 0
+#endif
+
+#if YAMA_SIMD_SSE && defined(__F16C__)
+#   define YAMA_SIMD_F16C 1
+#else
+#   define YAMA_SIMD_F16C 0
+#endif
+
+#if defined(YAMA_SIMD) && YAMA_SIMD_SSE
+#   define YAMA_USE_SIMD 1
+#else
+#   define YAMA_USE_SIMD 0
+#endif
+
+#if YAMA_SIMD_AVX || YAMA_SIMD_F16C
+#   include <immintrin.h>
+#elif YAMA_SIMD_SSE
+#   include <emmintrin.h>
+#endif
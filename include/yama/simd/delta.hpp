@@ -0,0 +1,217 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "../simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Delta compression of arrays of unsigned integers against a baseline array
+//
+// The differences with the baseline (mod 2^32) are zig-zag encoded, so that small negative
+// ones become small integers too, and bit-packed in blocks of 128 with the bit width of the
+// largest one in the block. A block is a byte with the width b followed by 16 * b bytes:
+// b little-endian 32-bit words for each of 4 interleaved lanes, where value j is in lane j % 4.
+// The last block, if shorter, is the width byte followed by its values packed in sequence
+// (least significant bits first) in the fewest bytes.
+// Equal values take 1 byte per block. The decoding uses SSE2 when available.
+
+namespace yama
+{
+namespace simd
+{
+
+constexpr size_t delta_block_size = 128;
+
+namespace impl
+{
+inline uint32_t zigzag(uint32_t d)
+{
+    return (d << 1) ^ (0u - (d >> 31));
+}
+
+inline uint32_t unzigzag(uint32_t z)
+{
+    return (z >> 1) ^ (0u - (z & 1));
+}
+
+inline uint32_t bit_mask(int bits)
+{
+    return uint32_t((uint64_t(1) << bits) - 1);
+}
+
+inline uint32_t read_le32(const uint8_t* p)
+{
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+inline void write_le32(uint32_t v, uint8_t* p)
+{
+    for (int k = 0; k < 4; ++k) p[k] = uint8_t(v >> 8 * k);
+}
+
+// the 128 zig-zag encoded values of a block of width b at p
+inline void unpack_delta_block(const uint8_t* p, int b, uint32_t* z)
+{
+    const uint32_t mask = bit_mask(b);
+    for (int l = 0; l < 4; ++l)
+    {
+        for (int r = 0; r < 32; ++r)
+        {
+            const int bit = r * b, w = bit / 32, off = bit % 32;
+            uint64_t v = b ? read_le32(p + 4 * (4 * w + l)) : 0;
+            if (off + b > 32) v |= uint64_t(read_le32(p + 4 * (4 * w + 4 + l))) << 32;
+            z[4 * r + l] = uint32_t(v >> off) & mask;
+        }
+    }
+}
+
+// out[i] = base[i] + unzigzag(value i) for a full block of width b at p (base can be null)
+inline void decode_delta_block(const uint8_t* p, int b, const uint32_t* base, uint32_t* out)
+{
+#if YAMA_SIMD_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i mask = _mm_set1_epi32(int(bit_mask(b)));
+    const __m128i* wp = reinterpret_cast<const __m128i*>(p);
+
+    // the lanes of the words are the lanes of the values, so each vector is 4 consecutive values
+    __m128i cur = b ? _mm_loadu_si128(wp) : zero;
+    int off = 0; // the bit offset of the next value in cur
+    for (int r = 0; r < 32; ++r)
+    {
+        __m128i z = _mm_srl_epi32(cur, _mm_cvtsi32_si128(off));
+        off += b;
+        if (off > 32)
+        {
+            // the value continues in the next word
+            cur = _mm_loadu_si128(++wp);
+            off -= 32;
+            z = _mm_or_si128(z, _mm_sll_epi32(cur, _mm_cvtsi32_si128(b - off)));
+        }
+        else if (off == 32 && r < 31)
+        {
+            cur = _mm_loadu_si128(++wp);
+            off = 0;
+        }
+        z = _mm_and_si128(z, mask);
+
+        __m128i d = _mm_xor_si128(_mm_srli_epi32(z, 1), _mm_sub_epi32(zero, _mm_and_si128(z, one)));
+        if (base) d = _mm_add_epi32(d, _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 4 * r)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * r), d);
+    }
+#else
+    uint32_t z[delta_block_size];
+    unpack_delta_block(p, b, z);
+    for (size_t j = 0; j < delta_block_size; ++j)
+    {
+        out[j] = (base ? base[j] : 0) + unzigzag(z[j]);
+    }
+#endif
+}
+}
+
+// the largest size of the encoding of count values
+inline size_t max_deltas_size(size_t count)
+{
+    return 4 * count + (count + delta_block_size - 1) / delta_block_size;
+}
+
+// in are count values, base is the baseline (null for zeros)
+// out gets up to max_deltas_size(count) bytes
+// returns the size of the encoding
+inline size_t encode_deltas(const uint32_t* in, const uint32_t* base, size_t count, uint8_t* out)
+{
+    uint8_t* p = out;
+    uint32_t z[delta_block_size];
+    for (size_t i = 0; i < count; i += delta_block_size)
+    {
+        const size_t n = count - i < delta_block_size ? count - i : delta_block_size;
+        uint32_t all = 0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            z[j] = impl::zigzag(in[i + j] - (base ? base[i + j] : 0));
+            all |= z[j];
+        }
+
+        int b = 0;
+        while (b < 32 && (all >> b)) ++b;
+        *p++ = uint8_t(b);
+
+        if (n == delta_block_size)
+        {
+            uint32_t words[delta_block_size] = {};
+            for (int l = 0; l < 4; ++l)
+            {
+                for (int r = 0; r < 32 && b; ++r)
+                {
+                    const int bit = r * b, w = bit / 32, off = bit % 32;
+                    const uint32_t v = z[4 * r + l];
+                    words[4 * w + l] |= v << off;
+                    if (off + b > 32) words[4 * w + 4 + l] |= v >> (32 - off);
+                }
+            }
+            for (int k = 0; k < 4 * b; ++k) impl::write_le32(words[k], p + 4 * k);
+            p += 16 * b;
+        }
+        else
+        {
+            uint64_t acc = 0;
+            int bits = 0;
+            for (size_t j = 0; j < n; ++j)
+            {
+                acc |= uint64_t(z[j]) << bits;
+                bits += b;
+                for (; bits >= 8; bits -= 8, acc >>= 8) *p++ = uint8_t(acc);
+            }
+            if (bits) *p++ = uint8_t(acc);
+        }
+    }
+    return size_t(p - out);
+}
+
+// in is an encoding of count values in size bytes, base is the baseline it was encoded with (null for zeros)
+// out gets count values
+// returns the size of the encoding, or 0 if it's malformed (truncated or with a bad width)
+// (only the encoding of 0 values is empty)
+inline size_t decode_deltas(const uint8_t* in, size_t size, const uint32_t* base, size_t count, uint32_t* out)
+{
+    const uint8_t* p = in;
+    const uint8_t* const end = in + size;
+    for (size_t i = 0; i < count; i += delta_block_size)
+    {
+        const size_t n = count - i < delta_block_size ? count - i : delta_block_size;
+        if (p == end) return 0;
+        const int b = *p++;
+        if (b > 32) return 0;
+
+        const size_t bytes = (n * size_t(b) + 7) / 8;
+        if (size_t(end - p) < bytes) return 0;
+
+        if (n == delta_block_size)
+        {
+            impl::decode_delta_block(p, b, base ? base + i : nullptr, out + i);
+            p += bytes;
+        }
+        else
+        {
+            const uint32_t mask = impl::bit_mask(b);
+            uint64_t acc = 0;
+            int bits = 0;
+            for (size_t j = 0; j < n; ++j)
+            {
+                for (; bits < b; bits += 8) acc |= uint64_t(*p++) << bits;
+                const uint32_t z = uint32_t(acc) & mask;
+                acc >>= b;
+                bits -= b;
+                out[i + j] = (base ? base[i + j] : 0) + impl::unzigzag(z);
+            }
+        }
+    }
+    return size_t(p - in);
+}
+
+}
+}
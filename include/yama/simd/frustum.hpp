@@ -0,0 +1,173 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+// SIMD kernels for culling spheres and 3d boxes by a frustum
+//
+// The frustum is 6 planes of 4 values each: (a, b, c, d) with normalized (a, b, c), so that
+// a * x + b * y + c * z + d is the signed distance of a point, positive on the inside.
+// An object is culled if it's completely on the outside of a plane. The test is conservative:
+// some objects which are outside of the frustum, but not of any single plane, are not culled.
+//
+// The results are a bit per object in 32-bit words (bit i % 32 of word i / 32), set if the
+// object is not culled. The optional hints are a plane index per object: the plane which
+// culled it the last time. When the hint plane of the first object of a pack culls all of them,
+// the other planes are not tested (and it becomes the hint of all of them).
+
+namespace yama
+{
+namespace simd
+{
+
+// the order in which the planes are tested (here and in frustum_t::test)
+// the near and far planes go first: they cull everything behind the camera or too far from it,
+// which is usually most of the scene
+inline constexpr int frustum_test_order[6] = {4, 5, 0, 1, 2, 3};
+
+namespace impl
+{
+// load(i, c, e) loads the centers of the objects i to i + W and their extents e,
+// and margin(plane, e) gives the extents along the normal of the plane
+template <typename P, typename T, typename Load, typename Margin>
+void frustum_cull(const T* planes, size_t count, uint32_t* hits, uint8_t* hints, Load load, Margin margin)
+{
+    constexpr size_t W = P::width;
+    static_assert(32 % W == 0, "the packs must fill the hit words");
+
+    P pl[6][4];
+    for (int k = 0; k < 6; ++k)
+    {
+        for (int j = 0; j < 4; ++j) pl[k][j] = P::uniform(planes[4 * k + j]);
+    }
+
+    for (size_t i = 0; i < count; i += W)
+    {
+        const size_t n = count - i < W ? count - i : W;
+        const uint32_t valid = n < W ? (uint32_t(1) << n) - 1 : uint32_t(-1) >> (32 - W);
+
+        P c[3], e[3];
+        load(i, c, e);
+
+        auto outside = [&](const P* p) {
+            const P dist = fmadd(p[0], c[0], fmadd(p[1], c[1], fmadd(p[2], c[2], p[3])));
+            return dist < -margin(p, e);
+        };
+
+        // the objects of a pack usually come from the same part of the scene and share their hints
+        // if the hint of the first one culls them all, the other planes are not tested
+        if (hints && hints[i] < 6 && (uint32_t(mask_bits(outside(pl[hints[i]]))) & valid) == valid)
+        {
+            std::memset(hints + i, hints[i], n);
+            if (i % 32 == 0) hits[i / 32] = 0;
+            continue;
+        }
+
+        // the lanes culled by each plane
+        uint32_t plane_bits[6];
+        uint32_t culled = 0;
+        for (int k = 0; k < 6; ++k)
+        {
+            plane_bits[k] = uint32_t(mask_bits(outside(pl[k]))) & valid;
+            culled |= plane_bits[k];
+        }
+
+        if (hints)
+        {
+            // keep the hints which culled their objects again and set the others to the first plane which did
+            for (size_t j = 0; j < n; ++j)
+            {
+                uint8_t& h = hints[i + j];
+                if (!(culled >> j & 1) || (h < 6 && (plane_bits[h] >> j & 1))) continue;
+                for (int k : frustum_test_order)
+                {
+                    if (plane_bits[k] >> j & 1)
+                    {
+                        h = uint8_t(k);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (i % 32 == 0) hits[i / 32] = 0;
+        hits[i / 32] |= (~culled & valid) << (i % 32);
+    }
+}
+
+// loads the points (3 values each) of the objects i to i + W, with zeros in the padding
+template <typename P, typename T>
+void frustum_load3(const T* ptr, size_t i, size_t count, P (&v)[3])
+{
+    constexpr size_t W = P::width;
+    if (i + W <= count)
+    {
+        load3(ptr + 3 * i, v[0], v[1], v[2]);
+    }
+    else
+    {
+        T buf[3 * W] = {};
+        std::memcpy(buf, ptr + 3 * i, 3 * (count - i) * sizeof(T));
+        load3(buf, v[0], v[1], v[2]);
+    }
+}
+}
+
+// count spheres given by their centers (arrays of 3d vectors) and radii
+template <typename P = f32xn, typename T = typename P::value_type>
+void frustum_spheres(const T* planes, const T* centers, const T* radii, size_t count, uint32_t* hits, uint8_t* hints)
+{
+    constexpr size_t W = P::width;
+    impl::frustum_cull<P>(planes, count, hits, hints,
+        [&](size_t i, P (&c)[3], P (&r)[3]) {
+            impl::frustum_load3(centers, i, count, c);
+            if (i + W <= count)
+            {
+                r[0] = P::load(radii + i);
+            }
+            else
+            {
+                T buf[W] = {};
+                std::memcpy(buf, radii + i, (count - i) * sizeof(T));
+                r[0] = P::load(buf);
+            }
+        },
+        [](const P*, const P (&r)[3]) { return r[0]; });
+}
+
+// count boxes of 6 values: min xyz and max xyz (the layout of boxnt<3, float>)
+template <typename P = f32xn, typename T = typename P::value_type>
+void frustum_boxes(const T* planes, const T* boxes, size_t count, uint32_t* hits, uint8_t* hints)
+{
+    constexpr size_t W = P::width;
+    const P half = P::uniform(T(0.5));
+    impl::frustum_cull<P>(planes, count, hits, hints,
+        [&](size_t i, P (&c)[3], P (&e)[3]) {
+            P lo[3], hi[3];
+            if (i + W <= count)
+            {
+                load3_pairs(boxes + 6 * i, lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+            }
+            else
+            {
+                T buf[6 * W] = {};
+                std::memcpy(buf, boxes + 6 * i, 6 * (count - i) * sizeof(T));
+                load3_pairs(buf, lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                c[k] = (lo[k] + hi[k]) * half;
+                e[k] = (hi[k] - lo[k]) * half;
+            }
+        },
+        // the extent of the box along the normal
+        [](const P* p, const P (&e)[3]) { return fmadd(abs(p[0]), e[0], fmadd(abs(p[1]), e[1], abs(p[2]) * e[2])); });
+}
+
+}
+}
@@ -0,0 +1,167 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "../simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Conversions between float and half-precision floats (IEEE 754 binary16)
+//
+// The halves are their 16 bits. Floats are rounded to the nearest half (ties to even), so
+// values from 65520 up become infinity and tiny ones become subnormals or zeros. NaNs stay
+// NaNs (quiet ones) with the top bits of their payload.
+// The conversions use the F16C instructions when available and the software ones in impl,
+// which give the same results, otherwise.
+
+namespace yama
+{
+namespace simd
+{
+
+namespace impl
+{
+inline uint16_t float_to_half(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    const uint16_t sign = uint16_t((u >> 16) & 0x8000);
+    const uint32_t a = u & 0x7fffffff;
+
+    if (a >= 0x7f800000)
+    {
+        // infinity or NaN
+        return sign | 0x7c00 | (a > 0x7f800000 ? 0x200 | ((a >> 13) & 0x3ff) : 0);
+    }
+    if (a >= 0x477ff000)
+    {
+        // 65520 and above
+        return sign | 0x7c00;
+    }
+    if (a >= 0x38800000)
+    {
+        // normal: rebias the exponent from 127 to 15 and round the mantissa from 23 to 10 bits
+        return sign | uint16_t((a - 0x38000000 + 0xfff + ((a >> 13) & 1)) >> 13);
+    }
+
+    // subnormal or zero: the value in units of 2^-24
+    const uint32_t e = a >> 23;
+    if (e < 102) return sign;
+    const uint32_t m = (a & 0x7fffff) | 0x800000;
+    const uint32_t shift = 126 - e;
+    uint32_t h = m >> shift;
+    const uint32_t rest = m & ((uint32_t(1) << shift) - 1);
+    const uint32_t half = uint32_t(1) << (shift - 1);
+    if (rest > half || (rest == half && (h & 1))) ++h;
+    return sign | uint16_t(h);
+}
+
+inline float half_to_float(uint16_t h)
+{
+    const uint32_t sign = uint32_t(h & 0x8000) << 16;
+    const uint32_t e = (h >> 10) & 0x1f;
+    uint32_t m = h & 0x3ff;
+
+    uint32_t u;
+    if (e == 0x1f)
+    {
+        // infinity or NaN (made quiet)
+        u = sign | 0x7f800000 | (m ? 0x400000 | (m << 13) : 0);
+    }
+    else if (e)
+    {
+        u = sign | ((e + 112) << 23) | (m << 13);
+    }
+    else if (m)
+    {
+        // subnormal: normalize
+        uint32_t exp = 113;
+        while (!(m & 0x400))
+        {
+            m <<= 1;
+            --exp;
+        }
+        u = sign | (exp << 23) | ((m & 0x3ff) << 13);
+    }
+    else
+    {
+        u = sign;
+    }
+
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+}
+
+inline uint16_t float_to_half(float f)
+{
+#if YAMA_SIMD_F16C
+    return uint16_t(_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT));
+#else
+    return impl::float_to_half(f);
+#endif
+}
+
+inline float half_to_float(uint16_t h)
+{
+#if YAMA_SIMD_F16C
+    return _cvtsh_ss(h);
+#else
+    return impl::half_to_float(h);
+#endif
+}
+
+// out[i] = float_to_half(in[i])
+inline void float_to_half(const float* in, size_t count, uint16_t* out)
+{
+    size_t i = 0;
+#if YAMA_SIMD_F16C
+#   if YAMA_SIMD_AVX
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#   endif
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i h = _mm_cvtps_ph(_mm_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = float_to_half(in[i]);
+    }
+}
+
+// out[i] = half_to_float(in[i])
+inline void half_to_float(const uint16_t* in, size_t count, float* out)
+{
+    size_t i = 0;
+#if YAMA_SIMD_F16C
+#   if YAMA_SIMD_AVX
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#   endif
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(out + i, _mm_cvtph_ps(h));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+}
+}
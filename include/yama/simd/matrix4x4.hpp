@@ -0,0 +1,296 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "../simd.hpp"
+#include <cstddef>
+
+// SIMD kernels for 4x4 float matrices
+// They work on column-major arrays of 16 floats (the layout of matrix4x4_t<float>)
+// No alignment is required
+
+namespace yama
+{
+namespace simd
+{
+
+#if YAMA_SIMD_SSE
+
+// out = a * b
+// out may alias a or b
+inline void matrix4x4_mul_sse(float* out, const float* a, const float* b)
+{
+    const __m128 a0 = _mm_loadu_ps(a);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        // column i of the product is a linear combination of the columns of a
+        // with the elements of column i of b as coefficients
+        const __m128 bc = _mm_loadu_ps(b + 4 * i);
+        __m128 c = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(0, 0, 0, 0)));
+        c = _mm_add_ps(c, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(1, 1, 1, 1))));
+        c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(2, 2, 2, 2))));
+        c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(out + 4 * i, c);
+    }
+}
+
+#endif
+
+#if YAMA_SIMD_AVX
+
+// out = a * b
+// out may alias a or b
+// two columns of the product per iteration, with fused multiply-adds
+inline void matrix4x4_mul_avx(float* out, const float* a, const float* b)
+{
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+
+    const __m256 b01 = _mm256_loadu_ps(b);
+    const __m256 b23 = _mm256_loadu_ps(b + 8);
+
+    __m256 c01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, _MM_SHUFFLE(0, 0, 0, 0)));
+    c01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, _MM_SHUFFLE(1, 1, 1, 1)), c01);
+    c01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, _MM_SHUFFLE(2, 2, 2, 2)), c01);
+    c01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, _MM_SHUFFLE(3, 3, 3, 3)), c01);
+
+    __m256 c23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, _MM_SHUFFLE(0, 0, 0, 0)));
+    c23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, _MM_SHUFFLE(1, 1, 1, 1)), c23);
+    c23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, _MM_SHUFFLE(2, 2, 2, 2)), c23);
+    c23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, _MM_SHUFFLE(3, 3, 3, 3)), c23);
+
+    _mm256_storeu_ps(out, c01);
+    _mm256_storeu_ps(out + 8, c23);
+}
+
+#endif
+
+#if YAMA_SIMD_SSE
+
+// the widest available variant
+inline void matrix4x4_mul(float* out, const float* a, const float* b)
+{
+#if YAMA_SIMD_AVX
+    matrix4x4_mul_avx(out, a, b);
+#else
+    matrix4x4_mul_sse(out, a, b);
+#endif
+}
+
+namespace impl
+{
+// The inverse and determinant use the block-wise method:
+// the matrix is split into four 2x2 blocks A, B, C, D, each stored in a register
+// as (a00, a01, a10, a11). The 2x2 sub-determinants and the adjugate products of
+// the blocks are shared between the determinant and all 16 elements of the inverse,
+// which is then scaled by a single reciprocal of the determinant.
+//
+// The algorithms are written for both __m128 (one matrix) and __m256 (two matrices,
+// one per 128-bit lane). Every operation is lane-local.
+//
+// They treat the columns of the input as rows. This doesn't matter, since the inverse
+// of the transpose is the transpose of the inverse.
+
+inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+inline __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+inline __m128 div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+inline __m128 adj_sign(__m128) { return _mm_setr_ps(1, -1, -1, 1); }
+
+template <int X, int Y, int Z, int W>
+__m128 shuffle(__m128 a, __m128 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X)); }
+
+#if YAMA_SIMD_AVX
+inline __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+inline __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+inline __m256 div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+inline __m256 adj_sign(__m256) { return _mm256_setr_ps(1, -1, -1, 1, 1, -1, -1, 1); }
+
+template <int X, int Y, int Z, int W>
+__m256 shuffle(__m256 a, __m256 b) { return _mm256_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X)); }
+#endif
+
+template <int X, int Y, int Z, int W, typename V>
+V swizzle(V a) { return shuffle<X, Y, Z, W>(a, a); }
+
+// a * b
+template <typename V>
+V mat2_mul(V a, V b)
+{
+    return add(mul(a, swizzle<0, 3, 0, 3>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+// adjugate(a) * b
+template <typename V>
+V mat2_adj_mul(V a, V b)
+{
+    return sub(mul(swizzle<3, 3, 0, 0>(a), b), mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+}
+
+// a * adjugate(b)
+template <typename V>
+V mat2_mul_adj(V a, V b)
+{
+    return sub(mul(a, swizzle<3, 0, 3, 0>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+// the 2x2 blocks and the shared terms of the determinant and inverse
+template <typename V>
+struct matrix4x4_blocks
+{
+    matrix4x4_blocks(V c0, V c1, V c2, V c3)
+    {
+        a = shuffle<0, 1, 0, 1>(c0, c1);
+        b = shuffle<2, 3, 2, 3>(c0, c1);
+        c = shuffle<0, 1, 0, 1>(c2, c3);
+        d = shuffle<2, 3, 2, 3>(c2, c3);
+
+        // (|a|, |b|, |c|, |d|)
+        const V det_sub = sub(
+            mul(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+            mul(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3))
+        );
+        det_a = swizzle<0, 0, 0, 0>(det_sub);
+        det_b = swizzle<1, 1, 1, 1>(det_sub);
+        det_c = swizzle<2, 2, 2, 2>(det_sub);
+        det_d = swizzle<3, 3, 3, 3>(det_sub);
+
+        ab = mat2_adj_mul(a, b);
+        dc = mat2_adj_mul(d, c);
+
+        // |m| = |a|*|d| + |b|*|c| - trace(adj(a)*b * adj(d)*c)
+        V tr = mul(ab, swizzle<0, 2, 1, 3>(dc));
+        tr = add(tr, swizzle<1, 0, 3, 2>(tr));
+        tr = add(tr, swizzle<2, 3, 0, 1>(tr));
+        det = sub(add(mul(det_a, det_d), mul(det_b, det_c)), tr);
+    }
+
+    V a, b, c, d;
+    V det_a, det_b, det_c, det_d;
+    V ab, dc; // adj(a)*b, adj(d)*c
+    V det; // in all elements
+};
+
+// returns the determinant in all elements
+template <typename V>
+V matrix4x4_determinant(V c0, V c1, V c2, V c3)
+{
+    return matrix4x4_blocks<V>(c0, c1, c2, c3).det;
+}
+
+// writes the inverse to c0..c3 and returns the determinant in all elements
+template <typename V>
+V matrix4x4_inverse(V& c0, V& c1, V& c2, V& c3)
+{
+    const matrix4x4_blocks<V> m(c0, c1, c2, c3);
+
+    // the inverse is 1/|m| * | adj(x) adj(y) |
+    //                        | adj(z) adj(w) |
+    V x = sub(mul(m.det_d, m.a), mat2_mul(m.b, m.dc));
+    V y = sub(mul(m.det_b, m.c), mat2_mul_adj(m.d, m.ab));
+    V z = sub(mul(m.det_c, m.b), mat2_mul_adj(m.a, m.dc));
+    V w = sub(mul(m.det_a, m.d), mat2_mul(m.c, m.ab));
+
+    // the only division
+    const V rdet = div(adj_sign(m.det), m.det);
+    x = mul(x, rdet);
+    y = mul(y, rdet);
+    z = mul(z, rdet);
+    w = mul(w, rdet);
+
+    // the adjugates are applied by the shuffles
+    c0 = shuffle<3, 1, 3, 1>(x, y);
+    c1 = shuffle<2, 0, 2, 0>(x, y);
+    c2 = shuffle<3, 1, 3, 1>(z, w);
+    c3 = shuffle<2, 0, 2, 0>(z, w);
+
+    return m.det;
+}
+}
+
+inline float matrix4x4_determinant_sse(const float* m)
+{
+    return _mm_cvtss_f32(impl::matrix4x4_determinant(_mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12)));
+}
+
+// out = inverse(m)
+// returns the determinant of m
+// out may alias m
+inline float matrix4x4_inverse_sse(float* out, const float* m)
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+
+    const __m128 det = impl::matrix4x4_inverse(c0, c1, c2, c3);
+
+    _mm_storeu_ps(out, c0);
+    _mm_storeu_ps(out + 4, c1);
+    _mm_storeu_ps(out + 8, c2);
+    _mm_storeu_ps(out + 12, c3);
+
+    return _mm_cvtss_f32(det);
+}
+
+#endif
+
+#if YAMA_SIMD_AVX
+
+// inverts two consecutive matrices: out[0..32) = inverse of m[0..32)
+// out may alias m
+inline void matrix4x4_inverse2_avx(float* out, const float* m)
+{
+    auto load = [m](int i) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m + i)), _mm_loadu_ps(m + 16 + i), 1);
+    };
+    __m256 c0 = load(0);
+    __m256 c1 = load(4);
+    __m256 c2 = load(8);
+    __m256 c3 = load(12);
+
+    impl::matrix4x4_inverse(c0, c1, c2, c3);
+
+    auto store = [out](int i, __m256 c) {
+        _mm_storeu_ps(out + i, _mm256_castps256_ps128(c));
+        _mm_storeu_ps(out + 16 + i, _mm256_extractf128_ps(c, 1));
+    };
+    store(0, c0);
+    store(4, c1);
+    store(8, c2);
+    store(12, c3);
+}
+
+#endif
+
+#if YAMA_SIMD_SSE
+
+// inverts count consecutive matrices from m to out
+// out may be the same as m
+inline void matrix4x4_inverse(float* out, const float* m, size_t count)
+{
+    size_t i = 0;
+#if YAMA_SIMD_AVX
+    for (; i + 2 <= count; i += 2)
+    {
+        matrix4x4_inverse2_avx(out + 16 * i, m + 16 * i);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        matrix4x4_inverse_sse(out + 16 * i, m + 16 * i);
+    }
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,698 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "../simd.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+
+// Packs of floats which map to a SIMD register
+//
+// f32x4 is an SSE register and f32x8 is an AVX register when they're available.
+// Otherwise they are plain arrays with the same interface, so code written with them
+// works everywhere (and compilers vectorize the loops of the fallback reasonably).
+// f32xn is the widest pack with native support.
+// basic_pack<T, N> is the fallback. It also serves double, and pack_t<T> picks the
+// pack to use for T.
+//
+// Comparisons return masks: packs whose elements have all bits set or cleared.
+// They are meant to be used with select, the bitwise operators and the mask queries.
+//
+// All loads and stores are unaligned unless explicitly stated otherwise.
+
+namespace yama
+{
+namespace simd
+{
+
+// portable fallback
+// T is float or double
+template <typename T, size_t N>
+struct basic_pack
+{
+    T v[N];
+
+    using value_type = T;
+    static constexpr size_t width = N;
+
+    static basic_pack uniform(T s)
+    {
+        basic_pack ret;
+        for (auto& e : ret.v) e = s;
+        return ret;
+    }
+
+    static basic_pack zero()
+    {
+        return uniform(0);
+    }
+
+    // the mask with the elements for the set bits set (the inverse of mask_bits)
+    static basic_pack from_mask_bits(int bits)
+    {
+        basic_pack ret;
+        for (size_t i = 0; i < N; ++i) std::memset(ret.v + i, (bits >> i) & 1 ? 0xff : 0, sizeof(T));
+        return ret;
+    }
+
+    static basic_pack load(const T* ptr)
+    {
+        basic_pack ret;
+        std::memcpy(ret.v, ptr, sizeof(ret.v));
+        return ret;
+    }
+
+    static basic_pack load_aligned(const T* ptr)
+    {
+        return load(ptr);
+    }
+
+    void store(T* ptr) const
+    {
+        std::memcpy(ptr, v, sizeof(v));
+    }
+
+    void store_aligned(T* ptr) const
+    {
+        store(ptr);
+    }
+
+    T at(size_t i) const
+    {
+        return v[i];
+    }
+};
+
+namespace impl
+{
+template <typename T>
+using bits_t = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+template <typename T>
+bits_t<T> to_bits(T f) { bits_t<T> u; std::memcpy(&u, &f, sizeof(T)); return u; }
+
+template <typename T>
+T from_bits(bits_t<T> u) { T f; std::memcpy(&f, &u, sizeof(T)); return f; }
+
+template <typename T>
+T mask_of(bool b) { return from_bits<T>(b ? ~bits_t<T>(0) : 0); }
+
+template <typename T, size_t N, typename F>
+basic_pack<T, N> map(const basic_pack<T, N>& a, F f)
+{
+    basic_pack<T, N> ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = f(a.v[i]);
+    return ret;
+}
+
+template <typename T, size_t N, typename F>
+basic_pack<T, N> map(const basic_pack<T, N>& a, const basic_pack<T, N>& b, F f)
+{
+    basic_pack<T, N> ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = f(a.v[i], b.v[i]);
+    return ret;
+}
+}
+
+template <typename T, size_t N>
+basic_pack<T, N> operator+(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return x + y; }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator-(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return x - y; }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator*(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return x * y; }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator/(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return x / y; }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator-(const basic_pack<T, N>& a) { return impl::map(a, [](T x) { return -x; }); }
+
+template <typename T, size_t N>
+basic_pack<T, N> operator&(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::from_bits<T>(impl::to_bits(x) & impl::to_bits(y)); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator|(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::from_bits<T>(impl::to_bits(x) | impl::to_bits(y)); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator^(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::from_bits<T>(impl::to_bits(x) ^ impl::to_bits(y)); }); }
+// ~a & b
+template <typename T, size_t N>
+basic_pack<T, N> andnot(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::from_bits<T>(~impl::to_bits(x) & impl::to_bits(y)); }); }
+
+template <typename T, size_t N>
+basic_pack<T, N> operator<(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::mask_of<T>(x < y); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator<=(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::mask_of<T>(x <= y); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator>(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::mask_of<T>(x > y); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator>=(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::mask_of<T>(x >= y); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator==(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::mask_of<T>(x == y); }); }
+template <typename T, size_t N>
+basic_pack<T, N> operator!=(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return impl::mask_of<T>(x != y); }); }
+
+// a * b + c
+template <typename T, size_t N>
+basic_pack<T, N> fmadd(const basic_pack<T, N>& a, const basic_pack<T, N>& b, const basic_pack<T, N>& c) { return a * b + c; }
+// c - a * b
+template <typename T, size_t N>
+basic_pack<T, N> fnmadd(const basic_pack<T, N>& a, const basic_pack<T, N>& b, const basic_pack<T, N>& c) { return c - a * b; }
+
+// like the SSE instructions: if either element is NaN, the one from b is returned
+#if !defined(min)
+template <typename T, size_t N>
+basic_pack<T, N> min(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return x < y ? x : y; }); }
+#endif
+#if !defined(max)
+template <typename T, size_t N>
+basic_pack<T, N> max(const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return impl::map(a, b, [](T x, T y) { return x > y ? x : y; }); }
+#endif
+template <typename T, size_t N>
+basic_pack<T, N> abs(const basic_pack<T, N>& a) { return impl::map(a, [](T x) { return std::abs(x); }); }
+template <typename T, size_t N>
+basic_pack<T, N> sqrt(const basic_pack<T, N>& a) { return impl::map(a, [](T x) { return std::sqrt(x); }); }
+
+// mask ? a : b
+template <typename T, size_t N>
+basic_pack<T, N> select(const basic_pack<T, N>& mask, const basic_pack<T, N>& a, const basic_pack<T, N>& b) { return (mask & a) | andnot(mask, b); }
+
+// bit i is set if element i of the mask is set
+template <typename T, size_t N>
+int mask_bits(const basic_pack<T, N>& mask)
+{
+    int ret = 0;
+    for (size_t i = 0; i < N; ++i) ret |= int(impl::to_bits(mask.v[i]) >> (sizeof(T) * 8 - 1)) << i;
+    return ret;
+}
+
+template <typename T, size_t N>
+T hsum(const basic_pack<T, N>& a)
+{
+    T ret = a.v[0];
+    for (size_t i = 1; i < N; ++i) ret += a.v[i];
+    return ret;
+}
+
+template <typename T, size_t N>
+T hmin(const basic_pack<T, N>& a)
+{
+    T ret = a.v[0];
+    for (size_t i = 1; i < N; ++i) ret = a.v[i] < ret ? a.v[i] : ret;
+    return ret;
+}
+
+template <typename T, size_t N>
+T hmax(const basic_pack<T, N>& a)
+{
+    T ret = a.v[0];
+    for (size_t i = 1; i < N; ++i) ret = ret < a.v[i] ? a.v[i] : ret;
+    return ret;
+}
+
+// deinterleave width 3d vectors (x0, y0, z0, x1, y1, z1...)
+template <typename T, size_t N>
+void load3(const T* ptr, basic_pack<T, N>& x, basic_pack<T, N>& y, basic_pack<T, N>& z)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        x.v[i] = ptr[3 * i];
+        y.v[i] = ptr[3 * i + 1];
+        z.v[i] = ptr[3 * i + 2];
+    }
+}
+
+// interleave width 3d vectors
+template <typename T, size_t N>
+void store3(T* ptr, const basic_pack<T, N>& x, const basic_pack<T, N>& y, const basic_pack<T, N>& z)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        ptr[3 * i] = x.v[i];
+        ptr[3 * i + 1] = y.v[i];
+        ptr[3 * i + 2] = z.v[i];
+    }
+}
+
+// deinterleave width pairs of 3d vectors (a0, b0, a1, b1...), say the min and max of boxes
+template <typename T, size_t N>
+void load3_pairs(const T* ptr,
+    basic_pack<T, N>& ax, basic_pack<T, N>& ay, basic_pack<T, N>& az,
+    basic_pack<T, N>& bx, basic_pack<T, N>& by, basic_pack<T, N>& bz)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        ax.v[i] = ptr[6 * i];
+        ay.v[i] = ptr[6 * i + 1];
+        az.v[i] = ptr[6 * i + 2];
+        bx.v[i] = ptr[6 * i + 3];
+        by.v[i] = ptr[6 * i + 4];
+        bz.v[i] = ptr[6 * i + 5];
+    }
+}
+
+// deinterleave width 4d vectors
+template <typename T, size_t N>
+void load4(const T* ptr, basic_pack<T, N>& x, basic_pack<T, N>& y, basic_pack<T, N>& z, basic_pack<T, N>& w)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        x.v[i] = ptr[4 * i];
+        y.v[i] = ptr[4 * i + 1];
+        z.v[i] = ptr[4 * i + 2];
+        w.v[i] = ptr[4 * i + 3];
+    }
+}
+
+// interleave width 4d vectors
+template <typename T, size_t N>
+void store4(T* ptr, const basic_pack<T, N>& x, const basic_pack<T, N>& y, const basic_pack<T, N>& z, const basic_pack<T, N>& w)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        ptr[4 * i] = x.v[i];
+        ptr[4 * i + 1] = y.v[i];
+        ptr[4 * i + 2] = z.v[i];
+        ptr[4 * i + 3] = w.v[i];
+    }
+}
+
+template <size_t N>
+using basic_f32_pack = basic_pack<float, N>;
+
+#if YAMA_SIMD_SSE
+
+struct f32x4
+{
+    __m128 v;
+
+    using value_type = float;
+    static constexpr size_t width = 4;
+
+    static f32x4 uniform(float s) { return {_mm_set1_ps(s)}; }
+    static f32x4 zero() { return {_mm_setzero_ps()}; }
+    static f32x4 from_mask_bits(int bits)
+    {
+        const __m128i b = _mm_setr_epi32(1, 2, 4, 8);
+        return {_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(bits), b), b))};
+    }
+    static f32x4 load(const float* ptr) { return {_mm_loadu_ps(ptr)}; }
+    static f32x4 load_aligned(const float* ptr) { return {_mm_load_ps(ptr)}; }
+    void store(float* ptr) const { _mm_storeu_ps(ptr, v); }
+    void store_aligned(float* ptr) const { _mm_store_ps(ptr, v); }
+
+    float at(size_t i) const
+    {
+        alignas(16) float f[4];
+        store_aligned(f);
+        return f[i];
+    }
+};
+
+inline f32x4 operator+(f32x4 a, f32x4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline f32x4 operator-(f32x4 a, f32x4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline f32x4 operator*(f32x4 a, f32x4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline f32x4 operator/(f32x4 a, f32x4 b) { return {_mm_div_ps(a.v, b.v)}; }
+inline f32x4 operator-(f32x4 a) { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.f))}; }
+
+inline f32x4 operator&(f32x4 a, f32x4 b) { return {_mm_and_ps(a.v, b.v)}; }
+inline f32x4 operator|(f32x4 a, f32x4 b) { return {_mm_or_ps(a.v, b.v)}; }
+inline f32x4 operator^(f32x4 a, f32x4 b) { return {_mm_xor_ps(a.v, b.v)}; }
+inline f32x4 andnot(f32x4 a, f32x4 b) { return {_mm_andnot_ps(a.v, b.v)}; }
+
+inline f32x4 operator<(f32x4 a, f32x4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline f32x4 operator<=(f32x4 a, f32x4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline f32x4 operator>(f32x4 a, f32x4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline f32x4 operator>=(f32x4 a, f32x4 b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+inline f32x4 operator==(f32x4 a, f32x4 b) { return {_mm_cmpeq_ps(a.v, b.v)}; }
+inline f32x4 operator!=(f32x4 a, f32x4 b) { return {_mm_cmpneq_ps(a.v, b.v)}; }
+
+#if YAMA_SIMD_AVX
+inline f32x4 fmadd(f32x4 a, f32x4 b, f32x4 c) { return {_mm_fmadd_ps(a.v, b.v, c.v)}; }
+inline f32x4 fnmadd(f32x4 a, f32x4 b, f32x4 c) { return {_mm_fnmadd_ps(a.v, b.v, c.v)}; }
+#else
+inline f32x4 fmadd(f32x4 a, f32x4 b, f32x4 c) { return a * b + c; }
+inline f32x4 fnmadd(f32x4 a, f32x4 b, f32x4 c) { return c - a * b; }
+#endif
+
+#if !defined(min)
+inline f32x4 min(f32x4 a, f32x4 b) { return {_mm_min_ps(a.v, b.v)}; }
+#endif
+#if !defined(max)
+inline f32x4 max(f32x4 a, f32x4 b) { return {_mm_max_ps(a.v, b.v)}; }
+#endif
+inline f32x4 abs(f32x4 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)}; }
+inline f32x4 sqrt(f32x4 a) { return {_mm_sqrt_ps(a.v)}; }
+
+inline f32x4 select(f32x4 mask, f32x4 a, f32x4 b)
+{
+#if YAMA_SIMD_AVX
+    return {_mm_blendv_ps(b.v, a.v, mask.v)};
+#else
+    return (mask & a) | andnot(mask, b);
+#endif
+}
+
+inline int mask_bits(f32x4 mask) { return _mm_movemask_ps(mask.v); }
+
+inline float hsum(f32x4 a)
+{
+    __m128 s = _mm_add_ps(a.v, _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1)));
+    s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(s);
+}
+
+inline float hmin(f32x4 a)
+{
+    __m128 s = _mm_min_ps(a.v, _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1)));
+    s = _mm_min_ss(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(s);
+}
+
+inline float hmax(f32x4 a)
+{
+    __m128 s = _mm_max_ps(a.v, _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1)));
+    s = _mm_max_ss(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(s);
+}
+
+namespace impl
+{
+template <int Imm>
+__m128 shuf(__m128 a, __m128 b) { return _mm_shuffle_ps(a, b, Imm); }
+#if YAMA_SIMD_AVX
+template <int Imm>
+__m256 shuf(__m256 a, __m256 b) { return _mm256_shuffle_ps(a, b, Imm); }
+#endif
+
+// 4 3d vectors in 3 registers to x, y, z registers
+// the shuffles are lane-local, so with __m256 this works on two groups of 4
+template <typename V>
+void deinterleave3(V a, V b, V c, V& x, V& y, V& z)
+{
+    // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+    x = shuf<_MM_SHUFFLE(2, 0, 3, 0)>(a, shuf<_MM_SHUFFLE(1, 1, 2, 2)>(b, c));
+    y = shuf<_MM_SHUFFLE(2, 0, 2, 0)>(shuf<_MM_SHUFFLE(0, 0, 1, 1)>(a, b), shuf<_MM_SHUFFLE(2, 2, 3, 3)>(b, c));
+    z = shuf<_MM_SHUFFLE(3, 0, 2, 0)>(shuf<_MM_SHUFFLE(1, 1, 2, 2)>(a, b), c);
+}
+
+template <typename V>
+void interleave3(V x, V y, V z, V& a, V& b, V& c)
+{
+    a = shuf<_MM_SHUFFLE(2, 0, 2, 0)>(shuf<_MM_SHUFFLE(0, 0, 0, 0)>(x, y), shuf<_MM_SHUFFLE(1, 1, 0, 0)>(z, x));
+    b = shuf<_MM_SHUFFLE(2, 0, 2, 0)>(shuf<_MM_SHUFFLE(1, 1, 1, 1)>(y, z), shuf<_MM_SHUFFLE(2, 2, 2, 2)>(x, y));
+    c = shuf<_MM_SHUFFLE(2, 0, 2, 0)>(shuf<_MM_SHUFFLE(3, 3, 2, 2)>(z, x), shuf<_MM_SHUFFLE(3, 3, 3, 3)>(y, z));
+}
+
+template <typename V, typename Unpacklo, typename Unpackhi>
+void transpose4(V& r0, V& r1, V& r2, V& r3, Unpacklo lo, Unpackhi hi)
+{
+    V t0 = lo(r0, r1); // x0 x1 y0 y1
+    V t1 = lo(r2, r3); // x2 x3 y2 y3
+    V t2 = hi(r0, r1); // z0 z1 w0 w1
+    V t3 = hi(r2, r3); // z2 z3 w2 w3
+    r0 = shuf<_MM_SHUFFLE(1, 0, 1, 0)>(t0, t1);
+    r1 = shuf<_MM_SHUFFLE(3, 2, 3, 2)>(t0, t1);
+    r2 = shuf<_MM_SHUFFLE(1, 0, 1, 0)>(t2, t3);
+    r3 = shuf<_MM_SHUFFLE(3, 2, 3, 2)>(t2, t3);
+}
+
+inline void transpose4(__m128& r0, __m128& r1, __m128& r2, __m128& r3)
+{
+    transpose4(r0, r1, r2, r3,
+        [](__m128 a, __m128 b) { return _mm_unpacklo_ps(a, b); },
+        [](__m128 a, __m128 b) { return _mm_unpackhi_ps(a, b); });
+}
+}
+
+inline void load3(const float* ptr, f32x4& x, f32x4& y, f32x4& z)
+{
+    impl::deinterleave3(_mm_loadu_ps(ptr), _mm_loadu_ps(ptr + 4), _mm_loadu_ps(ptr + 8), x.v, y.v, z.v);
+}
+
+inline void store3(float* ptr, f32x4 x, f32x4 y, f32x4 z)
+{
+    __m128 a, b, c;
+    impl::interleave3(x.v, y.v, z.v, a, b, c);
+    _mm_storeu_ps(ptr, a);
+    _mm_storeu_ps(ptr + 4, b);
+    _mm_storeu_ps(ptr + 8, c);
+}
+
+inline void load3_pairs(const float* ptr, f32x4& ax, f32x4& ay, f32x4& az, f32x4& bx, f32x4& by, f32x4& bz)
+{
+    // the first two pairs and the last two pairs, then split the odd and even elements
+    __m128 lo[3], hi[3];
+    impl::deinterleave3(_mm_loadu_ps(ptr), _mm_loadu_ps(ptr + 4), _mm_loadu_ps(ptr + 8), lo[0], lo[1], lo[2]);
+    impl::deinterleave3(_mm_loadu_ps(ptr + 12), _mm_loadu_ps(ptr + 16), _mm_loadu_ps(ptr + 20), hi[0], hi[1], hi[2]);
+    ax.v = _mm_shuffle_ps(lo[0], hi[0], _MM_SHUFFLE(2, 0, 2, 0));
+    ay.v = _mm_shuffle_ps(lo[1], hi[1], _MM_SHUFFLE(2, 0, 2, 0));
+    az.v = _mm_shuffle_ps(lo[2], hi[2], _MM_SHUFFLE(2, 0, 2, 0));
+    bx.v = _mm_shuffle_ps(lo[0], hi[0], _MM_SHUFFLE(3, 1, 3, 1));
+    by.v = _mm_shuffle_ps(lo[1], hi[1], _MM_SHUFFLE(3, 1, 3, 1));
+    bz.v = _mm_shuffle_ps(lo[2], hi[2], _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void load4(const float* ptr, f32x4& x, f32x4& y, f32x4& z, f32x4& w)
+{
+    x.v = _mm_loadu_ps(ptr);
+    y.v = _mm_loadu_ps(ptr + 4);
+    z.v = _mm_loadu_ps(ptr + 8);
+    w.v = _mm_loadu_ps(ptr + 12);
+    impl::transpose4(x.v, y.v, z.v, w.v);
+}
+
+inline void store4(float* ptr, f32x4 x, f32x4 y, f32x4 z, f32x4 w)
+{
+    impl::transpose4(x.v, y.v, z.v, w.v);
+    _mm_storeu_ps(ptr, x.v);
+    _mm_storeu_ps(ptr + 4, y.v);
+    _mm_storeu_ps(ptr + 8, z.v);
+    _mm_storeu_ps(ptr + 12, w.v);
+}
+
+#else
+
+using f32x4 = basic_f32_pack<4>;
+
+#endif
+
+#if YAMA_SIMD_AVX
+
+struct f32x8
+{
+    __m256 v;
+
+    using value_type = float;
+    static constexpr size_t width = 8;
+
+    static f32x8 uniform(float s) { return {_mm256_set1_ps(s)}; }
+    static f32x8 zero() { return {_mm256_setzero_ps()}; }
+    static f32x8 from_mask_bits(int bits)
+    {
+        // two halves, since integer comparisons of 8 elements need AVX2
+        return {_mm256_insertf128_ps(_mm256_castps128_ps256(f32x4::from_mask_bits(bits).v), f32x4::from_mask_bits(bits >> 4).v, 1)};
+    }
+    static f32x8 load(const float* ptr) { return {_mm256_loadu_ps(ptr)}; }
+    static f32x8 load_aligned(const float* ptr) { return {_mm256_load_ps(ptr)}; }
+    void store(float* ptr) const { _mm256_storeu_ps(ptr, v); }
+    void store_aligned(float* ptr) const { _mm256_store_ps(ptr, v); }
+
+    float at(size_t i) const
+    {
+        alignas(32) float f[8];
+        store_aligned(f);
+        return f[i];
+    }
+};
+
+inline f32x8 operator+(f32x8 a, f32x8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline f32x8 operator-(f32x8 a, f32x8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline f32x8 operator*(f32x8 a, f32x8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline f32x8 operator/(f32x8 a, f32x8 b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline f32x8 operator-(f32x8 a) { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.f))}; }
+
+inline f32x8 operator&(f32x8 a, f32x8 b) { return {_mm256_and_ps(a.v, b.v)}; }
+inline f32x8 operator|(f32x8 a, f32x8 b) { return {_mm256_or_ps(a.v, b.v)}; }
+inline f32x8 operator^(f32x8 a, f32x8 b) { return {_mm256_xor_ps(a.v, b.v)}; }
+inline f32x8 andnot(f32x8 a, f32x8 b) { return {_mm256_andnot_ps(a.v, b.v)}; }
+
+inline f32x8 operator<(f32x8 a, f32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline f32x8 operator<=(f32x8 a, f32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+inline f32x8 operator>(f32x8 a, f32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline f32x8 operator>=(f32x8 a, f32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+inline f32x8 operator==(f32x8 a, f32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)}; }
+inline f32x8 operator!=(f32x8 a, f32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ)}; }
+
+inline f32x8 fmadd(f32x8 a, f32x8 b, f32x8 c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+inline f32x8 fnmadd(f32x8 a, f32x8 b, f32x8 c) { return {_mm256_fnmadd_ps(a.v, b.v, c.v)}; }
+
+#if !defined(min)
+inline f32x8 min(f32x8 a, f32x8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+#endif
+#if !defined(max)
+inline f32x8 max(f32x8 a, f32x8 b) { return {_mm256_max_ps(a.v, b.v)}; }
+#endif
+inline f32x8 abs(f32x8 a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v)}; }
+inline f32x8 sqrt(f32x8 a) { return {_mm256_sqrt_ps(a.v)}; }
+
+inline f32x8 select(f32x8 mask, f32x8 a, f32x8 b) { return {_mm256_blendv_ps(b.v, a.v, mask.v)}; }
+
+inline int mask_bits(f32x8 mask) { return _mm256_movemask_ps(mask.v); }
+
+inline float hsum(f32x8 a) { return hsum(f32x4{_mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1))}); }
+inline float hmin(f32x8 a) { return hmin(f32x4{_mm_min_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1))}); }
+inline float hmax(f32x8 a) { return hmax(f32x4{_mm_max_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1))}); }
+
+namespace impl
+{
+// vectors 0-3 in the low lane, 4-7 in the high lane
+inline __m256 load_lanes(const float* lo, const float* hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+inline void store_lanes(float* lo, float* hi, __m256 v)
+{
+    _mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+    _mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+}
+
+inline void transpose4(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+{
+    transpose4(r0, r1, r2, r3,
+        [](__m256 a, __m256 b) { return _mm256_unpacklo_ps(a, b); },
+        [](__m256 a, __m256 b) { return _mm256_unpackhi_ps(a, b); });
+}
+}
+
+inline void load3(const float* ptr, f32x8& x, f32x8& y, f32x8& z)
+{
+    impl::deinterleave3(impl::load_lanes(ptr, ptr + 12), impl::load_lanes(ptr + 4, ptr + 16), impl::load_lanes(ptr + 8, ptr + 20), x.v, y.v, z.v);
+}
+
+inline void store3(float* ptr, f32x8 x, f32x8 y, f32x8 z)
+{
+    __m256 a, b, c;
+    impl::interleave3(x.v, y.v, z.v, a, b, c);
+    impl::store_lanes(ptr, ptr + 12, a);
+    impl::store_lanes(ptr + 4, ptr + 16, b);
+    impl::store_lanes(ptr + 8, ptr + 20, c);
+}
+
+inline void load3_pairs(const float* ptr, f32x8& ax, f32x8& ay, f32x8& az, f32x8& bx, f32x8& by, f32x8& bz)
+{
+    // as with f32x4, the 128-bit lanes get pairs 0-3 and 4-7
+    __m256 lo[3], hi[3];
+    impl::deinterleave3(impl::load_lanes(ptr, ptr + 24), impl::load_lanes(ptr + 4, ptr + 28), impl::load_lanes(ptr + 8, ptr + 32), lo[0], lo[1], lo[2]);
+    impl::deinterleave3(impl::load_lanes(ptr + 12, ptr + 36), impl::load_lanes(ptr + 16, ptr + 40), impl::load_lanes(ptr + 20, ptr + 44), hi[0], hi[1], hi[2]);
+    ax.v = _mm256_shuffle_ps(lo[0], hi[0], _MM_SHUFFLE(2, 0, 2, 0));
+    ay.v = _mm256_shuffle_ps(lo[1], hi[1], _MM_SHUFFLE(2, 0, 2, 0));
+    az.v = _mm256_shuffle_ps(lo[2], hi[2], _MM_SHUFFLE(2, 0, 2, 0));
+    bx.v = _mm256_shuffle_ps(lo[0], hi[0], _MM_SHUFFLE(3, 1, 3, 1));
+    by.v = _mm256_shuffle_ps(lo[1], hi[1], _MM_SHUFFLE(3, 1, 3, 1));
+    bz.v = _mm256_shuffle_ps(lo[2], hi[2], _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void load4(const float* ptr, f32x8& x, f32x8& y, f32x8& z, f32x8& w)
+{
+    x.v = impl::load_lanes(ptr, ptr + 16);
+    y.v = impl::load_lanes(ptr + 4, ptr + 20);
+    z.v = impl::load_lanes(ptr + 8, ptr + 24);
+    w.v = impl::load_lanes(ptr + 12, ptr + 28);
+    impl::transpose4(x.v, y.v, z.v, w.v);
+}
+
+inline void store4(float* ptr, f32x8 x, f32x8 y, f32x8 z, f32x8 w)
+{
+    impl::transpose4(x.v, y.v, z.v, w.v);
+    impl::store_lanes(ptr, ptr + 16, x.v);
+    impl::store_lanes(ptr + 4, ptr + 20, y.v);
+    impl::store_lanes(ptr + 8, ptr + 24, z.v);
+    impl::store_lanes(ptr + 12, ptr + 28, w.v);
+}
+
+using f32xn = f32x8;
+
+#else
+
+using f32x8 = basic_f32_pack<8>;
+using f32xn = f32x4;
+
+#endif
+
+// the widest pack for T
+// types other than float fall back to arrays
+template <typename T>
+struct native_pack
+{
+    using type = basic_pack<T, 32 / sizeof(T)>;
+};
+
+template <>
+struct native_pack<float>
+{
+    using type = f32xn;
+};
+
+template <typename T>
+using pack_t = typename native_pack<T>::type;
+
+// the pack of N elements of type T
+template <typename T, size_t N>
+struct sized_pack
+{
+    using type = basic_pack<T, N>;
+};
+
+template <>
+struct sized_pack<float, 4>
+{
+    using type = f32x4;
+};
+
+template <>
+struct sized_pack<float, 8>
+{
+    using type = f32x8;
+};
+
+template <typename T, size_t N>
+using pack_n_t = typename sized_pack<T, N>::type;
+
+template <typename P>
+struct is_pack : std::false_type {};
+
+template <typename T, size_t N>
+struct is_pack<basic_pack<T, N>> : std::true_type {};
+
+#if YAMA_SIMD_SSE
+template <>
+struct is_pack<f32x4> : std::true_type {};
+#endif
+
+#if YAMA_SIMD_AVX
+template <>
+struct is_pack<f32x8> : std::true_type {};
+#endif
+
+// arithmetic with scalars, which are broadcast to all elements
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator+(const P& a, typename P::value_type s) { return a + P::uniform(s); }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator+(typename P::value_type s, const P& a) { return P::uniform(s) + a; }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator-(const P& a, typename P::value_type s) { return a - P::uniform(s); }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator-(typename P::value_type s, const P& a) { return P::uniform(s) - a; }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator*(const P& a, typename P::value_type s) { return a * P::uniform(s); }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator*(typename P::value_type s, const P& a) { return P::uniform(s) * a; }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator/(const P& a, typename P::value_type s) { return a / P::uniform(s); }
+template <typename P, typename = std::enable_if_t<is_pack<P>::value>>
+P operator/(typename P::value_type s, const P& a) { return P::uniform(s) / a; }
+
+}
+}
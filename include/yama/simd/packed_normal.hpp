@@ -0,0 +1,184 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Batch kernels for the octahedral encoding of unit vectors
+//
+// A unit vector is projected on the octahedron |x| + |y| + |z| = 1, and the lower half of the
+// octahedron is folded over the upper one, so that it becomes the square [-1, 1]^2. The two
+// coordinates in the square are stored as signed normalized integers of Bits / 2 bits:
+// round(c * (2^(Bits / 2 - 1) - 1)).
+// The precise encoding tries the codes around the projected point and picks the one which
+// decodes closest to the vector (Cigolle et al. 2014).
+//
+// The vectors are arrays of 3d vectors (the layout of vector3_t) and the codes are pairs of
+// int8_t (16 bits) or int16_t (32 bits).
+
+namespace yama
+{
+namespace simd
+{
+
+namespace impl
+{
+template <int Bits>
+struct octahedral
+{
+    static_assert(Bits == 16 || Bits == 32, "octahedral normals are 16 or 32 bits");
+    using component_type = std::conditional_t<Bits == 16, int8_t, int16_t>;
+    static constexpr int component_max = (1 << (Bits / 2 - 1)) - 1;
+};
+
+// the magnitude of mag with the sign of sgn
+template <typename P>
+P copy_sign(const P& mag, const P& sgn)
+{
+    return abs(mag) | (sgn & P::uniform(typename P::value_type(-0.0)));
+}
+
+// the octahedral coordinates (in [-1, 1]) of a vector
+template <typename P>
+void octahedral_project(P x, P y, P z, P& u, P& v)
+{
+    const P s = P::uniform(1) / (abs(x) + abs(y) + abs(z));
+    x = x * s;
+    y = y * s;
+    const P lower = z < P::zero();
+    u = select(lower, copy_sign(P::uniform(1) - abs(y), x), x);
+    v = select(lower, copy_sign(P::uniform(1) - abs(x), y), y);
+}
+
+// the (not normalized) vector of octahedral coordinates
+template <typename P>
+void octahedral_unfold(P u, P v, P& x, P& y, P& z)
+{
+    z = P::uniform(1) - abs(u) - abs(v);
+    const P t = max(-z, P::zero());
+    x = u - copy_sign(t, u);
+    y = v - copy_sign(t, v);
+}
+}
+
+// out gets 2 components per vector
+template <int Bits, bool Precise, typename T, typename P = pack_t<T>>
+void pack_octahedral(const T* in, size_t count, typename impl::octahedral<Bits>::component_type* out)
+{
+    constexpr size_t W = P::width;
+    const P m = P::uniform(T(impl::octahedral<Bits>::component_max));
+    const P inv_m = P::uniform(T(1) / T(impl::octahedral<Bits>::component_max));
+    // adding and subtracting this rounds to an integer (to even, as nearbyint)
+    // the sums are in [2^23, 2^24) for float, where the step is 1, for negative values too
+    const P round = P::uniform(T(1.5) / std::numeric_limits<T>::epsilon());
+
+    auto group = [&](const T* pv, typename impl::octahedral<Bits>::component_type* po, size_t n) {
+        P x, y, z;
+        load3(pv, x, y, z);
+
+        P u, v;
+        impl::octahedral_project(x, y, z, u, v);
+        // the order of max keeps the zero vectors at -m instead of NaN
+        u = min(max(u * m, -m), m);
+        v = min(max(v * m, -m), m);
+
+        P cu = (u + round) - round;
+        P cv = (v + round) - round;
+
+        if (Precise)
+        {
+            // the other candidates are a step towards the projected point on each axis
+            const P one = P::uniform(1);
+            const P du = select(u > cu, one, -one), dv = select(v > cv, one, -one);
+
+            auto error = [&](const P& a, const P& b) {
+                P ex, ey, ez;
+                impl::octahedral_unfold(a * inv_m, b * inv_m, ex, ey, ez);
+                // the cosine of the angle is the dot product divided by the length
+                const P dot = fmadd(x, ex, fmadd(y, ey, z * ez));
+                return -dot / sqrt(fmadd(ex, ex, fmadd(ey, ey, ez * ez)));
+            };
+
+            const P bu = cu, bv = cv;
+            P best = error(cu, cv);
+            auto candidate = [&](P a, P b) {
+                a = min(max(a, -m), m);
+                b = min(max(b, -m), m);
+                const P e = error(a, b);
+                const P better = e < best;
+                cu = select(better, a, cu);
+                cv = select(better, b, cv);
+                best = min(best, e);
+            };
+            candidate(bu + du, bv);
+            candidate(bu, bv + dv);
+            candidate(bu + du, bv + dv);
+        }
+
+        T bu[W], bv[W];
+        cu.store(bu);
+        cv.store(bv);
+        for (size_t j = 0; j < n; ++j)
+        {
+            po[2 * j] = typename impl::octahedral<Bits>::component_type(bu[j]);
+            po[2 * j + 1] = typename impl::octahedral<Bits>::component_type(bv[j]);
+        }
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(in + 3 * i, out + 2 * i, W);
+    }
+
+    if (i == count) return;
+
+    // tail: go through a zero-padded buffer
+    T bv[3 * W] = {};
+    std::memcpy(bv, in + 3 * i, 3 * (count - i) * sizeof(T));
+    group(bv, out + 2 * i, count - i);
+}
+
+// in has 2 components per vector, out gets normalized vectors
+template <int Bits, typename T, typename P = pack_t<T>>
+void unpack_octahedral(const typename impl::octahedral<Bits>::component_type* in, size_t count, T* out)
+{
+    constexpr size_t W = P::width;
+    const P inv_m = P::uniform(T(1) / T(impl::octahedral<Bits>::component_max));
+
+    auto group = [&](const typename impl::octahedral<Bits>::component_type* pi, T* po, size_t n) {
+        T bu[W] = {}, bv[W] = {};
+        for (size_t j = 0; j < n; ++j)
+        {
+            bu[j] = T(pi[2 * j]);
+            bv[j] = T(pi[2 * j + 1]);
+        }
+
+        P x, y, z;
+        impl::octahedral_unfold(P::load(bu) * inv_m, P::load(bv) * inv_m, x, y, z);
+        const P r = P::uniform(1) / sqrt(fmadd(x, x, fmadd(y, y, z * z)));
+        store3(po, x * r, y * r, z * r);
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(in + 2 * i, out + 3 * i, W);
+    }
+
+    if (i == count) return;
+
+    // tail: go through a buffer
+    T bv[3 * W];
+    group(in + 2 * i, bv, count - i);
+    std::memcpy(out + 3 * i, bv, 3 * (count - i) * sizeof(T));
+}
+
+}
+}
@@ -0,0 +1,193 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Batch kernels for the smallest three encoding of unit quaternions
+//
+// The largest component (by absolute value) of a unit quaternion is at least 1/2, and the
+// other three are in [-1/sqrt(2), 1/sqrt(2)]. So they are stored with a fixed number of bits
+// each, along with the index of the largest one, and the largest one is restored from the
+// unit length. q and -q are the same rotation, so the sign is flipped to make the largest
+// one positive.
+//
+// A packed quaternion of Bits (32 or 48) is Bits / 16 16-bit words of the value
+// index << 3 * B | a << 2 * B | b << B | c, with B = (Bits - 2) / 3 bits per component and
+// the first word the lowest.
+// The components are rounded to the nearest step.
+
+namespace yama
+{
+namespace simd
+{
+
+namespace impl
+{
+template <typename T>
+constexpr T inv_sqrt2 = T(0.70710678118654752440084436210485);
+
+template <int Bits>
+struct smallest_three
+{
+    static_assert(Bits == 32 || Bits == 48, "smallest three quaternions are 32 or 48 bits");
+    static constexpr int words = Bits / 16;
+    static constexpr int component_bits = (Bits - 2) / 3;
+    static constexpr uint64_t component_mask = (uint64_t(1) << component_bits) - 1;
+
+    static uint64_t read(const uint16_t* w)
+    {
+        uint64_t ret = 0;
+        for (int k = 0; k < words; ++k) ret |= uint64_t(w[k]) << 16 * k;
+        return ret;
+    }
+
+    static void write(uint64_t v, uint16_t* w)
+    {
+        for (int k = 0; k < words; ++k) w[k] = uint16_t(v >> 16 * k);
+    }
+
+    static uint64_t join(uint64_t index, uint64_t a, uint64_t b, uint64_t c)
+    {
+        return index << 3 * component_bits | a << 2 * component_bits | b << component_bits | c;
+    }
+
+    // [-1/sqrt(2), 1/sqrt(2)] to [0, component_mask]: (a + 1/sqrt(2)) * encode_scale
+    template <typename T>
+    static constexpr T encode_scale = T(component_mask) * inv_sqrt2<T>;
+
+    // and back: c * decode_scale - 1/sqrt(2)
+    template <typename T>
+    static constexpr T decode_scale = 2 * inv_sqrt2<T> / T(component_mask);
+};
+}
+
+// out gets Bits / 16 words per quaternion
+template <int Bits, typename T, typename P = pack_t<T>>
+void pack_smallest_three(const T* q, size_t count, uint16_t* out)
+{
+    using st = impl::smallest_three<Bits>;
+    constexpr size_t W = P::width;
+
+    const P h = P::uniform(impl::inv_sqrt2<T>);
+    const P scale = P::uniform(st::template encode_scale<T>);
+    const P top = P::uniform(T(st::component_mask));
+    // adding and subtracting this rounds to an integer (to even, as nearbyint)
+    const P round = P::uniform(T(1) / std::numeric_limits<T>::epsilon());
+    const P sign_bit = P::uniform(T(-0.0));
+    P indices[4];
+    for (int k = 0; k < 4; ++k) indices[k] = P::uniform(T(k));
+
+    auto group = [&](const T* pq, uint16_t* po, size_t n) {
+        P x, y, z, w;
+        load4(pq, x, y, z, w);
+
+        // the first largest
+        P index = indices[0], largest = x, best = abs(x);
+        auto pick = [&](const P& v, int k) {
+            const P gt = abs(v) > best;
+            index = select(gt, indices[k], index);
+            largest = select(gt, v, largest);
+            best = max(best, abs(v));
+        };
+        pick(y, 1);
+        pick(z, 2);
+        pick(w, 3);
+
+        const P sign = largest & sign_bit;
+        x = x ^ sign;
+        y = y ^ sign;
+        z = z ^ sign;
+        w = w ^ sign;
+
+        P abc[3] = {
+            select(index == indices[0], y, x),
+            select(index <= indices[1], z, y),
+            select(index == indices[3], z, w),
+        };
+        for (auto& e : abc)
+        {
+            e = min(max((e + h) * scale, P::zero()), top);
+            e = (e + round) - round;
+        }
+
+        T bi[W], b[3][W];
+        index.store(bi);
+        for (int k = 0; k < 3; ++k) abc[k].store(b[k]);
+        for (size_t j = 0; j < n; ++j)
+        {
+            st::write(st::join(uint64_t(bi[j]), uint64_t(b[0][j]), uint64_t(b[1][j]), uint64_t(b[2][j])), po + st::words * j);
+        }
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(q + 4 * i, out + st::words * i, W);
+    }
+
+    if (i == count) return;
+
+    // tail: go through a zero-padded buffer
+    T bq[4 * W] = {};
+    std::memcpy(bq, q + 4 * i, 4 * (count - i) * sizeof(T));
+    group(bq, out + st::words * i, count - i);
+}
+
+// in has Bits / 16 words per quaternion
+template <int Bits, typename T, typename P = pack_t<T>>
+void unpack_smallest_three(const uint16_t* in, size_t count, T* out)
+{
+    using st = impl::smallest_three<Bits>;
+    constexpr size_t W = P::width;
+
+    const P h = P::uniform(impl::inv_sqrt2<T>);
+    const P scale = P::uniform(st::template decode_scale<T>);
+    const P one = P::uniform(1);
+    P indices[4];
+    for (int k = 0; k < 4; ++k) indices[k] = P::uniform(T(k));
+
+    auto group = [&](const uint16_t* pi, T* pq, size_t n) {
+        T bi[W] = {}, b[3][W] = {};
+        for (size_t j = 0; j < n; ++j)
+        {
+            const uint64_t v = st::read(pi + st::words * j);
+            bi[j] = T(v >> 3 * st::component_bits);
+            for (int k = 0; k < 3; ++k) b[k][j] = T((v >> (2 - k) * st::component_bits) & st::component_mask);
+        }
+
+        const P index = P::load(bi);
+        P abc[3];
+        for (int k = 0; k < 3; ++k) abc[k] = P::load(b[k]) * scale - h;
+
+        const P sum = fmadd(abc[0], abc[0], fmadd(abc[1], abc[1], abc[2] * abc[2]));
+        const P largest = sqrt(max(one - sum, P::zero()));
+
+        const P x = select(index == indices[0], largest, abc[0]);
+        const P y = select(index == indices[0], abc[0], select(index == indices[1], largest, abc[1]));
+        const P z = select(index == indices[3], abc[2], select(index == indices[2], largest, abc[1]));
+        const P w = select(index == indices[3], largest, abc[2]);
+        store4(pq, x, y, z, w);
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(in + st::words * i, out + 4 * i, W);
+    }
+
+    if (i == count) return;
+
+    // tail: go through a buffer
+    T bq[4 * W];
+    group(in + st::words * i, bq, count - i);
+    std::memcpy(out + 4 * i, bq, 4 * (count - i) * sizeof(T));
+}
+
+}
+}
@@ -0,0 +1,138 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Batch kernels for the quantization of 3d points relative to a box
+//
+// Each coordinate c is stored as the unsigned integer of Bits bits
+// round((c - min) * (2^Bits - 1) / size), clamped to [0, 2^Bits - 1], where min and size are
+// those of the box along the axis, and restored as min + q * size / (2^Bits - 1).
+// Coordinates on axes where the box has zero size are stored as 0 and restored as min.
+//
+// The points are arrays of 3d vectors (the layout of vector3_t) and the integers are 3 per point.
+
+namespace yama
+{
+namespace simd
+{
+
+// the smallest unsigned integer type of Bits bits
+template <int Bits>
+using quantized_t = std::conditional_t<Bits <= 8, uint8_t, std::conditional_t<Bits <= 16, uint16_t, uint32_t>>;
+
+namespace impl
+{
+template <int Bits, typename T>
+constexpr T quantized_max()
+{
+    static_assert(Bits > 0 && Bits <= 32, "quantization to 1 to 32 bits");
+    // the rounding in quantize3 adds 1.5 * 2^(digits - 1), so the values must be below 2^(digits - 2) to stay exact
+    static_assert(Bits <= std::numeric_limits<T>::digits - 2, "T can't round the quantized values exactly");
+    return T((uint64_t(1) << Bits) - 1);
+}
+}
+
+// the box is given by its min and size (3 values each)
+// max_error gets the largest difference between the points and their dequantized ones along each axis
+template <int Bits, typename T, typename P = pack_t<T>>
+void quantize3(const T* bmin, const T* bsize, const T* in, size_t count, quantized_t<Bits>* out, T* max_error)
+{
+    using Q = quantized_t<Bits>;
+    constexpr size_t W = P::width;
+    const T qmax = impl::quantized_max<Bits, T>();
+
+    P lo[3], scale[3], step[3], err[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        lo[k] = P::uniform(bmin[k]);
+        scale[k] = P::uniform(bsize[k] > 0 ? qmax / bsize[k] : T(0));
+        step[k] = P::uniform(bsize[k] / qmax);
+        err[k] = P::zero();
+    }
+    const P top = P::uniform(qmax);
+    // adding and subtracting this rounds to an integer (to even, as nearbyint)
+    const P round = P::uniform(T(1.5) / std::numeric_limits<T>::epsilon());
+
+    auto group = [&](const T* pp, Q* po, size_t n) {
+        P c[3];
+        load3(pp, c[0], c[1], c[2]);
+        for (int k = 0; k < 3; ++k)
+        {
+            P q = min(max((c[k] - lo[k]) * scale[k], P::zero()), top);
+            q = (q + round) - round;
+            err[k] = max(err[k], abs(fmadd(q, step[k], lo[k]) - c[k]));
+            c[k] = q;
+        }
+
+        T buf[3 * P::width];
+        store3(buf, c[0], c[1], c[2]);
+        for (size_t j = 0; j < 3 * n; ++j) po[j] = Q(buf[j]);
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(in + 3 * i, out + 3 * i, W);
+    }
+
+    if (i < count)
+    {
+        // tail: the padding is the min of the box, which has no error
+        T buf[3 * W];
+        for (size_t j = 0; j < W; ++j) std::memcpy(buf + 3 * j, bmin, 3 * sizeof(T));
+        std::memcpy(buf, in + 3 * i, 3 * (count - i) * sizeof(T));
+        group(buf, out + 3 * i, count - i);
+    }
+
+    for (int k = 0; k < 3; ++k) max_error[k] = hmax(err[k]);
+}
+
+// the box is given by its min and size (3 values each)
+template <int Bits, typename T, typename P = pack_t<T>>
+void dequantize3(const T* bmin, const T* bsize, const quantized_t<Bits>* in, size_t count, T* out)
+{
+    using Q = quantized_t<Bits>;
+    constexpr size_t W = P::width;
+    const T qmax = impl::quantized_max<Bits, T>();
+
+    P lo[3], step[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        lo[k] = P::uniform(bmin[k]);
+        step[k] = P::uniform(bsize[k] / qmax);
+    }
+
+    auto group = [&](const Q* pi, T* po, size_t n) {
+        T buf[3 * P::width] = {};
+        for (size_t j = 0; j < 3 * n; ++j) buf[j] = T(pi[j]);
+
+        P c[3];
+        load3(buf, c[0], c[1], c[2]);
+        for (int k = 0; k < 3; ++k) c[k] = fmadd(c[k], step[k], lo[k]);
+        store3(po, c[0], c[1], c[2]);
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(in + 3 * i, out + 3 * i, W);
+    }
+
+    if (i == count) return;
+
+    // tail: go through a buffer
+    T buf[3 * W];
+    group(in + 3 * i, buf, count - i);
+    std::memcpy(out + 3 * i, buf, 3 * (count - i) * sizeof(T));
+}
+
+}
+}
@@ -0,0 +1,357 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+#include "transform.hpp"
+
+#include <cmath>
+#include <limits>
+
+// Batch kernels for unit quaternions
+// They work on arrays of quaternions (x, y, z, w) and 3d vectors (x, y, z),
+// the layouts of quaternion_t and vector3_t
+// out may be the same as one of the inputs of the same layout
+//
+// slerp uses polynomial approximations of acos and sin instead of the standard library for float.
+// The absolute error of the results is below 1e-6. They are too coarse for double, which goes
+// through std::acos and std::sin lane by lane.
+
+namespace yama
+{
+namespace simd
+{
+
+// above this cosine of the angle slerp falls back to nlerp (the same as the scalar slerp)
+template <typename T>
+constexpr T slerp_nlerp_threshold = T(0.9995);
+
+namespace impl
+{
+// acos of x in [0, 1]
+// Abramowitz and Stegun 4.4.46: |error| <= 2e-8
+template <typename P>
+P acos_unit(P x)
+{
+    using T = typename P::value_type;
+    P p = P::uniform(T(-0.0012624911));
+    p = fmadd(p, x, P::uniform(T(0.0066700901)));
+    p = fmadd(p, x, P::uniform(T(-0.0170881256)));
+    p = fmadd(p, x, P::uniform(T(0.0308918810)));
+    p = fmadd(p, x, P::uniform(T(-0.0501743046)));
+    p = fmadd(p, x, P::uniform(T(0.0889789874)));
+    p = fmadd(p, x, P::uniform(T(-0.2145988016)));
+    p = fmadd(p, x, P::uniform(T(1.5707963050)));
+    return p * sqrt(max(P::uniform(T(1)) - x, P::zero()));
+}
+
+// sin of x in [0, pi/2]
+// odd Taylor polynomial up to x^11: |error| < 6e-8
+template <typename P>
+P sin_half_pi(P x)
+{
+    using T = typename P::value_type;
+    const P x2 = x * x;
+    P p = P::uniform(T(-1.0 / 39916800));
+    p = fmadd(p, x2, P::uniform(T(1.0 / 362880)));
+    p = fmadd(p, x2, P::uniform(T(-1.0 / 5040)));
+    p = fmadd(p, x2, P::uniform(T(1.0 / 120)));
+    p = fmadd(p, x2, P::uniform(T(-1.0 / 6)));
+    p = fmadd(p, x2, P::uniform(T(1)));
+    return p * x;
+}
+
+template <typename P>
+struct quat_pack
+{
+    P q[4];
+
+    P dot(const quat_pack& b) const
+    {
+        return fmadd(q[0], b.q[0], fmadd(q[1], b.q[1], fmadd(q[2], b.q[2], q[3] * b.q[3])));
+    }
+};
+
+// normalized lerp
+// b must already be on the shorter arc
+template <typename P>
+quat_pack<P> nlerp(const quat_pack<P>& a, const quat_pack<P>& b, P t)
+{
+    quat_pack<P> ret;
+    for (int i = 0; i < 4; ++i) ret.q[i] = fmadd(t, b.q[i] - a.q[i], a.q[i]);
+    const P rl = P::uniform(1) / sqrt(ret.dot(ret));
+    for (auto& e : ret.q) e = e * rl;
+    return ret;
+}
+
+// the rows of the rotation matrix of a unit quaternion
+// V is either a scalar or a pack
+template <typename V>
+void quaternion_rotation_rows(const V& x, const V& y, const V& z, const V& w, V r[3][3])
+{
+    const V x2 = x * x, y2 = y * y, z2 = z * z, w2 = w * w;
+    const V x_ = x + x, y_ = y + y, z_ = z + z;
+    const V xy = x_ * y, xz = x_ * z, xw = x_ * w;
+    const V yz = y_ * z, yw = y_ * w, zw = z_ * w;
+
+    r[0][0] = w2 + x2 - y2 - z2; r[0][1] = xy - zw;           r[0][2] = xz + yw;
+    r[1][0] = xy + zw;           r[1][1] = w2 - x2 + y2 - z2; r[1][2] = yz - xw;
+    r[2][0] = xz - yw;           r[2][1] = yz + xw;           r[2][2] = w2 - x2 - y2 + z2;
+}
+
+// applies f to each lane of x
+template <typename P, typename F>
+P per_lane(P x, F f)
+{
+    typename P::value_type buf[P::width];
+    x.store(buf);
+    for (auto& e : buf) e = f(e);
+    return P::load(buf);
+}
+
+// the polynomials are only accurate enough for float
+template <typename P>
+P slerp_acos(P x)
+{
+    using T = typename P::value_type;
+    if constexpr (std::numeric_limits<T>::digits <= std::numeric_limits<float>::digits) return acos_unit(x);
+    else return per_lane(x, [](T v) { return std::acos(v); });
+}
+
+template <typename P>
+P slerp_sin(P x)
+{
+    using T = typename P::value_type;
+    if constexpr (std::numeric_limits<T>::digits <= std::numeric_limits<float>::digits) return sin_half_pi(x);
+    else return per_lane(x, [](T v) { return std::sin(v); });
+}
+
+template <bool Spherical, typename T, typename P>
+void quaternion_interpolate(const T* from, const T* to, size_t count, const T* ratios, T ratio, T* out)
+{
+    constexpr size_t W = P::width;
+
+    auto group = [&](const T* pa, const T* pb, P t, T* po) {
+        quat_pack<P> a, b;
+        load4(pa, a.q[0], a.q[1], a.q[2], a.q[3]);
+        load4(pb, b.q[0], b.q[1], b.q[2], b.q[3]);
+
+        // q and -q are the same rotation: flip b to the shorter arc
+        P d = a.dot(b);
+        const P sign = d & P::uniform(T(-0.0));
+        for (auto& e : b.q) e = e ^ sign;
+        d = abs(d);
+
+        auto r = nlerp(a, b, t);
+
+        if (Spherical)
+        {
+            const P one = P::uniform(1);
+            const P angle = slerp_acos(min(d, one));
+            const P rsin = one / sqrt(max(fnmadd(d, d, one), P::zero()));
+            const P s0 = slerp_sin((one - t) * angle) * rsin;
+            const P s1 = slerp_sin(t * angle) * rsin;
+
+            // near identity sin(angle) is too small to divide by and nlerp is just as good
+            const P small_angle = d > P::uniform(slerp_nlerp_threshold<T>);
+            for (int i = 0; i < 4; ++i)
+            {
+                r.q[i] = select(small_angle, r.q[i], fmadd(s0, a.q[i], s1 * b.q[i]));
+            }
+        }
+
+        store4(po, r.q[0], r.q[1], r.q[2], r.q[3]);
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(from + 4 * i, to + 4 * i, ratios ? P::load(ratios + i) : P::uniform(ratio), out + 4 * i);
+    }
+
+    if (i == count) return;
+
+    // tail: go through buffers of whole packs
+    // the padding is identity quaternions to keep it finite
+    const size_t rest = count - i;
+    T ba[4 * W], bb[4 * W], bt[W];
+    for (size_t j = 0; j < W; ++j)
+    {
+        ba[4 * j] = ba[4 * j + 1] = ba[4 * j + 2] = 0;
+        ba[4 * j + 3] = 1;
+        bt[j] = ratio;
+    }
+    std::memcpy(bb, ba, sizeof(ba));
+    std::memcpy(ba, from + 4 * i, 4 * rest * sizeof(T));
+    std::memcpy(bb, to + 4 * i, 4 * rest * sizeof(T));
+    if (ratios) std::memcpy(bt, ratios + i, rest * sizeof(T));
+    group(ba, bb, P::load(bt), ba);
+    std::memcpy(out + 4 * i, ba, 4 * rest * sizeof(T));
+}
+}
+
+// out[i] = slerp(from[i], to[i], ratio)
+template <typename T, typename P = pack_t<T>>
+void quaternion_slerp(const T* from, const T* to, size_t count, T ratio, T* out)
+{
+    impl::quaternion_interpolate<true, T, P>(from, to, count, nullptr, ratio, out);
+}
+
+// out[i] = slerp(from[i], to[i], ratios[i])
+template <typename T, typename P = pack_t<T>>
+void quaternion_slerp(const T* from, const T* to, size_t count, const T* ratios, T* out)
+{
+    impl::quaternion_interpolate<true, T, P>(from, to, count, ratios, T(0), out);
+}
+
+// out[i] = nlerp(from[i], to[i], ratio)
+template <typename T, typename P = pack_t<T>>
+void quaternion_nlerp(const T* from, const T* to, size_t count, T ratio, T* out)
+{
+    impl::quaternion_interpolate<false, T, P>(from, to, count, nullptr, ratio, out);
+}
+
+// out[i] = nlerp(from[i], to[i], ratios[i])
+template <typename T, typename P = pack_t<T>>
+void quaternion_nlerp(const T* from, const T* to, size_t count, const T* ratios, T* out)
+{
+    impl::quaternion_interpolate<false, T, P>(from, to, count, ratios, T(0), out);
+}
+
+// out[i] = rotate(in[i], q)
+// with a single quaternion this is a 3x3 matrix transformation
+template <typename T, typename P = pack_t<T>>
+void rotate_by_quaternion(const T* q, const T* in, size_t count, T* out)
+{
+    T r[3][3];
+    impl::quaternion_rotation_rows(q[0], q[1], q[2], q[3], r);
+
+    T m[12] = {}; // column-major 3x4
+    for (int col = 0; col < 3; ++col)
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            m[col * 3 + row] = r[row][col];
+        }
+    }
+
+    impl::transform3<3, false, false, P>(m, in, count, out);
+}
+
+// out[i] = rotate(in[i], q[i])
+template <typename T, typename P = pack_t<T>>
+void rotate_by_quaternions(const T* q, const T* in, size_t count, T* out)
+{
+    constexpr size_t W = P::width;
+
+    auto group = [](const T* pq, const T* pv, T* po) {
+        P qx, qy, qz, qw, x, y, z;
+        load4(pq, qx, qy, qz, qw);
+        load3(pv, x, y, z);
+
+        // v + 2w(q x v) + 2q x (q x v)
+        P tx = fnmadd(qz, y, qy * z);
+        P ty = fnmadd(qx, z, qz * x);
+        P tz = fnmadd(qy, x, qx * y);
+        tx = tx + tx;
+        ty = ty + ty;
+        tz = tz + tz;
+
+        x = fmadd(qw, tx, x) + fnmadd(qz, ty, qy * tz);
+        y = fmadd(qw, ty, y) + fnmadd(qx, tz, qz * tx);
+        z = fmadd(qw, tz, z) + fnmadd(qy, tx, qx * ty);
+
+        store3(po, x, y, z);
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(q + 4 * i, in + 3 * i, out + 3 * i);
+    }
+
+    if (i == count) return;
+
+    // tail: go through zero-padded buffers
+    const size_t rest = count - i;
+    T bq[4 * W] = {}, bv[3 * W] = {};
+    std::memcpy(bq, q + 4 * i, 4 * rest * sizeof(T));
+    std::memcpy(bv, in + 3 * i, 3 * rest * sizeof(T));
+    group(bq, bv, bv);
+    std::memcpy(out + 3 * i, bv, 3 * rest * sizeof(T));
+}
+
+// out[i] = translation(t[i]) * rotation_quaternion(q[i]) * scaling(s[i])
+// the results are column-major 3x4 matrices (the layout of matrix3x4_t)
+// t and s (3d vectors) may be null for no translation and no scaling
+template <typename T, typename P = pack_t<T>>
+void quaternion_to_matrix3x4(const T* q, const T* t, const T* s, size_t count, T* out)
+{
+    constexpr size_t W = P::width;
+
+    auto group = [](const T* pq, const T* pt, const T* ps, T* po) {
+        P x, y, z, w;
+        load4(pq, x, y, z, w);
+
+        P c[4][3]; // columns
+        {
+            P r[3][3];
+            impl::quaternion_rotation_rows(x, y, z, w, r);
+            for (int col = 0; col < 3; ++col)
+            {
+                for (int row = 0; row < 3; ++row)
+                {
+                    c[col][row] = r[row][col];
+                }
+            }
+        }
+
+        if (ps)
+        {
+            P sc[3];
+            load3(ps, sc[0], sc[1], sc[2]);
+            for (int col = 0; col < 3; ++col)
+            {
+                for (auto& e : c[col]) e = e * sc[col];
+            }
+        }
+
+        if (pt) load3(pt, c[3][0], c[3][1], c[3][2]);
+        else c[3][0] = c[3][1] = c[3][2] = P::zero();
+
+        // transpose the 12 packs into W matrices
+        // store4 gives us thirds of matrices, so we go through a buffer
+        T buf[3][4 * W];
+        store4(buf[0], c[0][0], c[0][1], c[0][2], c[1][0]);
+        store4(buf[1], c[1][1], c[1][2], c[2][0], c[2][1]);
+        store4(buf[2], c[2][2], c[3][0], c[3][1], c[3][2]);
+        for (size_t k = 0; k < W; ++k)
+        {
+            for (int g = 0; g < 3; ++g)
+            {
+                std::memcpy(po + 12 * k + 4 * g, buf[g] + 4 * k, 4 * sizeof(T));
+            }
+        }
+    };
+
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(q + 4 * i, t ? t + 3 * i : nullptr, s ? s + 3 * i : nullptr, out + 12 * i);
+    }
+
+    if (i == count) return;
+
+    // tail: go through zero-padded buffers
+    const size_t rest = count - i;
+    T bq[4 * W] = {}, bt[3 * W] = {}, bs[3 * W] = {}, bo[12 * W];
+    std::memcpy(bq, q + 4 * i, 4 * rest * sizeof(T));
+    if (t) std::memcpy(bt, t + 3 * i, 3 * rest * sizeof(T));
+    if (s) std::memcpy(bs, s + 3 * i, 3 * rest * sizeof(T));
+    group(bq, t ? bt : nullptr, s ? bs : nullptr, bo);
+    std::memcpy(out + 12 * i, bo, 12 * rest * sizeof(T));
+}
+
+}
+}
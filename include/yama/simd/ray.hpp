@@ -0,0 +1,157 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+#include <limits>
+#include <utility>
+
+// SIMD kernels for slab tests of rays (origin + t * direction, t in [0, max_t]) and 3d boxes
+//
+// A ray is given by its origin and the inverse of its direction (1 / d per component).
+// A box is 6 values: min xyz and max xyz (the layout of boxnt<3, float>).
+// The results are a bit per test in 32-bit words (bit i % 32 of word i / 32) and,
+// optionally, the distances at which the rays enter the boxes (infinity for misses).
+//
+// Directions with zero components work: the rays are parallel to the slabs and a ray
+// which lies exactly on the side of a box is reported as a hit.
+
+namespace yama
+{
+namespace simd
+{
+
+namespace impl
+{
+// the entry and exit distances of the slab test; hit where t_near <= t_far
+// the near and far planes along each axis are picked by the sign of the direction
+// a NaN distance (0 * inf when the ray lies on a plane) leaves t_near or t_far as they are
+// because of the order of the arguments of max and min
+template <typename P>
+P ray_slabs(const P (&o)[3], const P (&inv)[3], const P (&near_planes)[3], const P (&far_planes)[3], P max_t, P& t_near)
+{
+    t_near = P::zero();
+    P t_far = max_t;
+    for (int i = 0; i < 3; ++i)
+    {
+        t_near = max((near_planes[i] - o[i]) * inv[i], t_near);
+        t_far = min((far_planes[i] - o[i]) * inv[i], t_far);
+    }
+    return t_near <= t_far;
+}
+
+// group(i, t_near) returns the hit mask of the tests i to i + W and sets their entry distances
+// writes the results of all groups
+template <typename P, typename T, typename Group>
+void ray_groups(size_t count, uint32_t* hits, T* t_enter, Group group)
+{
+    constexpr size_t W = P::width;
+    static_assert(32 % W == 0, "the groups must fill the hit words");
+
+    const P miss = P::uniform(std::numeric_limits<T>::infinity());
+
+    for (size_t i = 0; i < count; i += W)
+    {
+        P t_near;
+        const P hit = group(i, t_near);
+        const size_t n = count - i < W ? count - i : W;
+
+        uint32_t bits = uint32_t(mask_bits(hit));
+        if (n < W) bits &= (uint32_t(1) << n) - 1;
+        if (i % 32 == 0) hits[i / 32] = 0;
+        hits[i / 32] |= bits << (i % 32);
+
+        if (!t_enter) continue;
+        t_near = select(hit, t_near, miss);
+        if (n == W)
+        {
+            t_near.store(t_enter + i);
+        }
+        else
+        {
+            T buf[W];
+            t_near.store(buf);
+            std::memcpy(t_enter + i, buf, n * sizeof(T));
+        }
+    }
+}
+}
+
+// one ray against count boxes
+// ray is origin xyz and inverse direction xyz
+// hits must have room for (count + 31) / 32 words, t_enter may be null
+template <typename P = f32xn, typename T = typename P::value_type>
+void ray_boxes(const T* ray, const T* boxes, size_t count, T max_t, uint32_t* hits, T* t_enter)
+{
+    constexpr size_t W = P::width;
+
+    const P o[3] = {P::uniform(ray[0]), P::uniform(ray[1]), P::uniform(ray[2])};
+    const P inv[3] = {P::uniform(ray[3]), P::uniform(ray[4]), P::uniform(ray[5])};
+    const P mt = P::uniform(max_t);
+
+    // the direction is the same for all boxes, so the branches on it are always predicted
+    const bool negative[3] = {ray[3] < 0, ray[4] < 0, ray[5] < 0};
+
+    impl::ray_groups<P>(count, hits, t_enter, [&](size_t i, P& t_near) {
+        P lo[3], hi[3];
+        if (i + W <= count)
+        {
+            load3_pairs(boxes + 6 * i, lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+        }
+        else
+        {
+            // tail: the padding is masked out
+            T buf[6 * W] = {};
+            std::memcpy(buf, boxes + 6 * i, 6 * (count - i) * sizeof(T));
+            load3_pairs(buf, lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            if (negative[k]) std::swap(lo[k], hi[k]);
+        }
+        return impl::ray_slabs(o, inv, lo, hi, mt, t_near);
+    });
+}
+
+// count rays against one box
+// origins and inv_directions are arrays of 3d vectors
+// hits must have room for (count + 31) / 32 words, t_enter may be null
+template <typename P = f32xn, typename T = typename P::value_type>
+void rays_box(const T* origins, const T* inv_directions, size_t count, const T* box, T max_t, uint32_t* hits, T* t_enter)
+{
+    constexpr size_t W = P::width;
+
+    const P lo[3] = {P::uniform(box[0]), P::uniform(box[1]), P::uniform(box[2])};
+    const P hi[3] = {P::uniform(box[3]), P::uniform(box[4]), P::uniform(box[5])};
+    const P mt = P::uniform(max_t);
+
+    impl::ray_groups<P>(count, hits, t_enter, [&](size_t i, P& t_near) {
+        P o[3], inv[3];
+        if (i + W <= count)
+        {
+            load3(origins + 3 * i, o[0], o[1], o[2]);
+            load3(inv_directions + 3 * i, inv[0], inv[1], inv[2]);
+        }
+        else
+        {
+            T buf[2][3 * W] = {};
+            std::memcpy(buf[0], origins + 3 * i, 3 * (count - i) * sizeof(T));
+            std::memcpy(buf[1], inv_directions + 3 * i, 3 * (count - i) * sizeof(T));
+            load3(buf[0], o[0], o[1], o[2]);
+            load3(buf[1], inv[0], inv[1], inv[2]);
+        }
+        P n[3], f[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            const P negative = inv[k] < P::zero();
+            n[k] = select(negative, hi[k], lo[k]);
+            f[k] = select(negative, lo[k], hi[k]);
+        }
+        return impl::ray_slabs(o, inv, n, f, mt, t_near);
+    });
+}
+
+}
+}
@@ -0,0 +1,194 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+// Skinning kernels
+// The palette is an array of column-major 3x4 matrices (the layout of matrix3x4_t)
+// or of dual quaternions (the layout of dual_quaternion_t: real x, y, z, w, then dual x, y, z, w).
+// Vectors are arrays of (x, y, z), and indices and weights hold Influences values per vertex.
+// out may be the same as the corresponding input
+
+namespace yama
+{
+namespace simd
+{
+
+namespace impl
+{
+// calls group(n, indices, weights, positions, normals, out_positions, out_normals) for packs of vertices
+// n is the number of vertices in the group (less than the pack width only for the last one)
+// the vector pointers of the group are always valid for a whole pack
+template <size_t Influences, size_t W, typename T, typename Index, typename Group>
+void skin_groups(const Index* indices, const T* weights, const T* positions, const T* normals,
+    size_t count, T* out_positions, T* out_normals, Group group)
+{
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(W, indices + Influences * i, weights + Influences * i,
+            positions + 3 * i, normals ? normals + 3 * i : nullptr,
+            out_positions + 3 * i, normals ? out_normals + 3 * i : nullptr);
+    }
+
+    if (i == count) return;
+
+    // tail: go through zero-padded buffers
+    const size_t rest = count - i;
+    T bp[3 * W] = {}, bn[3 * W] = {};
+    std::memcpy(bp, positions + 3 * i, 3 * rest * sizeof(T));
+    if (normals) std::memcpy(bn, normals + 3 * i, 3 * rest * sizeof(T));
+    group(rest, indices + Influences * i, weights + Influences * i, bp, normals ? bn : nullptr, bp, bn);
+    std::memcpy(out_positions + 3 * i, bp, 3 * rest * sizeof(T));
+    if (normals) std::memcpy(out_normals + 3 * i, bn, 3 * rest * sizeof(T));
+}
+
+template <typename P>
+void store_normalized3(typename P::value_type* out, P x, P y, P z)
+{
+    const P rl = P::uniform(1) / sqrt(fmadd(x, x, fmadd(y, y, z * z)));
+    store3(out, x * rl, y * rl, z * rl);
+}
+}
+
+// linear blend skinning: each vertex is transformed by the weighted sum of its matrices
+// normals may be null (then out_normals is not touched)
+// skinned normals are normalized
+template <size_t Influences, typename T, typename Index, typename P = pack_t<T>>
+void skin_linear(const T* palette, const Index* indices, const T* weights,
+    const T* positions, const T* normals, size_t count, T* out_positions, T* out_normals)
+{
+    constexpr size_t W = P::width;
+    using Q = pack_n_t<T, 4>; // a third of a matrix
+
+    auto group = [&](size_t n, const Index* idx, const T* wgt, const T* pos, const T* nrm, T* opos, T* onrm) {
+        // blend the matrices of each vertex a third at a time
+        // the thirds are written so that load4 transposes them into one pack per matrix element
+        T buf[3][4 * W];
+        if (n < W) std::memset(buf, 0, sizeof(buf));
+        for (size_t lane = 0; lane < n; ++lane)
+        {
+            Q a[3] = {Q::zero(), Q::zero(), Q::zero()};
+            for (size_t k = 0; k < Influences; ++k)
+            {
+                const Q w = Q::uniform(wgt[lane * Influences + k]);
+                const T* m = palette + 12 * size_t(idx[lane * Influences + k]);
+                for (int g = 0; g < 3; ++g) a[g] = fmadd(w, Q::load(m + 4 * g), a[g]);
+            }
+            for (int g = 0; g < 3; ++g) a[g].store(buf[g] + 4 * lane);
+        }
+
+        P m[12]; // column-major
+        load4(buf[0], m[0], m[1], m[2], m[3]);
+        load4(buf[1], m[4], m[5], m[6], m[7]);
+        load4(buf[2], m[8], m[9], m[10], m[11]);
+
+        P x, y, z, r[3];
+        load3(pos, x, y, z);
+        for (int row = 0; row < 3; ++row)
+        {
+            r[row] = fmadd(m[row], x, fmadd(m[3 + row], y, fmadd(m[6 + row], z, m[9 + row])));
+        }
+        store3(opos, r[0], r[1], r[2]);
+
+        if (!nrm) return;
+
+        load3(nrm, x, y, z);
+        for (int row = 0; row < 3; ++row)
+        {
+            r[row] = fmadd(m[row], x, fmadd(m[3 + row], y, m[6 + row] * z));
+        }
+        impl::store_normalized3(onrm, r[0], r[1], r[2]);
+    };
+
+    impl::skin_groups<Influences, W>(indices, weights, positions, normals, count, out_positions, out_normals, group);
+}
+
+// dual quaternion skinning: each vertex is transformed by the normalized weighted sum of its dual quaternions
+// the dual quaternions are flipped to the hemisphere of the first influence, so that the sum takes the shorter path
+// normals may be null (then out_normals is not touched)
+// skinned normals are only rotated, so they keep their length
+template <size_t Influences, typename T, typename Index, typename P = pack_t<T>>
+void skin_dual_quaternion(const T* palette, const Index* indices, const T* weights,
+    const T* positions, const T* normals, size_t count, T* out_positions, T* out_normals)
+{
+    constexpr size_t W = P::width;
+    using Q = pack_n_t<T, 4>; // a quaternion
+
+    auto group = [&](size_t n, const Index* idx, const T* wgt, const T* pos, const T* nrm, T* opos, T* onrm) {
+        // blend the dual quaternions of each vertex
+        // the sums are written so that load4 transposes them into one pack per element
+        T buf[2][4 * W];
+        if (n < W)
+        {
+            // identity, to keep the normalization finite
+            std::memset(buf, 0, sizeof(buf));
+            for (size_t lane = n; lane < W; ++lane) buf[0][4 * lane + 3] = 1;
+        }
+        for (size_t lane = 0; lane < n; ++lane)
+        {
+            const T* first = palette + 8 * size_t(idx[lane * Influences]);
+            const Q pivot = Q::load(first);
+            Q real = Q::zero(), dual = Q::zero();
+            for (size_t k = 0; k < Influences; ++k)
+            {
+                const T* dq = palette + 8 * size_t(idx[lane * Influences + k]);
+                const Q r = Q::load(dq);
+                // flip without a branch: the hemispheres are hardly predictable
+                const Q qw = Q::uniform(std::copysign(wgt[lane * Influences + k], hsum(r * pivot)));
+                real = fmadd(qw, r, real);
+                dual = fmadd(qw, Q::load(dq + 4), dual);
+            }
+            real.store(buf[0] + 4 * lane);
+            dual.store(buf[1] + 4 * lane);
+        }
+
+        P rx, ry, rz, rw, dx, dy, dz, dw;
+        load4(buf[0], rx, ry, rz, rw);
+        load4(buf[1], dx, dy, dz, dw);
+
+        // normalize
+        // the dual part is not made orthogonal to the real one:
+        // the component parallel to the real part doesn't affect the translation
+        const P rl = P::uniform(1) / sqrt(fmadd(rx, rx, fmadd(ry, ry, fmadd(rz, rz, rw * rw))));
+        rx = rx * rl; ry = ry * rl; rz = rz * rl; rw = rw * rl;
+        dx = dx * rl; dy = dy * rl; dz = dz * rl; dw = dw * rl;
+
+        // v + 2r x (r x v + w v)
+        auto rotate = [&](P& x, P& y, P& z) {
+            const P cx = fmadd(rw, x, fnmadd(rz, y, ry * z));
+            const P cy = fmadd(rw, y, fnmadd(rx, z, rz * x));
+            const P cz = fmadd(rw, z, fnmadd(ry, x, rx * y));
+            const P tx = fnmadd(rz, cy, ry * cz);
+            const P ty = fnmadd(rx, cz, rz * cx);
+            const P tz = fnmadd(ry, cx, rx * cy);
+            x = fmadd(P::uniform(2), tx, x);
+            y = fmadd(P::uniform(2), ty, y);
+            z = fmadd(P::uniform(2), tz, z);
+        };
+
+        // translation: 2 (rw dv - dw rv + rv x dv)
+        const P two = P::uniform(2);
+        const P tx = two * (fnmadd(dw, rx, rw * dx) + fnmadd(rz, dy, ry * dz));
+        const P ty = two * (fnmadd(dw, ry, rw * dy) + fnmadd(rx, dz, rz * dx));
+        const P tz = two * (fnmadd(dw, rz, rw * dz) + fnmadd(ry, dx, rx * dy));
+
+        P x, y, z;
+        load3(pos, x, y, z);
+        rotate(x, y, z);
+        store3(opos, x + tx, y + ty, z + tz);
+
+        if (!nrm) return;
+
+        load3(nrm, x, y, z);
+        rotate(x, y, z);
+        store3(onrm, x, y, z);
+    };
+
+    impl::skin_groups<Influences, W>(indices, weights, positions, normals, count, out_positions, out_normals, group);
+}
+
+}
+}
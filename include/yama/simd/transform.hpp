@@ -0,0 +1,98 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "pack.hpp"
+
+// SIMD kernels which transform arrays of 3d float vectors (x0, y0, z0, x1, y1, z1...)
+// by column-major matrices with Rows rows and 4 columns (the layouts of matrix3x4_t<float>
+// and matrix4x4_t<float>)
+// The vectors are processed in groups of P::width
+// out may be the same as in
+
+namespace yama
+{
+namespace simd
+{
+
+namespace impl
+{
+// it works with packs of any type, not only float
+template <int Rows, bool Translate, bool Divide, typename P, typename T = typename P::value_type>
+void transform3(const T* m, const T* in, size_t count, T* out)
+{
+    static_assert(!Divide || Rows == 4, "only 4x4 matrices have a w row");
+
+    // hoist the matrix in registers
+    P c[Rows][4];
+    for (int col = 0; col < 4; ++col)
+    {
+        for (int row = 0; row < Rows; ++row)
+        {
+            c[row][col] = P::uniform(m[col * Rows + row]);
+        }
+    }
+
+    auto group = [&](const T* src, T* dst) {
+        P x, y, z;
+        load3(src, x, y, z);
+
+        P r[3];
+        for (int row = 0; row < 3; ++row)
+        {
+            r[row] = c[row][2] * z;
+            if (Translate) r[row] = r[row] + c[row][3];
+            r[row] = fmadd(c[row][1], y, r[row]);
+            r[row] = fmadd(c[row][0], x, r[row]);
+        }
+
+        if (Divide)
+        {
+            const auto& w = c[Rows - 1];
+            P rw = P::uniform(1) / fmadd(w[0], x, fmadd(w[1], y, fmadd(w[2], z, w[3])));
+            for (auto& e : r) e = e * rw;
+        }
+
+        store3(dst, r[0], r[1], r[2]);
+    };
+
+    constexpr size_t W = P::width;
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+    {
+        group(in + 3 * i, out + 3 * i);
+    }
+
+    if (i == count) return;
+
+    // tail: go through a zero-padded buffer so that it gets the same treatment
+    T buf[3 * W] = {};
+    const size_t rest = 3 * (count - i);
+    std::memcpy(buf, in + 3 * i, rest * sizeof(T));
+    group(buf, buf);
+    std::memcpy(out + 3 * i, buf, rest * sizeof(T));
+}
+}
+
+// transform coordinates (points)
+// if projective is true, the results are divided by w (Rows must be 4)
+template <int Rows, typename P = f32xn>
+void transform_coord(const float* m, const float* in, size_t count, float* out, bool projective)
+{
+    if constexpr (Rows == 4)
+    {
+        if (projective) return impl::transform3<Rows, true, true, P>(m, in, count, out);
+    }
+    impl::transform3<Rows, true, false, P>(m, in, count, out);
+}
+
+// transform normals (directions): no translation and no division
+template <int Rows, typename P = f32xn>
+void transform_normal(const float* m, const float* in, size_t count, float* out)
+{
+    impl::transform3<Rows, false, false, P>(m, in, count, out);
+}
+
+}
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "matrix3x4.hpp"
+#include "dual_quaternion.hpp"
+#include "simd/skinning.hpp"
+
+#include <cstdint>
+
+// Skinning of vertices by a palette of bone transformations
+// (matrix3x4_t for linear blend skinning or dual_quaternion_t for dual quaternion skinning)
+//
+// Each vertex is influenced by a fixed number of bones (usually 4 or 8) and has an index
+// in the palette and a weight for each of them. The weights of a vertex should be non-negative
+// and sum up to 1.
+// Unused influences must have a weight of 0 and a valid index (say 0).
+//
+// Vertices are processed several at a time. The functions can be given a range of the
+// vertices, so different ranges can be skinned concurrently (for example by different threads).
+
+namespace yama
+{
+
+template <size_t Influences, typename T, typename Index = uint16_t>
+struct skinned_vertices_t
+{
+    static constexpr size_t influences = Influences;
+    using value_type = T;
+    using index_type = Index;
+
+    size_t count = 0;
+
+    const Index* indices = nullptr; // Influences per vertex
+    const T* weights = nullptr; // Influences per vertex
+
+    const vector3_t<T>* positions = nullptr;
+    const vector3_t<T>* normals = nullptr; // may be null
+
+    // the outputs may be the same as the inputs
+    vector3_t<T>* out_positions = nullptr;
+    vector3_t<T>* out_normals = nullptr; // needed only if there are normals
+};
+
+// linear blend skinning of the vertices [begin, end)
+// each vertex is transformed by the weighted sum of its matrices in the palette
+// normals are transformed without the translation and normalized
+template <size_t Influences, typename T, typename Index>
+void skin_linear(const matrix3x4_t<T>* palette, const skinned_vertices_t<Influences, T, Index>& v, size_t begin, size_t end)
+{
+    YAMA_ASSERT_CRIT(begin <= end && end <= v.count, "yama::skin_linear range out of bounds");
+    YAMA_ASSERT_CRIT(!v.normals || v.out_normals, "yama::skin_linear has normals, but nowhere to put them");
+
+    simd::skin_linear<Influences>(reinterpret_cast<const T*>(palette),
+        v.indices + Influences * begin, v.weights + Influences * begin,
+        reinterpret_cast<const T*>(v.positions + begin),
+        v.normals ? reinterpret_cast<const T*>(v.normals + begin) : nullptr,
+        end - begin,
+        reinterpret_cast<T*>(v.out_positions + begin),
+        v.normals ? reinterpret_cast<T*>(v.out_normals + begin) : nullptr);
+}
+
+// linear blend skinning of all vertices
+template <size_t Influences, typename T, typename Index>
+void skin_linear(const matrix3x4_t<T>* palette, const skinned_vertices_t<Influences, T, Index>& v)
+{
+    skin_linear(palette, v, 0, v.count);
+}
+
+// dual quaternion skinning of the vertices [begin, end)
+// each vertex is transformed by the normalized weighted sum of its dual quaternions in the palette
+// unlike linear blend skinning, this preserves the volume around joints with large rotations,
+// and the palette is 8 values per bone instead of 12
+// normals are rotated
+template <size_t Influences, typename T, typename Index>
+void skin_dual_quaternion(const dual_quaternion_t<T>* palette, const skinned_vertices_t<Influences, T, Index>& v, size_t begin, size_t end)
+{
+    YAMA_ASSERT_CRIT(begin <= end && end <= v.count, "yama::skin_dual_quaternion range out of bounds");
+    YAMA_ASSERT_CRIT(!v.normals || v.out_normals, "yama::skin_dual_quaternion has normals, but nowhere to put them");
+
+    simd::skin_dual_quaternion<Influences>(reinterpret_cast<const T*>(palette),
+        v.indices + Influences * begin, v.weights + Influences * begin,
+        reinterpret_cast<const T*>(v.positions + begin),
+        v.normals ? reinterpret_cast<const T*>(v.normals + begin) : nullptr,
+        end - begin,
+        reinterpret_cast<T*>(v.out_positions + begin),
+        v.normals ? reinterpret_cast<T*>(v.out_normals + begin) : nullptr);
+}
+
+// dual quaternion skinning of all vertices
+template <size_t Influences, typename T, typename Index>
+void skin_dual_quaternion(const dual_quaternion_t<T>* palette, const skinned_vertices_t<Influences, T, Index>& v)
+{
+    skin_dual_quaternion(palette, v, 0, v.count);
+}
+
+// shorthand
+#if !defined(YAMA_NO_SHORTHAND)
+
+using skinned_vertices4 = skinned_vertices_t<4, preferred_type>;
+using skinned_vertices8 = skinned_vertices_t<8, preferred_type>;
+
+#endif
+
+}
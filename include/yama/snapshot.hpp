@@ -0,0 +1,138 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vector3.hpp"
+#include "quaternion.hpp"
+#include "box.hpp"
+#include "quantize.hpp"
+#include "packed_quaternion.hpp"
+#include "simd/delta.hpp"
+
+// Compression of snapshots of transformations (positions and rotations of entities) for replication
+//
+// A snapshot is the quantized transformations of count entities: 7 integers per entity. The
+// positions are quantized to PositionBits bits relative to the bounds of the codec and the rotations
+// are packed in RotationBits bits with the smallest three encoding (as in packed_quaternion_t).
+// The integers are field-major: the x of all entities, then the y of all, and so on, followed by
+// the index of the largest component and the three smaller ones of the rotations.
+//
+// Snapshots are encoded as deltas against a baseline snapshot of the same entities (one which
+// the receiver has, say the last one it acknowledged), or against zeros if there is none,
+// with encode_deltas from simd/delta.hpp. So entities which haven't moved take almost nothing.
+// The decoder restores the exact snapshot, which is the baseline for the next ones.
+
+namespace yama
+{
+
+template <typename T, int PositionBits = 16, int RotationBits = 48>
+class snapshot_codec
+{
+public:
+    using value_type = T;
+    using box = boxnt<3, T>;
+    using vector = vector3_t<T>;
+    using quaternion = quaternion_t<T>;
+    using packed_rotation = packed_quaternion_t<RotationBits>;
+
+    static constexpr size_t fields = 7;
+
+    explicit snapshot_codec(const box& bounds)
+        : m_bounds(bounds)
+    {}
+
+    const box& bounds() const { return m_bounds; }
+
+    // the size of a snapshot of count entities
+    static size_t snapshot_size(size_t count)
+    {
+        return fields * count;
+    }
+
+    // the largest size of the encoding of a snapshot of count entities
+    static size_t max_encoded_size(size_t count)
+    {
+        return simd::max_deltas_size(snapshot_size(count));
+    }
+
+    // snapshot gets snapshot_size(count) integers
+    // returns the largest error of the positions along each axis (as yama::quantize)
+    vector quantize(const vector* positions, const quaternion* rotations, size_t count, uint32_t* snapshot) const
+    {
+        using codec = typename packed_rotation::codec;
+
+        quantized_t<PositionBits> qp[3 * chunk];
+        packed_rotation qr[chunk];
+        vector ret = vector::zero();
+        for (size_t i = 0; i < count; i += chunk)
+        {
+            const size_t n = count - i < chunk ? count - i : chunk;
+            ret = max(ret, yama::quantize<PositionBits>(m_bounds, positions + i, n, qp));
+            pack(rotations + i, n, qr);
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                uint32_t* s = snapshot + i + j;
+                for (size_t k = 0; k < 3; ++k) s[k * count] = qp[3 * j + k];
+
+                const uint64_t v = codec::read(qr[j].words);
+                s[3 * count] = uint32_t(v >> 3 * codec::component_bits);
+                for (size_t k = 0; k < 3; ++k) s[(4 + k) * count] = uint32_t((v >> (2 - k) * codec::component_bits) & codec::component_mask);
+            }
+        }
+        return ret;
+    }
+
+    // snapshot has snapshot_size(count) integers
+    void dequantize(const uint32_t* snapshot, size_t count, vector* positions, quaternion* rotations) const
+    {
+        using codec = typename packed_rotation::codec;
+
+        quantized_t<PositionBits> qp[3 * chunk];
+        packed_rotation qr[chunk];
+        for (size_t i = 0; i < count; i += chunk)
+        {
+            const size_t n = count - i < chunk ? count - i : chunk;
+            for (size_t j = 0; j < n; ++j)
+            {
+                const uint32_t* s = snapshot + i + j;
+                for (size_t k = 0; k < 3; ++k) qp[3 * j + k] = quantized_t<PositionBits>(s[k * count]);
+
+                // mask the fields, so that a corrupt snapshot still gives quaternions
+                const uint64_t m = codec::component_mask;
+                codec::write(codec::join(s[3 * count] & 3, s[4 * count] & m, s[5 * count] & m, s[6 * count] & m), qr[j].words);
+            }
+
+            yama::dequantize<PositionBits>(m_bounds, qp, n, positions + i);
+            unpack(qr, n, rotations + i);
+        }
+    }
+
+    // baseline is a snapshot of the same entities or null
+    // out gets up to max_encoded_size(count) bytes
+    // returns the size of the encoding
+    static size_t encode(const uint32_t* snapshot, const uint32_t* baseline, size_t count, uint8_t* out)
+    {
+        return simd::encode_deltas(snapshot, baseline, snapshot_size(count), out);
+    }
+
+    // in is an encoding in size bytes and baseline is the snapshot it was encoded against or null
+    // snapshot gets snapshot_size(count) integers
+    // returns the size of the encoding, or 0 if it's malformed
+    static size_t decode(const uint8_t* in, size_t size, const uint32_t* baseline, size_t count, uint32_t* snapshot)
+    {
+        return simd::decode_deltas(in, size, baseline, snapshot_size(count), snapshot);
+    }
+
+private:
+    // the entities are quantized in chunks through buffers on the stack
+    static constexpr size_t chunk = 64;
+
+    box m_bounds;
+};
+
+}
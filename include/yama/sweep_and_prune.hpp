@@ -0,0 +1,297 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "box.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <unordered_set>
+
+// Sweep and prune broadphase of D-dimensional boxes
+//
+// The min and max coordinates of the boxes are kept in a sorted list of endpoints per axis.
+// When a box moves, its endpoints are moved to their new places with insertion sort. Between
+// frames the boxes usually move a little, so this costs a few swaps per box. The overlapping
+// pairs are kept up to date by the swaps: a min passing a max starts an overlap on an axis
+// (the pair is added if the boxes intersect) and a max passing a min ends one.
+//
+// The overlaps are as in boxnt::intersects, so touching boxes don't overlap.
+// The ids returned by insert stay the same until the box is removed, and are reused after that.
+
+namespace yama
+{
+
+template <size_t D, typename T>
+class sweep_and_prune
+{
+public:
+    static const size_t dimension = D;
+    using box = boxnt<D, T>;
+    using index_type = uint32_t;
+
+    struct endpoint
+    {
+        T value;
+        index_type data; // id << 1 | is_max
+
+        index_type id() const { return data >> 1; }
+        bool is_max() const { return data & 1; }
+
+        // at equal values maxes come before mins, so touching boxes don't overlap
+        bool operator<(const endpoint& e) const
+        {
+            return value < e.value || (value == e.value && is_max() && !e.is_max());
+        }
+    };
+
+    sweep_and_prune() = default;
+
+    // builds the broadphase from an array of boxes (with a full sort): box i gets id i
+    sweep_and_prune(const box* boxes, size_t count)
+    {
+        m_objects.resize(count);
+        for (size_t d = 0; d < D; ++d)
+        {
+            auto& ep = m_endpoints[d];
+            ep.resize(2 * count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ep[2 * i] = {boxes[i].min.at(d), index_type(i) << 1};
+                ep[2 * i + 1] = {boxes[i].max.at(d), index_type(i) << 1 | 1};
+            }
+            std::sort(ep.begin(), ep.end());
+            for (size_t i = 0; i < ep.size(); ++i) m_objects[ep[i].id()].endpoints[d][ep[i].is_max()] = index_type(i);
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_objects[i].bounds = boxes[i];
+            m_objects[i].alive = true;
+        }
+        m_size = count;
+
+        // sweep the first axis and test the boxes which are open at the same time
+        std::vector<index_type> open;
+        for (auto& e : m_endpoints[0])
+        {
+            if (e.is_max())
+            {
+                // the open list is short, so a linear search is fine
+                // boxes with zero width on the axis are never opened: their max comes before their min
+                auto f = std::find(open.begin(), open.end(), e.id());
+                if (f == open.end()) continue;
+                *f = open.back();
+                open.pop_back();
+                continue;
+            }
+            const auto& b = m_objects[e.id()].bounds;
+            for (auto o : open)
+            {
+                if (m_objects[o].bounds.intersects(b)) add_pair(o, e.id());
+            }
+            // a box with zero width can't overlap the ones opened after it
+            if (b.min.at(0) < b.max.at(0)) open.push_back(e.id());
+        }
+    }
+
+    void clear()
+    {
+        m_objects.clear();
+        for (auto& ep : m_endpoints) ep.clear();
+        m_free.clear();
+        m_pairs.clear();
+        m_size = 0;
+    }
+
+    // number of boxes
+    size_t size() const { return m_size; }
+
+    index_type insert(const box& b)
+    {
+        index_type id;
+        if (m_free.empty())
+        {
+            id = index_type(m_objects.size());
+            m_objects.emplace_back();
+        }
+        else
+        {
+            id = m_free.back();
+            m_free.pop_back();
+        }
+
+        auto& o = m_objects[id];
+        o.bounds = b;
+        o.alive = true;
+        m_old_bounds = box::inverted(); // no old pairs
+
+        // the endpoints start at the end and sift down to their places
+        for (size_t d = 0; d < D; ++d)
+        {
+            auto& ep = m_endpoints[d];
+            o.endpoints[d][1] = index_type(ep.size());
+            ep.push_back({b.max.at(d), id << 1 | 1});
+            sift_down(d, o.endpoints[d][1]);
+            o.endpoints[d][0] = index_type(ep.size());
+            ep.push_back({b.min.at(d), id << 1});
+            sift_down(d, o.endpoints[d][0]);
+        }
+
+        ++m_size;
+        return id;
+    }
+
+    void remove(index_type id)
+    {
+        YAMA_ASSERT_CRIT(id < m_objects.size() && m_objects[id].alive, "yama::sweep_and_prune removing a bad id");
+
+        // moving the box past all others removes its pairs
+        const T inf = std::numeric_limits<T>::infinity();
+        update(id, box::min_max(box::dim_vector::uniform(inf), box::dim_vector::uniform(inf)));
+
+        // then its endpoints are erased (they're at the end or close to it)
+        auto& o = m_objects[id];
+        for (size_t d = 0; d < D; ++d)
+        {
+            auto& ep = m_endpoints[d];
+            const auto first = std::min(o.endpoints[d][0], o.endpoints[d][1]);
+            index_type dst = first;
+            for (index_type i = first; i < ep.size(); ++i)
+            {
+                if (ep[i].id() == id) continue;
+                ep[dst] = ep[i];
+                m_objects[ep[dst].id()].endpoints[d][ep[dst].is_max()] = dst;
+                ++dst;
+            }
+            ep.resize(dst);
+        }
+
+        o.alive = false;
+        m_free.push_back(id);
+        --m_size;
+    }
+
+    // moves the box with the id to b and updates its pairs
+    void update(index_type id, const box& b)
+    {
+        YAMA_ASSERT_CRIT(id < m_objects.size() && m_objects[id].alive, "yama::sweep_and_prune updating a bad id");
+
+        auto& o = m_objects[id];
+        m_old_bounds = o.bounds;
+        o.bounds = b;
+        for (size_t d = 0; d < D; ++d)
+        {
+            // one endpoint at a time, so the others are sorted while it moves
+            for (int m = 0; m < 2; ++m)
+            {
+                const auto i = o.endpoints[d][m];
+                m_endpoints[d][i].value = m ? b.max.at(d) : b.min.at(d);
+                sift_down(d, i);
+                sift_up(d, o.endpoints[d][m]);
+            }
+        }
+    }
+
+    const box& get(index_type id) const { return m_objects[id].bounds; }
+
+    ////////////////////////////////////////////////////////
+    // pairs
+
+    size_t pair_count() const { return m_pairs.size(); }
+
+    bool overlaps(index_type a, index_type b) const
+    {
+        return m_pairs.count(pair_key(a, b)) != 0;
+    }
+
+    // calls f(a, b) with a < b for each pair of ids of overlapping boxes (in no particular order)
+    template <typename F>
+    void for_each_pair(F f) const
+    {
+        for (auto key : m_pairs) f(index_type(key >> 32), index_type(key));
+    }
+
+    const std::vector<endpoint>& endpoints(size_t axis) const { return m_endpoints[axis]; }
+
+private:
+    struct object
+    {
+        box bounds;
+        index_type endpoints[D][2]; // indices of the min and max endpoints per axis
+        bool alive = false;
+    };
+
+    static uint64_t pair_key(index_type a, index_type b)
+    {
+        if (a > b) std::swap(a, b);
+        return uint64_t(a) << 32 | b;
+    }
+
+    void add_pair(index_type a, index_type b) { m_pairs.insert(pair_key(a, b)); }
+    void remove_pair(index_type a, index_type b) { m_pairs.erase(pair_key(a, b)); }
+
+    // endpoint e of the box which moves passed over endpoint other: a min passing a max starts an overlap on this axis
+    // and a max passing a min ends one
+    void on_swap(const endpoint& e, const endpoint& other, bool down)
+    {
+        const auto a = e.id(), b = other.id();
+        if (a == b || e.is_max() == other.is_max()) return;
+
+        // most swaps don't change the pairs, so the set is touched only when the old or new boxes intersect
+        const auto& bb = m_objects[b].bounds;
+        if (e.is_max() != down)
+        {
+            // max going up or min going down
+            if (m_objects[a].bounds.intersects(bb) && !m_old_bounds.intersects(bb)) add_pair(a, b);
+        }
+        else if (m_old_bounds.intersects(bb))
+        {
+            remove_pair(a, b);
+        }
+    }
+
+    void place(size_t axis, index_type i, const endpoint& e)
+    {
+        m_endpoints[axis][i] = e;
+        m_objects[e.id()].endpoints[axis][e.is_max()] = i;
+    }
+
+    void sift_down(size_t axis, index_type i)
+    {
+        auto& ep = m_endpoints[axis];
+        const endpoint e = ep[i];
+        while (i > 0 && e < ep[i - 1])
+        {
+            on_swap(e, ep[i - 1], true);
+            place(axis, i, ep[i - 1]);
+            --i;
+        }
+        place(axis, i, e);
+    }
+
+    void sift_up(size_t axis, index_type i)
+    {
+        auto& ep = m_endpoints[axis];
+        const endpoint e = ep[i];
+        while (i + 1 < ep.size() && ep[i + 1] < e)
+        {
+            on_swap(e, ep[i + 1], false);
+            place(axis, i, ep[i + 1]);
+            ++i;
+        }
+        place(axis, i, e);
+    }
+
+    std::vector<object> m_objects;
+    std::vector<endpoint> m_endpoints[D];
+    std::vector<index_type> m_free;
+    std::unordered_set<uint64_t> m_pairs;
+    size_t m_size = 0;
+
+    box m_old_bounds; // the box before the update of the one which moves
+};
+
+}
@@ -0,0 +1,222 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "vector3.hpp"
+#include "quaternion.hpp"
+#include "matrix3x4.hpp"
+
+#include <vector>
+#include <cstdint>
+
+// Hierarchy of transformations (a scene graph or a skeleton)
+//
+// The nodes are in flat arrays: a parent index and a local translation, rotation and scaling
+// per node. The parent of a node is always before it, so a single pass over the arrays visits
+// the parents before their children.
+// Changing the local transformation of a node only marks it as dirty. update() rebuilds the local
+// matrices of the dirty nodes and the world matrices of them and their descendants, and leaves
+// the others alone.
+//
+// Ranges of nodes can be updated separately, if their parents outside the range are already up
+// to date. When each node is added after its parent's subtree (depth-first order), the subtree of
+// a node is a range, and different subtrees can be updated concurrently (for example by different
+// threads).
+
+namespace yama
+{
+
+template <typename T>
+class transform_hierarchy
+{
+public:
+    using value_type = T;
+    using index_type = uint32_t;
+    using vector = vector3_t<T>;
+    using quaternion = quaternion_t<T>;
+    using matrix = matrix3x4_t<T>;
+
+    static constexpr index_type no_parent = index_type(-1);
+
+    transform_hierarchy() = default;
+
+    // parent must be no_parent or an existing node
+    index_type add(index_type parent, const vector& t = vector::zero(), const quaternion& r = quaternion::identity(),
+        const vector& s = vector::uniform(1))
+    {
+        YAMA_ASSERT_CRIT(parent == no_parent || parent < size(), "yama::transform_hierarchy parent out of range");
+
+        const auto ret = index_type(size());
+        m_parents.push_back(parent);
+        m_translations.push_back(t);
+        m_rotations.push_back(r);
+        m_scalings.push_back(s);
+        m_local.push_back(matrix::identity());
+        m_world.push_back(matrix::identity());
+        m_flags.push_back(local_dirty);
+
+        // the node stays in depth-first order if it's appended to the end of its parent's subtree
+        // which is also the end of the subtrees of all of its ancestors
+        m_subtree_ends.push_back(ret + 1);
+        if (parent != no_parent)
+        {
+            if (m_subtree_ends[parent] != ret) m_depth_first = false;
+            for (auto p = parent; p != no_parent; p = m_parents[p])
+            {
+                if (m_subtree_ends[p] == ret) m_subtree_ends[p] = ret + 1;
+            }
+        }
+        return ret;
+    }
+
+    void reserve(size_t n)
+    {
+        m_parents.reserve(n);
+        m_translations.reserve(n);
+        m_rotations.reserve(n);
+        m_scalings.reserve(n);
+        m_local.reserve(n);
+        m_world.reserve(n);
+        m_flags.reserve(n);
+        m_subtree_ends.reserve(n);
+    }
+
+    void clear()
+    {
+        m_parents.clear();
+        m_translations.clear();
+        m_rotations.clear();
+        m_scalings.clear();
+        m_local.clear();
+        m_world.clear();
+        m_flags.clear();
+        m_subtree_ends.clear();
+        m_depth_first = true;
+    }
+
+    size_t size() const { return m_parents.size(); }
+    bool empty() const { return m_parents.empty(); }
+
+    index_type parent(size_t i) const { return m_parents[i]; }
+
+    ////////////////////////////////////////////////////////
+    // local transformations
+
+    const vector& translation(size_t i) const { return m_translations[i]; }
+    const quaternion& rotation(size_t i) const { return m_rotations[i]; }
+    const vector& scaling(size_t i) const { return m_scalings[i]; }
+
+    void set_translation(size_t i, const vector& t)
+    {
+        m_translations[i] = t;
+        m_flags[i] |= local_dirty;
+    }
+
+    void set_rotation(size_t i, const quaternion& r)
+    {
+        m_rotations[i] = r;
+        m_flags[i] |= local_dirty;
+    }
+
+    void set_scaling(size_t i, const vector& s)
+    {
+        m_scalings[i] = s;
+        m_flags[i] |= local_dirty;
+    }
+
+    void set_local(size_t i, const vector& t, const quaternion& r, const vector& s)
+    {
+        m_translations[i] = t;
+        m_rotations[i] = r;
+        m_scalings[i] = s;
+        m_flags[i] |= local_dirty;
+    }
+
+    bool is_dirty(size_t i) const { return m_flags[i] & local_dirty; }
+
+    ////////////////////////////////////////////////////////
+    // update
+
+    void update()
+    {
+        update(0, size());
+    }
+
+    // updates the nodes [begin, end)
+    // the parents of the nodes in the range must be in it or already updated
+    void update(size_t begin, size_t end)
+    {
+        YAMA_ASSERT_CRIT(begin <= end && end <= size(), "yama::transform_hierarchy::update range out of bounds");
+
+        // the local matrices of the runs of dirty nodes (the float version converts several at once)
+        for (size_t i = begin; i < end;)
+        {
+            if (!(m_flags[i] & local_dirty))
+            {
+                ++i;
+                continue;
+            }
+            size_t run_end = i + 1;
+            while (run_end < end && (m_flags[run_end] & local_dirty)) ++run_end;
+            translation_rotation_scaling(m_translations.data() + i, m_rotations.data() + i, m_scalings.data() + i,
+                run_end - i, m_local.data() + i);
+            i = run_end;
+        }
+
+        // the world matrices of the dirty nodes and their descendants
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto p = m_parents[i];
+            const bool changed = (m_flags[i] & local_dirty) || (p != no_parent && (m_flags[p] & world_changed));
+            m_flags[i] = changed ? world_changed : 0;
+            if (!changed) continue;
+            m_world[i] = p == no_parent ? m_local[i] : m_world[p] * m_local[i];
+        }
+    }
+
+    // whether the world matrix of the node changed in the last update which covered it
+    bool is_world_changed(size_t i) const { return m_flags[i] & world_changed; }
+
+    ////////////////////////////////////////////////////////
+    // the matrices are as of the last update
+
+    const matrix& local_matrix(size_t i) const { return m_local[i]; }
+    const matrix& world_matrix(size_t i) const { return m_world[i]; }
+
+    const std::vector<index_type>& parents() const { return m_parents; }
+    const std::vector<matrix>& local_matrices() const { return m_local; }
+    const std::vector<matrix>& world_matrices() const { return m_world; }
+
+    ////////////////////////////////////////////////////////
+    // subtrees
+
+    // whether each node was added after the subtree of its parent
+    bool is_depth_first() const { return m_depth_first; }
+
+    // the subtree of i is [i, subtree_end(i)) (only if the nodes are in depth-first order)
+    size_t subtree_end(size_t i) const
+    {
+        YAMA_ASSERT_CRIT(m_depth_first, "yama::transform_hierarchy subtrees need depth-first order");
+        return m_subtree_ends[i];
+    }
+
+private:
+    enum : uint8_t
+    {
+        local_dirty = 1,
+        world_changed = 2,
+    };
+
+    std::vector<index_type> m_parents;
+    std::vector<vector> m_translations;
+    std::vector<quaternion> m_rotations;
+    std::vector<vector> m_scalings;
+    std::vector<matrix> m_local;
+    std::vector<matrix> m_world;
+    std::vector<uint8_t> m_flags;
+    std::vector<index_type> m_subtree_ends;
+    bool m_depth_first = true;
+};
+
+}
@@ -0,0 +1,404 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "vector3.hpp"
+#include "simd/pack.hpp"
+
+// Packets of N 3d vectors: one pack per coordinate
+//
+// vector3x4_t<float> and vector3x8_t<float> map to SSE and AVX registers.
+// The operators and functions mirror the ones of vector3_t, so loops written for vector3_t
+// can process N vectors at once by changing the type. Where vector3_t produces a scalar
+// (dot, length...), the packet produces a pack of N scalars.
+//
+// Comparisons of packs produce masks for select. Horizontal reductions (hsum, hmin, hmax)
+// combine the N vectors into a single vector3_t.
+
+namespace yama
+{
+
+template <typename T, size_t N>
+class vector3_packet_t
+{
+public:
+    using pack = simd::pack_n_t<T, N>;
+
+    pack x, y, z;
+
+    using value_type = T;
+    using size_type = size_t;
+
+    static constexpr size_type width = N;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // named constructors
+    static vector3_packet_t coord(const pack& x, const pack& y, const pack& z)
+    {
+        return {x, y, z};
+    }
+
+    static vector3_packet_t uniform(const value_type& s)
+    {
+        auto p = pack::uniform(s);
+        return coord(p, p, p);
+    }
+
+    static vector3_packet_t zero()
+    {
+        return uniform(value_type(0));
+    }
+
+    // all N vectors are v
+    static vector3_packet_t broadcast(const vector3_t<T>& v)
+    {
+        return coord(pack::uniform(v.x), pack::uniform(v.y), pack::uniform(v.z));
+    }
+
+    static vector3_packet_t unit_x()
+    {
+        return broadcast(vector3_t<T>::unit_x());
+    }
+
+    static vector3_packet_t unit_y()
+    {
+        return broadcast(vector3_t<T>::unit_y());
+    }
+
+    static vector3_packet_t unit_z()
+    {
+        return broadcast(vector3_t<T>::unit_z());
+    }
+
+    // load N consecutive vectors
+    static vector3_packet_t from_ptr(const vector3_t<T>* ptr)
+    {
+        YAMA_ASSERT_CRIT(ptr, "Constructing yama::vector3_packet_t from nullptr");
+        vector3_packet_t ret;
+        simd::load3(ptr->data(), ret.x, ret.y, ret.z);
+        return ret;
+    }
+
+    // load from N consecutive elements of the lanes of a structure of arrays
+    static vector3_packet_t from_lanes(const value_type* x, const value_type* y, const value_type* z)
+    {
+        return coord(pack::load(x), pack::load(y), pack::load(z));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // access
+
+    void store(vector3_t<T>* ptr) const
+    {
+        YAMA_ASSERT_CRIT(ptr, "Storing yama::vector3_packet_t to nullptr");
+        simd::store3(ptr->data(), x, y, z);
+    }
+
+    void store_lanes(value_type* ox, value_type* oy, value_type* oz) const
+    {
+        x.store(ox);
+        y.store(oy);
+        z.store(oz);
+    }
+
+    vector3_t<T> get(size_type i) const
+    {
+        YAMA_ASSERT_CRIT(i < N, "yama::vector3_packet_t index out of bounds");
+        return vector3_t<T>::coord(x.at(i), y.at(i), z.at(i));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // operators
+
+    const vector3_packet_t& operator+() const
+    {
+        return *this;
+    }
+
+    vector3_packet_t operator-() const
+    {
+        return coord(-x, -y, -z);
+    }
+
+    vector3_packet_t& operator+=(const vector3_packet_t& b)
+    {
+        x = x + b.x;
+        y = y + b.y;
+        z = z + b.z;
+        return *this;
+    }
+
+    vector3_packet_t& operator-=(const vector3_packet_t& b)
+    {
+        x = x - b.x;
+        y = y - b.y;
+        z = z - b.z;
+        return *this;
+    }
+
+    vector3_packet_t& operator*=(const pack& s)
+    {
+        x = x * s;
+        y = y * s;
+        z = z * s;
+        return *this;
+    }
+
+    vector3_packet_t& operator*=(const value_type& s)
+    {
+        return *this *= pack::uniform(s);
+    }
+
+    vector3_packet_t& operator/=(const pack& s)
+    {
+        x = x / s;
+        y = y / s;
+        z = z / s;
+        return *this;
+    }
+
+    vector3_packet_t& operator/=(const value_type& s)
+    {
+        YAMA_ASSERT_WARN(s != 0, "yama::vector3_packet_t division by zero");
+        return *this /= pack::uniform(s);
+    }
+
+    vector3_packet_t& mul(const vector3_packet_t& b)
+    {
+        x = x * b.x;
+        y = y * b.y;
+        z = z * b.z;
+        return *this;
+    }
+
+    vector3_packet_t& div(const vector3_packet_t& b)
+    {
+        x = x / b.x;
+        y = y / b.y;
+        z = z / b.z;
+        return *this;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // vector math
+
+    pack length_sq() const
+    {
+        return fmadd(x, x, fmadd(y, y, z * z));
+    }
+
+    pack length() const
+    {
+        return simd::sqrt(length_sq());
+    }
+
+    pack manhattan_length() const
+    {
+        return simd::abs(x) + simd::abs(y) + simd::abs(z);
+    }
+
+    // returns the lengths
+    // zero-length vectors produce non-finite values
+    pack normalize()
+    {
+        auto l = length();
+        *this *= pack::uniform(1) / l;
+        return l;
+    }
+};
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator+(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator-(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator*(const vector3_packet_t<T, N>& a, const typename vector3_packet_t<T, N>::pack& s)
+{
+    return vector3_packet_t<T, N>::coord(a.x * s, a.y * s, a.z * s);
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator*(const typename vector3_packet_t<T, N>::pack& s, const vector3_packet_t<T, N>& b)
+{
+    return b * s;
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator*(const vector3_packet_t<T, N>& a, const T& s)
+{
+    return a * vector3_packet_t<T, N>::pack::uniform(s);
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator*(const T& s, const vector3_packet_t<T, N>& b)
+{
+    return b * s;
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator/(const vector3_packet_t<T, N>& a, const typename vector3_packet_t<T, N>::pack& s)
+{
+    return vector3_packet_t<T, N>::coord(a.x / s, a.y / s, a.z / s);
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> operator/(const vector3_packet_t<T, N>& a, const T& s)
+{
+    YAMA_ASSERT_WARN(s != 0, "yama::vector3_packet_t division by zero");
+    return a / vector3_packet_t<T, N>::pack::uniform(s);
+}
+
+// true if all N vectors are equal
+template <typename T, size_t N>
+bool operator==(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return mask_bits((a.x == b.x) & (a.y == b.y) & (a.z == b.z)) == (1 << N) - 1;
+}
+
+template <typename T, size_t N>
+bool operator!=(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return !(a == b);
+}
+
+// true if all N vectors are close
+template <typename T, size_t N>
+bool close(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b, const T& epsilon = constants_t<T>::EPSILON)
+{
+    using pack = typename vector3_packet_t<T, N>::pack;
+    const auto e = pack::uniform(epsilon);
+    return mask_bits((abs(a.x - b.x) <= e) & (abs(a.y - b.y) <= e) & (abs(a.z - b.z) <= e)) == (1 << N) - 1;
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> abs(const vector3_packet_t<T, N>& a)
+{
+    return vector3_packet_t<T, N>::coord(abs(a.x), abs(a.y), abs(a.z));
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> mul(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(a.x * b.x, a.y * b.y, a.z * b.z);
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> div(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(a.x / b.x, a.y / b.y, a.z / b.z);
+}
+
+#if !defined(min)
+template <typename T, size_t N>
+vector3_packet_t<T, N> min(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z));
+}
+#endif
+
+#if !defined(max)
+template <typename T, size_t N>
+vector3_packet_t<T, N> max(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z));
+}
+#endif
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> clamp(const vector3_packet_t<T, N>& v, const vector3_packet_t<T, N>& min, const vector3_packet_t<T, N>& max)
+{
+    return vector3_packet_t<T, N>::coord(
+        simd::min(simd::max(v.x, min.x), max.x),
+        simd::min(simd::max(v.y, min.y), max.y),
+        simd::min(simd::max(v.z, min.z), max.z)
+    );
+}
+
+template <typename T, size_t N>
+typename vector3_packet_t<T, N>::pack dot(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return fmadd(a.x, b.x, fmadd(a.y, b.y, a.z * b.z));
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> cross(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(
+        fnmadd(a.z, b.y, a.y * b.z),
+        fnmadd(a.x, b.z, a.z * b.x),
+        fnmadd(a.y, b.x, a.x * b.y)
+    );
+}
+
+template <typename T, size_t N>
+typename vector3_packet_t<T, N>::pack distance_sq(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return (a - b).length_sq();
+}
+
+template <typename T, size_t N>
+typename vector3_packet_t<T, N>::pack distance(const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return (a - b).length();
+}
+
+template <typename T, size_t N>
+vector3_packet_t<T, N> normalize(const vector3_packet_t<T, N>& a)
+{
+    auto ret = a;
+    ret.normalize();
+    return ret;
+}
+
+// vectors from a where the mask is set and from b elsewhere
+template <typename T, size_t N>
+vector3_packet_t<T, N> select(const typename vector3_packet_t<T, N>::pack& mask, const vector3_packet_t<T, N>& a, const vector3_packet_t<T, N>& b)
+{
+    return vector3_packet_t<T, N>::coord(select(mask, a.x, b.x), select(mask, a.y, b.y), select(mask, a.z, b.z));
+}
+
+// the sum of the N vectors
+template <typename T, size_t N>
+vector3_t<T> hsum(const vector3_packet_t<T, N>& a)
+{
+    return vector3_t<T>::coord(hsum(a.x), hsum(a.y), hsum(a.z));
+}
+
+// component-wise minimum of the N vectors
+template <typename T, size_t N>
+vector3_t<T> hmin(const vector3_packet_t<T, N>& a)
+{
+    return vector3_t<T>::coord(hmin(a.x), hmin(a.y), hmin(a.z));
+}
+
+// component-wise maximum of the N vectors
+template <typename T, size_t N>
+vector3_t<T> hmax(const vector3_packet_t<T, N>& a)
+{
+    return vector3_t<T>::coord(hmax(a.x), hmax(a.y), hmax(a.z));
+}
+
+template <typename T>
+using vector3x4_t = vector3_packet_t<T, 4>;
+
+template <typename T>
+using vector3x8_t = vector3_packet_t<T, 8>;
+
+// shorthand
+#if !defined(YAMA_NO_SHORTHAND)
+
+using vector3x4 = vector3x4_t<preferred_type>;
+using vector3x8 = vector3x8_t<preferred_type>;
+
+#endif
+
+}
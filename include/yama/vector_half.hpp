@@ -0,0 +1,84 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstdint>
+
+#include "type_traits.hpp"
+
+#include "dim.hpp"
+#include "simd/half.hpp"
+
+// Vectors of half-precision floats (IEEE 754 binary16) for storage
+//
+// They take half the memory of the float vectors, but have no arithmetic: they are converted
+// to float vectors to work with, and back to store the results (with rounding to the nearest half).
+// Halves have 11 significant bits (about 3 decimal digits) and a range up to 65504.
+
+namespace yama
+{
+
+template <size_t D>
+struct vector_half_t
+{
+    using float_vector = typename dim<D>::template vector_t<float>;
+
+    static constexpr size_t value_count = D;
+
+    uint16_t bits[D]; // the bits of the halves
+
+    static vector_half_t pack(const float_vector& v)
+    {
+        vector_half_t ret;
+        for (size_t i = 0; i < D; ++i) ret.bits[i] = simd::float_to_half(v.at(i));
+        return ret;
+    }
+
+    float_vector unpack() const
+    {
+        float_vector ret;
+        for (size_t i = 0; i < D; ++i) ret.at(i) = simd::half_to_float(bits[i]);
+        return ret;
+    }
+
+    // bitwise, so -0 and 0 are different and NaNs with the same bits are equal
+    bool operator==(const vector_half_t& b) const
+    {
+        for (size_t i = 0; i < D; ++i)
+        {
+            if (bits[i] != b.bits[i]) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const vector_half_t& b) const
+    {
+        return !operator==(b);
+    }
+};
+
+using vector2h = vector_half_t<2>;
+using vector3h = vector_half_t<3>;
+using vector4h = vector_half_t<4>;
+
+// out[i] = vector_half_t<D>::pack(in[i]), with F16C if available
+template <size_t D>
+void pack(const typename dim<D>::template vector_t<float>* in, size_t count, vector_half_t<D>* out)
+{
+    static_assert(sizeof(vector_half_t<D>) == D * sizeof(uint16_t), "yama::vector_half_t must be an array of halves");
+    simd::float_to_half(reinterpret_cast<const float*>(in), D * count, reinterpret_cast<uint16_t*>(out));
+}
+
+// out[i] = in[i].unpack(), with F16C if available
+template <size_t D>
+void unpack(const vector_half_t<D>* in, size_t count, typename dim<D>::template vector_t<float>* out)
+{
+    simd::half_to_float(reinterpret_cast<const uint16_t*>(in), D * count, reinterpret_cast<float*>(out));
+}
+
+// type traits
+template <size_t D>
+struct is_yama<vector_half_t<D>> : public std::true_type {};
+
+}
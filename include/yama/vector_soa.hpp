@@ -0,0 +1,460 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "dim.hpp"
+#include "simd/pack.hpp"
+
+#include <memory>
+#include <new>
+#include <cstring>
+
+// Structure-of-arrays streams of D-dimensional vectors
+//
+// vector_soa_t<3, T> holds separate x, y, and z lanes instead of an array of vector3_t.
+// The lanes are aligned and padded to lane_alignment bytes, so the kernels below
+// process whole packs (8 floats per instruction with AVX) without tails.
+// The values of the padding elements are unspecified.
+
+namespace yama
+{
+
+template <size_t D, typename T>
+class vector_soa_t
+{
+public:
+    static constexpr size_t dimension = D;
+    using value_type = T;
+    using size_type = size_t;
+    using dim_vector = typename dim<D>::template vector_t<T>;
+    using pack = simd::pack_t<T>;
+
+    // a cache line, which is also enough for the widest packs
+    static constexpr size_t lane_alignment = 64;
+    static constexpr size_t lane_granularity = lane_alignment / sizeof(T);
+    static_assert(lane_granularity % pack::width == 0, "yama::vector_soa_t lanes must hold whole packs");
+
+    vector_soa_t() = default;
+
+    explicit vector_soa_t(size_t size)
+    {
+        resize(size);
+    }
+
+    vector_soa_t(const dim_vector* in, size_t count)
+    {
+        assign(in, count);
+    }
+
+    vector_soa_t(const vector_soa_t& other)
+    {
+        *this = other;
+    }
+
+    vector_soa_t& operator=(const vector_soa_t& other)
+    {
+        if (this == &other) return *this;
+        m_size = 0;
+        reserve(other.m_size);
+        // an empty stream may have no lanes at all
+        for (size_t d = 0; d < D && other.m_size; ++d)
+        {
+            std::memcpy(lane(d), other.lane(d), other.m_size * sizeof(T));
+        }
+        m_size = other.m_size;
+        return *this;
+    }
+
+    vector_soa_t(vector_soa_t&& other) noexcept
+    {
+        swap(other);
+    }
+
+    vector_soa_t& operator=(vector_soa_t&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(vector_soa_t& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+    }
+
+    ////////////////////////////////////////////////////////
+    // size
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= m_capacity) return;
+
+        capacity = (capacity + lane_granularity - 1) / lane_granularity * lane_granularity;
+        data_ptr data(static_cast<T*>(::operator new(D * capacity * sizeof(T), std::align_val_t(lane_alignment))));
+        for (size_t d = 0; d < D; ++d)
+        {
+            T* dst = data.get() + d * capacity;
+            if (m_size) std::memcpy(dst, lane(d), m_size * sizeof(T));
+            std::memset(dst + m_size, 0, (capacity - m_size) * sizeof(T));
+        }
+
+        m_data = std::move(data);
+        m_capacity = capacity;
+    }
+
+    // new elements are zero
+    void resize(size_t size)
+    {
+        reserve(size);
+        for (size_t d = 0; d < D; ++d)
+        {
+            for (size_t i = m_size; i < size; ++i) lane(d)[i] = 0;
+        }
+        m_size = size;
+    }
+
+    void clear()
+    {
+        m_size = 0;
+    }
+
+    void push_back(const dim_vector& v)
+    {
+        if (m_size == m_capacity) reserve(m_capacity ? 2 * m_capacity : lane_granularity);
+        ++m_size;
+        set(m_size - 1, v);
+    }
+
+    ////////////////////////////////////////////////////////
+    // access
+
+    T* lane(size_t d)
+    {
+        YAMA_ASSERT_CRIT(d < D, "yama::vector_soa_t lane index out of bounds");
+        return m_data.get() + d * m_capacity;
+    }
+
+    const T* lane(size_t d) const
+    {
+        YAMA_ASSERT_CRIT(d < D, "yama::vector_soa_t lane index out of bounds");
+        return m_data.get() + d * m_capacity;
+    }
+
+    T* x() { return lane(0); }
+    const T* x() const { return lane(0); }
+    T* y() { return lane(1); }
+    const T* y() const { return lane(1); }
+    T* z() { return lane(2); }
+    const T* z() const { return lane(2); }
+    T* w() { return lane(3); }
+    const T* w() const { return lane(3); }
+
+    dim_vector get(size_t i) const
+    {
+        YAMA_ASSERT_CRIT(i < m_size, "yama::vector_soa_t index out of bounds");
+        dim_vector ret;
+        for (size_t d = 0; d < D; ++d) ret.at(d) = lane(d)[i];
+        return ret;
+    }
+
+    void set(size_t i, const dim_vector& v)
+    {
+        YAMA_ASSERT_CRIT(i < m_size, "yama::vector_soa_t index out of bounds");
+        for (size_t d = 0; d < D; ++d) lane(d)[i] = v.at(d);
+    }
+
+    // packs for custom kernels
+    // i must be a multiple of pack::width
+    // everything up to size() rounded up to pack::width is accessible
+    pack load_pack(size_t d, size_t i) const
+    {
+        return pack::load_aligned(lane(d) + i);
+    }
+
+    void store_pack(size_t d, size_t i, const pack& p)
+    {
+        p.store_aligned(lane(d) + i);
+    }
+
+    // the end of the range which is covered by whole packs
+    size_t pack_end() const
+    {
+        return (m_size + pack::width - 1) / pack::width * pack::width;
+    }
+
+    ////////////////////////////////////////////////////////
+    // conversion from and to arrays of vectors
+
+    void assign(const dim_vector* in, size_t count)
+    {
+        m_size = 0;
+        resize(count);
+
+        const T* src = in ? in->data() : nullptr;
+        size_t i = 0;
+        if constexpr (D == 3 || D == 4)
+        {
+            for (; i + pack::width <= count; i += pack::width)
+            {
+                pack l[D];
+                if constexpr (D == 3) simd::load3(src + D * i, l[0], l[1], l[2]);
+                else simd::load4(src + D * i, l[0], l[1], l[2], l[3]);
+                for (size_t d = 0; d < D; ++d) store_pack(d, i, l[d]);
+            }
+        }
+        for (; i < count; ++i)
+        {
+            for (size_t d = 0; d < D; ++d) lane(d)[i] = src[D * i + d];
+        }
+    }
+
+    // in is an array of count * D values
+    void assign(const T* in, size_t count)
+    {
+        assign(count ? dim_vector::attach_to_array(in) : nullptr, count);
+    }
+
+    // out must have room for size() vectors
+    void copy_to(dim_vector* out) const
+    {
+        T* dst = out ? out->data() : nullptr;
+        size_t i = 0;
+        if constexpr (D == 3 || D == 4)
+        {
+            for (; i + pack::width <= m_size; i += pack::width)
+            {
+                pack l[D];
+                for (size_t d = 0; d < D; ++d) l[d] = load_pack(d, i);
+                if constexpr (D == 3) simd::store3(dst + D * i, l[0], l[1], l[2]);
+                else simd::store4(dst + D * i, l[0], l[1], l[2], l[3]);
+            }
+        }
+        for (; i < m_size; ++i)
+        {
+            for (size_t d = 0; d < D; ++d) dst[D * i + d] = lane(d)[i];
+        }
+    }
+
+    // out must have room for size() * D values
+    void copy_to(T* out) const
+    {
+        copy_to(m_size ? dim_vector::attach_to_array(out) : nullptr);
+    }
+
+    ////////////////////////////////////////////////////////
+    // arithmetic
+
+    vector_soa_t& operator+=(const vector_soa_t& b)
+    {
+        YAMA_ASSERT_CRIT(m_size == b.m_size, "yama::vector_soa_t size mismatch");
+        return for_each_pack([&](size_t d, size_t i, pack p) { return p + b.load_pack(d, i); });
+    }
+
+    vector_soa_t& operator-=(const vector_soa_t& b)
+    {
+        YAMA_ASSERT_CRIT(m_size == b.m_size, "yama::vector_soa_t size mismatch");
+        return for_each_pack([&](size_t d, size_t i, pack p) { return p - b.load_pack(d, i); });
+    }
+
+    vector_soa_t& operator+=(const dim_vector& v)
+    {
+        return for_each_pack([&](size_t d, size_t, pack p) { return p + pack::uniform(v.at(d)); });
+    }
+
+    vector_soa_t& operator-=(const dim_vector& v)
+    {
+        return for_each_pack([&](size_t d, size_t, pack p) { return p - pack::uniform(v.at(d)); });
+    }
+
+    vector_soa_t& operator*=(const T& s)
+    {
+        const auto ps = pack::uniform(s);
+        return for_each_pack([&](size_t, size_t, pack p) { return p * ps; });
+    }
+
+    vector_soa_t& operator/=(const T& s)
+    {
+        const auto ps = pack::uniform(s);
+        return for_each_pack([&](size_t, size_t, pack p) { return p / ps; });
+    }
+
+private:
+    template <typename F>
+    vector_soa_t& for_each_pack(F f)
+    {
+        const size_t end = pack_end();
+        for (size_t d = 0; d < D; ++d)
+        {
+            for (size_t i = 0; i < end; i += pack::width)
+            {
+                store_pack(d, i, f(d, i, load_pack(d, i)));
+            }
+        }
+        return *this;
+    }
+
+    struct aligned_delete
+    {
+        void operator()(T* ptr) const
+        {
+            ::operator delete(ptr, std::align_val_t(lane_alignment));
+        }
+    };
+    using data_ptr = std::unique_ptr<T, aligned_delete>;
+
+    data_ptr m_data;
+    size_t m_size = 0;
+    size_t m_capacity = 0; // per lane
+};
+
+namespace impl
+{
+// stores f(i) for each pack of a stream of size elements in the array out
+template <typename P, typename T, typename F>
+void soa_store_values(size_t size, T* out, F f)
+{
+    size_t i = 0;
+    for (; i + P::width <= size; i += P::width)
+    {
+        f(i).store(out + i);
+    }
+
+    if (i == size) return;
+
+    T buf[P::width];
+    f(i).store(buf);
+    std::memcpy(out + i, buf, (size - i) * sizeof(T));
+}
+
+template <size_t D, typename T>
+typename vector_soa_t<D, T>::pack soa_dot(const vector_soa_t<D, T>& a, const vector_soa_t<D, T>& b, size_t i)
+{
+    auto ret = a.load_pack(0, i) * b.load_pack(0, i);
+    for (size_t d = 1; d < D; ++d) ret = fmadd(a.load_pack(d, i), b.load_pack(d, i), ret);
+    return ret;
+}
+}
+
+// the functions below write size() values in the array out
+
+template <size_t D, typename T>
+void dot(const vector_soa_t<D, T>& a, const vector_soa_t<D, T>& b, T* out)
+{
+    YAMA_ASSERT_CRIT(a.size() == b.size(), "yama::vector_soa_t size mismatch");
+    using pack = typename vector_soa_t<D, T>::pack;
+    impl::soa_store_values<pack>(a.size(), out, [&](size_t i) {
+        return impl::soa_dot(a, b, i);
+    });
+}
+
+template <size_t D, typename T>
+void length_sq(const vector_soa_t<D, T>& a, T* out)
+{
+    using pack = typename vector_soa_t<D, T>::pack;
+    impl::soa_store_values<pack>(a.size(), out, [&](size_t i) {
+        return impl::soa_dot(a, a, i);
+    });
+}
+
+template <size_t D, typename T>
+void length(const vector_soa_t<D, T>& a, T* out)
+{
+    using pack = typename vector_soa_t<D, T>::pack;
+    impl::soa_store_values<pack>(a.size(), out, [&](size_t i) {
+        return simd::sqrt(impl::soa_dot(a, a, i));
+    });
+}
+
+template <size_t D, typename T>
+void distance_sq(const vector_soa_t<D, T>& a, const vector_soa_t<D, T>& b, T* out)
+{
+    YAMA_ASSERT_CRIT(a.size() == b.size(), "yama::vector_soa_t size mismatch");
+    using pack = typename vector_soa_t<D, T>::pack;
+    impl::soa_store_values<pack>(a.size(), out, [&](size_t i) {
+        auto v = a.load_pack(0, i) - b.load_pack(0, i);
+        auto ret = v * v;
+        for (size_t d = 1; d < D; ++d)
+        {
+            v = a.load_pack(d, i) - b.load_pack(d, i);
+            ret = fmadd(v, v, ret);
+        }
+        return ret;
+    });
+}
+
+// distances to a single point
+template <size_t D, typename T>
+void distance_sq(const vector_soa_t<D, T>& a, const typename vector_soa_t<D, T>::dim_vector& b, T* out)
+{
+    using pack = typename vector_soa_t<D, T>::pack;
+    pack pb[D];
+    for (size_t d = 0; d < D; ++d) pb[d] = pack::uniform(b.at(d));
+
+    impl::soa_store_values<pack>(a.size(), out, [&](size_t i) {
+        auto v = a.load_pack(0, i) - pb[0];
+        auto ret = v * v;
+        for (size_t d = 1; d < D; ++d)
+        {
+            v = a.load_pack(d, i) - pb[d];
+            ret = fmadd(v, v, ret);
+        }
+        return ret;
+    });
+}
+
+// out is resized to the size of a and may be a or b
+template <typename T>
+void cross(const vector_soa_t<3, T>& a, const vector_soa_t<3, T>& b, vector_soa_t<3, T>& out)
+{
+    YAMA_ASSERT_CRIT(a.size() == b.size(), "yama::vector_soa_t size mismatch");
+    out.resize(a.size());
+    const size_t end = a.pack_end();
+    for (size_t i = 0; i < end; i += vector_soa_t<3, T>::pack::width)
+    {
+        const auto ax = a.load_pack(0, i), ay = a.load_pack(1, i), az = a.load_pack(2, i);
+        const auto bx = b.load_pack(0, i), by = b.load_pack(1, i), bz = b.load_pack(2, i);
+        out.store_pack(0, i, fnmadd(az, by, ay * bz));
+        out.store_pack(1, i, fnmadd(ax, bz, az * bx));
+        out.store_pack(2, i, fnmadd(ay, bx, ax * by));
+    }
+}
+
+// out is resized to the size of a and may be a
+// zero-length vectors produce non-finite values
+template <size_t D, typename T>
+void normalize(const vector_soa_t<D, T>& a, vector_soa_t<D, T>& out)
+{
+    using pack = typename vector_soa_t<D, T>::pack;
+    out.resize(a.size());
+    const size_t end = a.pack_end();
+    const auto one = pack::uniform(1);
+    for (size_t i = 0; i < end; i += pack::width)
+    {
+        const auto rl = one / simd::sqrt(impl::soa_dot(a, a, i));
+        for (size_t d = 0; d < D; ++d) out.store_pack(d, i, a.load_pack(d, i) * rl);
+    }
+}
+
+template <typename T>
+using vector2_soa_t = vector_soa_t<2, T>;
+template <typename T>
+using vector3_soa_t = vector_soa_t<3, T>;
+template <typename T>
+using vector4_soa_t = vector_soa_t<4, T>;
+
+// shorthand
+#if !defined(YAMA_NO_SHORTHAND)
+
+using vector2_soa = vector2_soa_t<preferred_type>;
+using vector3_soa = vector3_soa_t<preferred_type>;
+using vector4_soa = vector4_soa_t<preferred_type>;
+
+#endif
+
+}
@@ -8,3 +8,4 @@
 #include "quaternion.hpp"
 #include "matrix3x4.hpp"
 #include "matrix4x4.hpp"
+#include "dual_quaternion.hpp"
@@ -0,0 +1,57 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+
+using namespace yama;
+
+namespace
+{
+
+template <typename T>
+void box_is_inside(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) { return int(d.boxes[i].is_inside(d.vectors3[(i + 1) & bench::data_mask])); });
+}
+
+template <typename T>
+void box_intersects(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    bench::run(s, [&](size_t i) { return int(b[i].intersects(b[(i + 1) & bench::data_mask])); });
+}
+
+template <typename T>
+void box_merge(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    bench::run(s, [&](size_t i) {
+        auto ret = b[i];
+        ret.merge(b[(i + 1) & bench::data_mask]);
+        return ret;
+    });
+}
+
+template <typename T>
+void box_add_point(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) {
+        auto ret = d.boxes[i];
+        ret.add_point(d.vectors3[i]);
+        return ret;
+    });
+}
+
+}
+
+PICOBENCH_SUITE("boxnt");
+PICOBENCH(box_is_inside<float>);
+PICOBENCH(box_is_inside<double>);
+PICOBENCH(box_intersects<float>);
+PICOBENCH(box_intersects<double>);
+PICOBENCH(box_merge<float>);
+PICOBENCH(box_merge<double>);
+PICOBENCH(box_add_point<float>);
+PICOBENCH(box_add_point<double>);
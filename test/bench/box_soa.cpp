@@ -0,0 +1,104 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/box_soa.hpp"
+
+using namespace yama;
+
+namespace
+{
+
+// one iteration is one box-box test
+template <typename T>
+void box_intersects_loop(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    std::vector<uint32_t> hits(bench::data_size / 32);
+    size_t n = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        const auto& q = b[n++ & bench::data_mask];
+        const size_t count = std::min(bench::data_size, size_t(s.iterations() - done));
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i % 32 == 0) hits[i / 32] = 0;
+            hits[i / 32] |= uint32_t(b[i].intersects(q)) << (i % 32);
+        }
+    }
+    s.set_result(picobench::result_t(hits.front()));
+}
+
+template <typename T>
+void box_soa_intersects(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    box_soa<3, T> soa(b.data(), b.size());
+    std::vector<uint32_t> hits(bench::data_size / 32);
+    size_t n = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        intersects(soa, b[n++ & bench::data_mask], hits.data());
+    }
+    s.set_result(picobench::result_t(hits.front()));
+}
+
+template <typename T>
+void box_soa_intersecting(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    box_soa<3, T> soa(b.data(), b.size());
+    std::vector<uint32_t> indices(bench::data_size);
+    size_t n = 0, found = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        found += intersecting(soa, b[n++ & bench::data_mask], indices.data());
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+// one iteration is one merged box
+template <typename T>
+void box_merge_loop(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    auto ret = boxnt<3, T>::inverted();
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        const size_t count = std::min(bench::data_size, size_t(s.iterations() - done));
+        for (size_t i = 0; i < count; ++i) ret.merge(b[i]);
+    }
+    s.set_result(picobench::result_t(ret.max.x));
+}
+
+template <typename T>
+void box_soa_bounds(picobench::state& s)
+{
+    auto& b = bench::data<T>::get().boxes;
+    box_soa<3, T> soa(b.data(), b.size());
+    T sum = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        sum += bounds(soa).max.x;
+    }
+    s.set_result(picobench::result_t(sum));
+}
+
+}
+
+PICOBENCH_SUITE("box_soa");
+PICOBENCH(box_intersects_loop<float>);
+PICOBENCH(box_intersects_loop<double>);
+PICOBENCH(box_soa_intersects<float>);
+PICOBENCH(box_soa_intersects<double>);
+PICOBENCH(box_soa_intersecting<float>);
+PICOBENCH(box_soa_intersecting<double>);
+PICOBENCH(box_merge_loop<float>);
+PICOBENCH(box_merge_loop<double>);
+PICOBENCH(box_soa_bounds<float>);
+PICOBENCH(box_soa_bounds<double>);
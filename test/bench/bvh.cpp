@@ -0,0 +1,177 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/dynamic_bvh.hpp"
+#include <random>
+
+using namespace yama;
+
+namespace
+{
+
+using box3 = boxnt<3, float>;
+
+// 100k boxes scattered in a cube with a side of 1000
+struct bvh_scene
+{
+    static constexpr size_t count = 100000;
+
+    std::vector<box3> boxes;
+    std::vector<box3> queries;
+    std::vector<vector3> origins, directions;
+    bvh<3, float> tree;
+
+    bvh_scene()
+    {
+        std::minstd_rand rnd(11);
+        std::uniform_real_distribution<float> pos(0, 1000), size(0.5f, 5), dir(-1, 1);
+        auto rand_vec = [&](std::uniform_real_distribution<float>& d) { return v(d(rnd), d(rnd), d(rnd)); };
+
+        for (size_t i = 0; i < count; ++i) boxes.push_back(box3::pos_size(rand_vec(pos), rand_vec(size)));
+        for (size_t i = 0; i < bench::data_size; ++i)
+        {
+            queries.push_back(box3::pos_size(rand_vec(pos), rand_vec(size) * 4.f));
+            origins.push_back(rand_vec(pos));
+            directions.push_back(normalize(rand_vec(dir)));
+        }
+        tree.build(boxes.data(), boxes.size());
+    }
+
+    static const bvh_scene& get()
+    {
+        static bvh_scene s;
+        return s;
+    }
+};
+
+// one iteration is one item
+void bvh_build(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    bvh<3, float> tree;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bvh_scene::count))
+    {
+        tree.build(d.boxes.data(), std::min(bvh_scene::count, size_t(s.iterations() - done)));
+    }
+    s.set_result(picobench::result_t(tree.depth()));
+}
+
+// one iteration is one query
+void box_query_brute(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    size_t found = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        auto& q = d.queries[size_t(i) & bench::data_mask];
+        for (auto& b : d.boxes) found += b.intersects(q);
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+void box_query_bvh(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    size_t found = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        d.tree.query(d.queries[size_t(i) & bench::data_mask], [&](size_t) { ++found; });
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+void closest_hit_bvh(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    size_t found = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        const auto j = size_t(i) & bench::data_mask;
+        const auto& o = d.origins[j];
+        const auto inv = div(vector3::uniform(1), d.directions[j]);
+        d.tree.query_ray(o, d.directions[j], 2000.f, [&](size_t index, float& max_t) {
+            float t;
+            if (impl::ray_hits(d.boxes[index], o, inv, max_t, t)) max_t = t;
+            ++found;
+        });
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+// one iteration is a refit of all items
+void bvh_refit(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    auto tree = d.tree;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        (void)i;
+        tree.refit(d.boxes.data());
+    }
+    s.set_result(picobench::result_t(tree.bounds().min.x));
+}
+
+// one iteration is one item
+void dynamic_bvh_insert(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    dynamic_bvh<3, float> tree;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        tree.insert(d.boxes[size_t(i) % bvh_scene::count]);
+    }
+    s.set_result(picobench::result_t(tree.height()));
+}
+
+// a frame of small moves: one iteration is one item, most of which stay in their fat boxes
+void dynamic_bvh_update(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    dynamic_bvh<3, float> tree(0.5f);
+    std::vector<uint32_t> ids;
+    for (auto& b : d.boxes) ids.push_back(tree.insert(b));
+    auto boxes = d.boxes;
+    size_t reinserted = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        const auto j = size_t(i) % bvh_scene::count;
+        const auto move = d.directions[j & bench::data_mask] * 0.1f;
+        boxes[j] = boxes[j] + move;
+        reinserted += tree.update(ids[j], boxes[j], move);
+    }
+    s.set_result(picobench::result_t(reinserted));
+}
+
+void box_query_dynamic_bvh(picobench::state& s)
+{
+    auto& d = bvh_scene::get();
+    dynamic_bvh<3, float> tree;
+    for (auto& b : d.boxes) tree.insert(b);
+    size_t found = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        tree.query(d.queries[size_t(i) & bench::data_mask], [&](size_t) { ++found; });
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+}
+
+PICOBENCH_SUITE("bvh");
+PICOBENCH(bvh_build);
+PICOBENCH(box_query_brute).iterations({64, 256});
+PICOBENCH(box_query_bvh);
+PICOBENCH(closest_hit_bvh);
+PICOBENCH(bvh_refit).iterations({16, 64});
+PICOBENCH(dynamic_bvh_insert);
+PICOBENCH(dynamic_bvh_update);
+PICOBENCH(box_query_dynamic_bvh);
@@ -0,0 +1,79 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "yama/yama.hpp"
+#include "yama/box.hpp"
+#include <picobench/picobench.hpp>
+#include <vector>
+#include <random>
+
+// Shared inputs for the benchmarks
+//
+// The translation units don't define YAMA_SIMD, so the regular operators are scalar.
+// The SIMD kernels are benchmarked explicitly.
+
+namespace bench
+{
+
+// a power of two, so that the benchmarks can wrap around with a mask
+constexpr size_t data_size = 1024;
+constexpr size_t data_mask = data_size - 1;
+
+// random values of a given precision
+// the same seed is used for all, so float and double get the same inputs
+template <typename T>
+struct data
+{
+    std::vector<yama::vector3_t<T>> vectors3;
+    std::vector<yama::vector4_t<T>> vectors4;
+    std::vector<yama::quaternion_t<T>> quaternions;
+    std::vector<yama::matrix4x4_t<T>> matrices; // affine (translation, rotation, scaling)
+    std::vector<yama::boxnt<3, T>> boxes;
+
+    static const data& get()
+    {
+        static data d;
+        return d;
+    }
+
+private:
+    data()
+    {
+        std::minstd_rand rnd(42);
+        std::uniform_real_distribution<T> d(-1, 1);
+        auto v3 = [&]() { return yama::vector3_t<T>::coord(d(rnd), d(rnd), d(rnd)); };
+
+        for (size_t i = 0; i < data_size; ++i)
+        {
+            vectors3.push_back(v3() * T(10));
+            vectors4.push_back(yama::vector4_t<T>::coord(d(rnd), d(rnd), d(rnd), d(rnd)));
+            quaternions.push_back(yama::quaternion_t<T>::rotation_axis(v3(), d(rnd) * yama::constants_t<T>::PI));
+            matrices.push_back(yama::matrix4x4_t<T>::translation(v3())
+                * yama::matrix4x4_t<T>::rotation_quaternion(quaternions.back())
+                * yama::matrix4x4_t<T>::scaling_uniform(2 + d(rnd)));
+
+            auto p = v3() * T(10);
+            boxes.push_back(yama::boxnt<3, T>::pos_size(p, yama::abs(v3()) + yama::vector3_t<T>::uniform(T(0.5))));
+        }
+    }
+};
+
+// stores f(i) for each iteration, where i wraps around data_size
+// storing the results keeps the optimizer from discarding the work without
+// adding a dependency between the iterations
+template <typename F>
+void run(picobench::state& s, F f)
+{
+    using result = decltype(f(size_t(0)));
+    std::vector<result> out(data_size);
+    for (auto i : s)
+    {
+        const size_t j = size_t(i) & data_mask;
+        out[j] = f(j);
+    }
+    s.set_result(picobench::result_t(out[size_t(s.iterations() - 1) & data_mask] == out[0]));
+}
+
+}
@@ -0,0 +1,92 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/frustum.hpp"
+
+using namespace yama;
+
+namespace
+{
+
+// a camera at the origin looking down +z at the boxes of the data (about a fifth of them are visible)
+template <typename T>
+struct cull_data
+{
+    frustum_t<T> f;
+    std::vector<vector3_t<T>> centers;
+    std::vector<T> radii;
+    std::vector<uint32_t> hits;
+    std::vector<uint8_t> hints;
+
+    cull_data()
+    {
+        const auto view = matrix4x4_t<T>::look_at_lh(vector3_t<T>::zero(), vector3_t<T>::unit_z(), vector3_t<T>::unit_y());
+        f = frustum_t<T>::from_matrix(matrix4x4_t<T>::perspective_fov_lh(1, 1, T(0.1), 100) * view);
+        for (auto& b : bench::data<T>::get().boxes)
+        {
+            centers.push_back(b.center());
+            radii.push_back(b.size().length() / 2);
+        }
+        hits.resize(bench::data_size / 32);
+        hints.resize(bench::data_size);
+    }
+};
+
+// one iteration is one object
+template <typename T>
+void frustum_spheres_scalar(picobench::state& s)
+{
+    cull_data<T> c;
+    bench::run(s, [&](size_t i) { return int(c.f.intersects(c.centers[i], c.radii[i])); });
+}
+
+template <typename T>
+void frustum_boxes_scalar(picobench::state& s)
+{
+    cull_data<T> c;
+    auto& b = bench::data<T>::get().boxes;
+    bench::run(s, [&](size_t i) { return int(c.f.intersects(b[i])); });
+}
+
+template <typename T, bool Hints>
+void frustum_spheres_batch(picobench::state& s)
+{
+    cull_data<T> c;
+    // the hints of a static camera: they were set by the previous frame
+    if (Hints) intersects(c.f, c.centers.data(), c.radii.data(), bench::data_size, c.hits.data(), c.hints.data());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        intersects(c.f, c.centers.data(), c.radii.data(), std::min(bench::data_size, size_t(s.iterations() - done)), c.hits.data(), Hints ? c.hints.data() : nullptr);
+    }
+    s.set_result(picobench::result_t(c.hits.front()));
+}
+
+template <typename T, bool Hints>
+void frustum_boxes_batch(picobench::state& s)
+{
+    cull_data<T> c;
+    auto& b = bench::data<T>::get().boxes;
+    // the hints of a static camera: they were set by the previous frame
+    if (Hints) intersects(c.f, b.data(), bench::data_size, c.hits.data(), c.hints.data());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        intersects(c.f, b.data(), std::min(bench::data_size, size_t(s.iterations() - done)), c.hits.data(), Hints ? c.hints.data() : nullptr);
+    }
+    s.set_result(picobench::result_t(c.hits.front()));
+}
+
+}
+
+PICOBENCH_SUITE("frustum");
+PICOBENCH(frustum_spheres_scalar<float>);
+PICOBENCH(frustum_spheres_scalar<double>);
+PICOBENCH(frustum_boxes_scalar<float>);
+PICOBENCH(frustum_boxes_scalar<double>);
+PICOBENCH((frustum_spheres_batch<float, false>));
+PICOBENCH((frustum_spheres_batch<float, true>));
+PICOBENCH((frustum_boxes_batch<float, false>));
+PICOBENCH((frustum_boxes_batch<float, true>));
+PICOBENCH((frustum_boxes_batch<double, true>));
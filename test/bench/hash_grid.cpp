@@ -0,0 +1,80 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/hash_grid.hpp"
+#include <random>
+
+using namespace yama;
+
+namespace
+{
+
+// 100k points in a cube with a side of 100 (about one in every cell)
+struct grid_scene
+{
+    static constexpr size_t count = 100000;
+
+    std::vector<vector3> points;
+    hash_grid<float> grid;
+
+    grid_scene()
+    {
+        std::minstd_rand rnd(19);
+        std::uniform_real_distribution<float> pos(0, 100);
+        for (size_t i = 0; i < count; ++i) points.push_back(v(pos(rnd), pos(rnd), pos(rnd)));
+        grid.build(points.data(), count, 1);
+    }
+
+    static const grid_scene& get()
+    {
+        static grid_scene s;
+        return s;
+    }
+};
+
+// one iteration is one point
+void hash_grid_build(picobench::state& s)
+{
+    auto& d = grid_scene::get();
+    hash_grid<float> grid;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(grid_scene::count))
+    {
+        grid.build(d.points.data(), std::min(grid_scene::count, size_t(s.iterations() - done)), 1);
+    }
+    s.set_result(picobench::result_t(grid.buckets()));
+}
+
+// one iteration is one query for the neighbors of a point within a radius of 1
+void radius_query_brute(picobench::state& s)
+{
+    auto& d = grid_scene::get();
+    size_t found = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        auto& c = d.points[size_t(i) % grid_scene::count];
+        for (auto& p : d.points) found += distance_sq(p, c) <= 1;
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+void radius_query_grid(picobench::state& s)
+{
+    auto& d = grid_scene::get();
+    size_t found = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        d.grid.query_radius(d.points[size_t(i) % grid_scene::count], 1, [&](uint32_t, float) { ++found; });
+    }
+    s.set_result(picobench::result_t(found));
+}
+
+}
+
+PICOBENCH_SUITE("hash_grid");
+PICOBENCH(hash_grid_build).iterations({100000, 400000});
+PICOBENCH(radius_query_brute).iterations({100, 1000});
+PICOBENCH(radius_query_grid);
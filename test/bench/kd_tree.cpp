@@ -0,0 +1,109 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/kd_tree.hpp"
+#include <random>
+
+using namespace yama;
+
+namespace
+{
+
+// 100k points in a cube with a side of 100
+struct kd_scene
+{
+    static constexpr size_t count = 100000;
+
+    std::vector<vector3> points;
+    std::vector<vector3> queries;
+    kd_tree<3, float> tree;
+
+    kd_scene()
+    {
+        std::minstd_rand rnd(29);
+        std::uniform_real_distribution<float> pos(0, 100);
+        for (size_t i = 0; i < count; ++i) points.push_back(v(pos(rnd), pos(rnd), pos(rnd)));
+        for (size_t i = 0; i < bench::data_size; ++i) queries.push_back(v(pos(rnd), pos(rnd), pos(rnd)));
+        tree.build(points.data(), count);
+    }
+
+    static const kd_scene& get()
+    {
+        static kd_scene s;
+        return s;
+    }
+};
+
+// one iteration is one point
+void kd_tree_build(picobench::state& s)
+{
+    auto& d = kd_scene::get();
+    kd_tree<3, float> tree;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(kd_scene::count))
+    {
+        tree.build(d.points.data(), std::min(kd_scene::count, size_t(s.iterations() - done)));
+    }
+    s.set_result(picobench::result_t(tree.depth()));
+}
+
+// one iteration is one query
+void nearest_brute(picobench::state& s)
+{
+    auto& d = kd_scene::get();
+    size_t sum = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        auto& q = d.queries[size_t(i) & bench::data_mask];
+        float best = std::numeric_limits<float>::max();
+        size_t index = 0;
+        for (size_t j = 0; j < d.points.size(); ++j)
+        {
+            const float d2 = distance_sq(d.points[j], q);
+            if (d2 < best)
+            {
+                best = d2;
+                index = j;
+            }
+        }
+        sum += index;
+    }
+    s.set_result(picobench::result_t(sum));
+}
+
+void nearest_kd_tree(picobench::state& s)
+{
+    auto& d = kd_scene::get();
+    size_t sum = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        sum += d.tree.nearest(d.queries[size_t(i) & bench::data_mask]);
+    }
+    s.set_result(picobench::result_t(sum));
+}
+
+void nearest_8_kd_tree(picobench::state& s)
+{
+    auto& d = kd_scene::get();
+    uint32_t indices[8];
+    float distances[8];
+    size_t sum = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        sum += d.tree.nearest_k(d.queries[size_t(i) & bench::data_mask], 8, indices, distances);
+        sum += indices[7];
+    }
+    s.set_result(picobench::result_t(sum));
+}
+
+}
+
+PICOBENCH_SUITE("kd_tree");
+PICOBENCH(kd_tree_build).iterations({100000, 400000});
+PICOBENCH(nearest_brute).iterations({100, 1000});
+PICOBENCH(nearest_kd_tree);
+PICOBENCH(nearest_8_kd_tree);
@@ -0,0 +1,136 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include <algorithm>
+
+// Configure with native instruction sets (say -march=native) to also get the AVX variants
+
+using namespace yama;
+
+namespace
+{
+
+template <typename T>
+void matrix4x4_mul(picobench::state& s)
+{
+    auto& m = bench::data<T>::get().matrices;
+    bench::run(s, [&](size_t i) { return m[i] * m[(i + 1) & bench::data_mask]; });
+}
+
+#if YAMA_SIMD_SSE
+void matrix4x4_mul_sse(picobench::state& s)
+{
+    auto& m = bench::data<float>::get().matrices;
+    bench::run(s, [&](size_t i) {
+        matrix4x4_t<float> ret;
+        simd::matrix4x4_mul_sse(ret.data(), m[i].data(), m[(i + 1) & bench::data_mask].data());
+        return ret;
+    });
+}
+#endif
+
+#if YAMA_SIMD_AVX
+void matrix4x4_mul_avx(picobench::state& s)
+{
+    auto& m = bench::data<float>::get().matrices;
+    bench::run(s, [&](size_t i) {
+        matrix4x4_t<float> ret;
+        simd::matrix4x4_mul_avx(ret.data(), m[i].data(), m[(i + 1) & bench::data_mask].data());
+        return ret;
+    });
+}
+#endif
+
+template <typename T>
+void matrix4x4_determinant(picobench::state& s)
+{
+    auto& m = bench::data<T>::get().matrices;
+    bench::run(s, [&](size_t i) { return m[i].determinant(); });
+}
+
+#if YAMA_SIMD_SSE
+void matrix4x4_determinant_sse(picobench::state& s)
+{
+    auto& m = bench::data<float>::get().matrices;
+    bench::run(s, [&](size_t i) { return simd::matrix4x4_determinant_sse(m[i].data()); });
+}
+#endif
+
+template <typename T>
+void matrix4x4_inverse(picobench::state& s)
+{
+    auto& m = bench::data<T>::get().matrices;
+    bench::run(s, [&](size_t i) { return inverse(m[i]); });
+}
+
+template <typename T>
+void matrix4x4_inverse_affine(picobench::state& s)
+{
+    auto& m = bench::data<T>::get().matrices;
+    bench::run(s, [&](size_t i) { return inverse_affine(m[i]); });
+}
+
+template <typename T>
+void matrix4x4_inverse_rigid(picobench::state& s)
+{
+    auto& m = bench::data<T>::get().matrices;
+    bench::run(s, [&](size_t i) { return inverse_rigid(m[i]); });
+}
+
+#if YAMA_SIMD_SSE
+void matrix4x4_inverse_sse(picobench::state& s)
+{
+    auto& m = bench::data<float>::get().matrices;
+    bench::run(s, [&](size_t i) {
+        matrix4x4_t<float> ret;
+        simd::matrix4x4_inverse_sse(ret.data(), m[i].data());
+        return ret;
+    });
+}
+
+// the bulk inversion (two matrices per iteration with AVX)
+void matrix4x4_inverse_bulk(picobench::state& s)
+{
+    auto& m = bench::data<float>::get().matrices;
+    std::vector<matrix4x4_t<float>> out(m.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(m.size()))
+    {
+        const size_t count = std::min(m.size(), size_t(s.iterations() - done));
+        simd::matrix4x4_inverse(out.data()->data(), m.data()->data(), count);
+    }
+    s.set_result(picobench::result_t(out.back().m03));
+}
+#endif
+
+}
+
+PICOBENCH_SUITE("matrix4x4 mul");
+PICOBENCH(matrix4x4_mul<float>);
+PICOBENCH(matrix4x4_mul<double>);
+#if YAMA_SIMD_SSE
+PICOBENCH(matrix4x4_mul_sse);
+#endif
+#if YAMA_SIMD_AVX
+PICOBENCH(matrix4x4_mul_avx);
+#endif
+
+PICOBENCH_SUITE("matrix4x4 determinant");
+PICOBENCH(matrix4x4_determinant<float>);
+PICOBENCH(matrix4x4_determinant<double>);
+#if YAMA_SIMD_SSE
+PICOBENCH(matrix4x4_determinant_sse);
+#endif
+
+PICOBENCH_SUITE("matrix4x4 inverse");
+PICOBENCH(matrix4x4_inverse<float>);
+PICOBENCH(matrix4x4_inverse<double>);
+PICOBENCH(matrix4x4_inverse_affine<float>);
+PICOBENCH(matrix4x4_inverse_affine<double>);
+PICOBENCH(matrix4x4_inverse_rigid<float>);
+PICOBENCH(matrix4x4_inverse_rigid<double>);
+#if YAMA_SIMD_SSE
+PICOBENCH(matrix4x4_inverse_sse);
+PICOBENCH(matrix4x4_inverse_bulk);
+#endif
@@ -0,0 +1,97 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/packed_normal.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+const std::vector<vector3_t<float>>& normals()
+{
+    static std::vector<vector3_t<float>> ret = []() {
+        std::vector<vector3_t<float>> n;
+        for (auto& v : bench::data<float>::get().vectors3) n.push_back(normalize(v));
+        return n;
+    }();
+    return ret;
+}
+
+// one iteration is one vector
+template <int Bits>
+void packed_normal_pack(picobench::state& s)
+{
+    auto& n = normals();
+    bench::run(s, [&](size_t i) { return packed_normal_t<Bits>::pack(n[i]).x; });
+}
+
+template <int Bits>
+void packed_normal_pack_precise(picobench::state& s)
+{
+    auto& n = normals();
+    bench::run(s, [&](size_t i) { return packed_normal_t<Bits>::pack_precise(n[i]).x; });
+}
+
+template <int Bits>
+void packed_normal_unpack(picobench::state& s)
+{
+    auto& n = normals();
+    std::vector<packed_normal_t<Bits>> p(n.size());
+    pack(n.data(), n.size(), p.data());
+    bench::run(s, [&](size_t i) { return p[i].unpack(); });
+}
+
+// Batch is pack, pack_precise or unpack over arrays
+template <int Bits, typename Batch>
+void batch_bench(picobench::state& s, Batch batch)
+{
+    auto& n = normals();
+    std::vector<packed_normal_t<Bits>> p(n.size());
+    pack(n.data(), n.size(), p.data());
+    std::vector<vector3_t<float>> out(n.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(n.size()))
+    {
+        batch(n.data(), std::min(n.size(), size_t(s.iterations() - done)), p.data(), out.data());
+    }
+    s.set_result(picobench::result_t(p.front().x + out.front().x));
+}
+
+template <int Bits>
+void packed_normal_pack_batch(picobench::state& s)
+{
+    batch_bench<Bits>(s, [](const vector3_t<float>* n, size_t count, packed_normal_t<Bits>* p, vector3_t<float>*) {
+        pack(n, count, p);
+    });
+}
+
+template <int Bits>
+void packed_normal_pack_precise_batch(picobench::state& s)
+{
+    batch_bench<Bits>(s, [](const vector3_t<float>* n, size_t count, packed_normal_t<Bits>* p, vector3_t<float>*) {
+        pack_precise(n, count, p);
+    });
+}
+
+template <int Bits>
+void packed_normal_unpack_batch(picobench::state& s)
+{
+    batch_bench<Bits>(s, [](const vector3_t<float>*, size_t count, packed_normal_t<Bits>* p, vector3_t<float>* out) {
+        unpack(p, count, out);
+    });
+}
+
+}
+
+PICOBENCH_SUITE("packed_normal");
+PICOBENCH(packed_normal_pack<16>);
+PICOBENCH(packed_normal_pack_precise<16>);
+PICOBENCH(packed_normal_unpack<16>);
+PICOBENCH(packed_normal_pack_batch<16>);
+PICOBENCH(packed_normal_pack_batch<32>);
+PICOBENCH(packed_normal_pack_precise_batch<16>);
+PICOBENCH(packed_normal_unpack_batch<16>);
+PICOBENCH(packed_normal_unpack_batch<32>);
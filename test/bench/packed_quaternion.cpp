@@ -0,0 +1,68 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/packed_quaternion.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+// one iteration is one quaternion
+template <int Bits>
+void packed_quaternion_pack(picobench::state& s)
+{
+    auto& q = bench::data<float>::get().quaternions;
+    bench::run(s, [&](size_t i) { return packed_quaternion_t<Bits>::pack(q[i]).words[0]; });
+}
+
+template <int Bits>
+void packed_quaternion_unpack(picobench::state& s)
+{
+    auto& q = bench::data<float>::get().quaternions;
+    std::vector<packed_quaternion_t<Bits>> p(q.size());
+    pack(q.data(), q.size(), p.data());
+    bench::run(s, [&](size_t i) { return p[i].unpack(); });
+}
+
+template <int Bits>
+void packed_quaternion_pack_batch(picobench::state& s)
+{
+    auto& q = bench::data<float>::get().quaternions;
+    std::vector<packed_quaternion_t<Bits>> out(q.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(q.size()))
+    {
+        pack(q.data(), std::min(q.size(), size_t(s.iterations() - done)), out.data());
+    }
+    s.set_result(picobench::result_t(out.front().words[0]));
+}
+
+template <int Bits>
+void packed_quaternion_unpack_batch(picobench::state& s)
+{
+    auto& q = bench::data<float>::get().quaternions;
+    std::vector<packed_quaternion_t<Bits>> p(q.size());
+    pack(q.data(), q.size(), p.data());
+    std::vector<quaternion_t<float>> out(q.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(q.size()))
+    {
+        unpack(p.data(), std::min(q.size(), size_t(s.iterations() - done)), out.data());
+    }
+    s.set_result(picobench::result_t(out.front().x));
+}
+
+}
+
+PICOBENCH_SUITE("packed_quaternion");
+PICOBENCH(packed_quaternion_pack<32>);
+PICOBENCH(packed_quaternion_pack<48>);
+PICOBENCH(packed_quaternion_pack_batch<32>);
+PICOBENCH(packed_quaternion_pack_batch<48>);
+PICOBENCH(packed_quaternion_unpack<32>);
+PICOBENCH(packed_quaternion_unpack<48>);
+PICOBENCH(packed_quaternion_unpack_batch<32>);
+PICOBENCH(packed_quaternion_unpack_batch<48>);
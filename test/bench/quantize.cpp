@@ -0,0 +1,79 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/quantize.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace yama;
+
+namespace
+{
+
+boxnt<3, float> bounds(const std::vector<vector3_t<float>>& v)
+{
+    auto ret = boxnt<3, float>::inverted();
+    for (auto& p : v) ret.add_point(p);
+    return ret;
+}
+
+// one iteration is one vector3
+void quantize_scalar(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    const auto b = bounds(v);
+    const auto size = b.size();
+    const auto scale = vector3_t<float>::coord(65535 / size.x, 65535 / size.y, 65535 / size.z);
+    std::vector<uint16_t> out(3 * v.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(v.size()))
+    {
+        const size_t count = std::min(v.size(), size_t(s.iterations() - done));
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const float q = std::fmin(std::fmax((v[i][k] - b.min[k]) * scale[k], 0.f), 65535.f);
+                out[3 * i + k] = uint16_t(std::nearbyint(q));
+            }
+        }
+    }
+    s.set_result(picobench::result_t(out.front()));
+}
+
+void quantize_batch(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    const auto b = bounds(v);
+    std::vector<uint16_t> out(3 * v.size());
+    picobench::scope time(s);
+    float error = 0;
+    for (int done = 0; done < s.iterations(); done += int(v.size()))
+    {
+        error += quantize(b, v.data(), std::min(v.size(), size_t(s.iterations() - done)), out.data()).x;
+    }
+    s.set_result(picobench::result_t(out.front() + error));
+}
+
+void dequantize_batch(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    const auto b = bounds(v);
+    std::vector<uint16_t> q(3 * v.size());
+    quantize(b, v.data(), v.size(), q.data());
+    std::vector<vector3_t<float>> out(v.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(v.size()))
+    {
+        dequantize(b, q.data(), std::min(v.size(), size_t(s.iterations() - done)), out.data());
+    }
+    s.set_result(picobench::result_t(out.front().x));
+}
+
+}
+
+PICOBENCH_SUITE("quantize");
+PICOBENCH(quantize_scalar);
+PICOBENCH(quantize_batch);
+PICOBENCH(dequantize_batch);
@@ -0,0 +1,142 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+template <typename T>
+void quaternion_mul(picobench::state& s)
+{
+    auto& q = bench::data<T>::get().quaternions;
+    bench::run(s, [&](size_t i) { return q[i] * q[(i + 1) & bench::data_mask]; });
+}
+
+template <typename T>
+void quaternion_slerp(picobench::state& s)
+{
+    auto& q = bench::data<T>::get().quaternions;
+    bench::run(s, [&](size_t i) { return slerp(q[i], q[(i + 1) & bench::data_mask], T(0.3)); });
+}
+
+// batch interpolation: one iteration is one quaternion
+template <typename T, typename Interpolate>
+void batch_bench(picobench::state& s, Interpolate interpolate)
+{
+    auto& q = bench::data<T>::get().quaternions;
+    std::vector<quaternion_t<T>> out(q.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(q.size()))
+    {
+        const size_t count = std::min(q.size() - 1, size_t(s.iterations() - done));
+        interpolate(q.data(), q.data() + 1, count, out.data());
+    }
+    s.set_result(picobench::result_t(out.front().x));
+}
+
+template <typename T>
+void quaternion_slerp_batch(picobench::state& s)
+{
+    batch_bench<T>(s, [](const quaternion_t<T>* a, const quaternion_t<T>* b, size_t count, quaternion_t<T>* out) {
+        slerp(a, b, count, T(0.3), out);
+    });
+}
+
+template <typename T>
+void quaternion_nlerp_batch(picobench::state& s)
+{
+    batch_bench<T>(s, [](const quaternion_t<T>* a, const quaternion_t<T>* b, size_t count, quaternion_t<T>* out) {
+        nlerp(a, b, count, T(0.3), out);
+    });
+}
+
+template <typename T>
+void quaternion_rotate(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) { return rotate(d.vectors3[i], d.quaternions[i]); });
+}
+
+template <typename T>
+void quaternion_to_matrix(picobench::state& s)
+{
+    auto& q = bench::data<T>::get().quaternions;
+    bench::run(s, [&](size_t i) { return matrix4x4_t<T>::rotation_quaternion(q[i]); });
+}
+
+// batch kernels: one iteration is one element
+template <typename T, typename Out, typename F>
+void batch_bench_n(picobench::state& s, F f)
+{
+    std::vector<Out> out(bench::data_size);
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        f(std::min(bench::data_size, size_t(s.iterations() - done)), out.data());
+    }
+    s.set_result(picobench::result_t(*out.front().data()));
+}
+
+template <typename T>
+void quaternion_rotate_batch(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    batch_bench_n<T, vector3_t<T>>(s, [&](size_t count, vector3_t<T>* out) {
+        rotate(d.vectors3.data(), count, d.quaternions.front(), out);
+    });
+}
+
+template <typename T>
+void quaternion_rotate_each_batch(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    batch_bench_n<T, vector3_t<T>>(s, [&](size_t count, vector3_t<T>* out) {
+        rotate(d.vectors3.data(), count, d.quaternions.data(), out);
+    });
+}
+
+template <typename T>
+void quaternion_to_matrix3x4(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) {
+        return matrix3x4_t<T>::translation_rotation_scaling(d.vectors3[i], d.quaternions[i], d.vectors3[(i + 1) & bench::data_mask]);
+    });
+}
+
+template <typename T>
+void quaternion_to_matrix3x4_batch(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    batch_bench_n<T, matrix3x4_t<T>>(s, [&](size_t count, matrix3x4_t<T>* out) {
+        translation_rotation_scaling(d.vectors3.data(), d.quaternions.data(), d.vectors3.data(), count, out);
+    });
+}
+
+}
+
+PICOBENCH_SUITE("quaternion");
+PICOBENCH(quaternion_mul<float>);
+PICOBENCH(quaternion_mul<double>);
+PICOBENCH(quaternion_slerp<float>);
+PICOBENCH(quaternion_slerp<double>);
+PICOBENCH(quaternion_slerp_batch<float>);
+PICOBENCH(quaternion_slerp_batch<double>);
+PICOBENCH(quaternion_nlerp_batch<float>);
+PICOBENCH(quaternion_nlerp_batch<double>);
+PICOBENCH(quaternion_rotate<float>);
+PICOBENCH(quaternion_rotate<double>);
+PICOBENCH(quaternion_rotate_batch<float>);
+PICOBENCH(quaternion_rotate_batch<double>);
+PICOBENCH(quaternion_rotate_each_batch<float>);
+PICOBENCH(quaternion_rotate_each_batch<double>);
+PICOBENCH(quaternion_to_matrix<float>);
+PICOBENCH(quaternion_to_matrix<double>);
+PICOBENCH(quaternion_to_matrix3x4<float>);
+PICOBENCH(quaternion_to_matrix3x4<double>);
+PICOBENCH(quaternion_to_matrix3x4_batch<float>);
+PICOBENCH(quaternion_to_matrix3x4_batch<double>);
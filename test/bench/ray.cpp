@@ -0,0 +1,83 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/ray.hpp"
+
+using namespace yama;
+
+namespace
+{
+
+// one iteration is one ray-box test
+template <typename T>
+struct ray_data
+{
+    std::vector<ray_t<T>> rays;
+    std::vector<vector3_t<T>> origins, inv_directions;
+    std::vector<uint32_t> hits;
+    std::vector<T> t_enter;
+
+    ray_data()
+    {
+        auto& d = bench::data<T>::get();
+        for (size_t i = 0; i < bench::data_size; ++i)
+        {
+            rays.push_back(ray_t<T>::origin_direction(d.vectors3[i], d.vectors3[(i + 7) & bench::data_mask]));
+            origins.push_back(rays.back().origin);
+            inv_directions.push_back(rays.back().inv_direction);
+        }
+        hits.resize(bench::data_size / 32);
+        t_enter.resize(bench::data_size);
+    }
+};
+
+template <typename T>
+void ray_box_intersects(picobench::state& s)
+{
+    ray_data<T> r;
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) {
+        T t;
+        return r.rays[i].intersects(d.boxes[(i + 1) & bench::data_mask], T(20), t) ? t : T(-1);
+    });
+}
+
+template <typename T>
+void ray_boxes_batch(picobench::state& s)
+{
+    ray_data<T> r;
+    auto& d = bench::data<T>::get();
+    size_t n = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        intersects(r.rays[n++ & bench::data_mask], d.boxes.data(), std::min(bench::data_size, size_t(s.iterations() - done)), T(20), r.hits.data(), r.t_enter.data());
+    }
+    s.set_result(picobench::result_t(r.hits.front()));
+}
+
+template <typename T>
+void rays_box_batch(picobench::state& s)
+{
+    ray_data<T> r;
+    auto& d = bench::data<T>::get();
+    size_t n = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        intersects(r.origins.data(), r.inv_directions.data(), std::min(bench::data_size, size_t(s.iterations() - done)),
+            d.boxes[n++ & bench::data_mask], T(20), r.hits.data(), r.t_enter.data());
+    }
+    s.set_result(picobench::result_t(r.hits.front()));
+}
+
+}
+
+PICOBENCH_SUITE("ray");
+PICOBENCH(ray_box_intersects<float>);
+PICOBENCH(ray_box_intersects<double>);
+PICOBENCH(ray_boxes_batch<float>);
+PICOBENCH(ray_boxes_batch<double>);
+PICOBENCH(rays_box_batch<float>);
+PICOBENCH(rays_box_batch<double>);
@@ -0,0 +1,126 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/skinning.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+// one iteration is one vertex (position and normal)
+template <size_t Influences, typename T>
+struct skin_data
+{
+    static constexpr size_t bones = 64;
+
+    std::vector<matrix3x4_t<T>> palette;
+    std::vector<dual_quaternion_t<T>> dq_palette; // the same transformations
+    std::vector<uint16_t> indices;
+    std::vector<T> weights;
+    std::vector<vector3_t<T>> normals, out_positions, out_normals;
+
+    skin_data()
+    {
+        auto& d = bench::data<T>::get();
+        for (size_t i = 0; i < bones; ++i)
+        {
+            palette.push_back(matrix3x4_t<T>::translation_rotation_scaling(d.vectors3[i], d.quaternions[i], vector3_t<T>::uniform(1)));
+            dq_palette.push_back(dual_quaternion_t<T>::rotation_translation(d.quaternions[i], d.vectors3[i]));
+        }
+        for (size_t i = 0; i < bench::data_size; ++i)
+        {
+            normals.push_back(normalize(d.vectors3[(i + 1) & bench::data_mask]));
+            for (size_t k = 0; k < Influences; ++k)
+            {
+                indices.push_back(uint16_t((i * 7 + k * 13) % bones));
+                weights.push_back(T(1) / Influences);
+            }
+        }
+        out_positions.resize(bench::data_size);
+        out_normals.resize(bench::data_size);
+    }
+
+    skinned_vertices_t<Influences, T> vertices(size_t count)
+    {
+        skinned_vertices_t<Influences, T> ret;
+        ret.count = count;
+        ret.indices = indices.data();
+        ret.weights = weights.data();
+        ret.positions = bench::data<T>::get().vectors3.data();
+        ret.normals = normals.data();
+        ret.out_positions = out_positions.data();
+        ret.out_normals = out_normals.data();
+        return ret;
+    }
+};
+
+// what users did by hand: blend the matrices and use transform_coord and transform_normal per vertex
+template <size_t Influences, typename T>
+void per_vertex(picobench::state& s)
+{
+    skin_data<Influences, T> d;
+    auto& ps = bench::data<T>::get().vectors3;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        const size_t j = size_t(i) & bench::data_mask;
+        auto m = matrix3x4_t<T>::zero();
+        for (size_t k = 0; k < Influences; ++k)
+        {
+            m += d.weights[j * Influences + k] * d.palette[d.indices[j * Influences + k]];
+        }
+        d.out_positions[j] = transform_coord(ps[j], m);
+        d.out_normals[j] = normalize(transform_normal(d.normals[j], m));
+    }
+    s.set_result(picobench::result_t(d.out_positions.front().x));
+}
+
+template <size_t Influences, typename T>
+void linear(picobench::state& s)
+{
+    skin_data<Influences, T> d;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        skin_linear(d.palette.data(), d.vertices(std::min(bench::data_size, size_t(s.iterations() - done))));
+    }
+    s.set_result(picobench::result_t(d.out_positions.front().x));
+}
+
+template <size_t Influences, typename T>
+void dual_quaternion(picobench::state& s)
+{
+    skin_data<Influences, T> d;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        skin_dual_quaternion(d.dq_palette.data(), d.vertices(std::min(bench::data_size, size_t(s.iterations() - done))));
+    }
+    s.set_result(picobench::result_t(d.out_positions.front().x));
+}
+
+template <typename T> void skin_per_vertex4(picobench::state& s) { per_vertex<4, T>(s); }
+template <typename T> void skin_per_vertex8(picobench::state& s) { per_vertex<8, T>(s); }
+template <typename T> void skin_linear4(picobench::state& s) { linear<4, T>(s); }
+template <typename T> void skin_linear8(picobench::state& s) { linear<8, T>(s); }
+template <typename T> void skin_dual_quaternion4(picobench::state& s) { dual_quaternion<4, T>(s); }
+template <typename T> void skin_dual_quaternion8(picobench::state& s) { dual_quaternion<8, T>(s); }
+
+}
+
+PICOBENCH_SUITE("skinning");
+PICOBENCH(skin_per_vertex4<float>);
+PICOBENCH(skin_per_vertex4<double>);
+PICOBENCH(skin_linear4<float>);
+PICOBENCH(skin_linear4<double>);
+PICOBENCH(skin_per_vertex8<float>);
+PICOBENCH(skin_per_vertex8<double>);
+PICOBENCH(skin_linear8<float>);
+PICOBENCH(skin_linear8<double>);
+PICOBENCH(skin_dual_quaternion4<float>);
+PICOBENCH(skin_dual_quaternion4<double>);
+PICOBENCH(skin_dual_quaternion8<float>);
+PICOBENCH(skin_dual_quaternion8<double>);
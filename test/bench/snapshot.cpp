@@ -0,0 +1,102 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/snapshot.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+using codec_t = snapshot_codec<float>;
+
+// a snapshot of the bench vectors and the next one, in which each entity moved a bit
+struct snapshots
+{
+    codec_t codec = codec_t(boxnt<3, float>::min_max(vector3_t<float>::uniform(-100), vector3_t<float>::uniform(100)));
+    size_t count;
+    std::vector<uint32_t> base, next;
+    std::vector<uint8_t> encoded;
+    size_t encoded_size;
+
+    snapshots()
+    {
+        auto& d = bench::data<float>::get();
+        count = d.vectors3.size();
+        std::vector<quaternion_t<float>> r(count);
+        for (size_t i = 0; i < count; ++i) r[i] = normalize(d.quaternions[i % d.quaternions.size()]);
+
+        base.resize(codec_t::snapshot_size(count));
+        codec.quantize(d.vectors3.data(), r.data(), count, base.data());
+
+        auto p = d.vectors3;
+        for (size_t i = 0; i < count; ++i)
+        {
+            p[i] += vector3_t<float>::coord(0.01f, -0.02f, 0.005f);
+            r[i] = normalize(r[i] * quaternion_t<float>::rotation_y(0.01f));
+        }
+        next.resize(codec_t::snapshot_size(count));
+        codec.quantize(p.data(), r.data(), count, next.data());
+
+        encoded.resize(codec_t::max_encoded_size(count));
+        encoded_size = codec_t::encode(next.data(), base.data(), count, encoded.data());
+    }
+
+    static const snapshots& get()
+    {
+        static snapshots s;
+        return s;
+    }
+};
+
+// one iteration is one entity
+void snapshot_encode(picobench::state& s)
+{
+    auto& sn = snapshots::get();
+    std::vector<uint8_t> out(codec_t::max_encoded_size(sn.count));
+    picobench::scope time(s);
+    size_t size = 0;
+    for (int done = 0; done < s.iterations(); done += int(sn.count))
+    {
+        // only whole snapshots: they have the same baseline
+        size += codec_t::encode(sn.next.data(), sn.base.data(), sn.count, out.data());
+    }
+    s.set_result(picobench::result_t(size));
+}
+
+void snapshot_decode(picobench::state& s)
+{
+    auto& sn = snapshots::get();
+    std::vector<uint32_t> out(codec_t::snapshot_size(sn.count));
+    picobench::scope time(s);
+    size_t size = 0;
+    for (int done = 0; done < s.iterations(); done += int(sn.count))
+    {
+        size += codec_t::decode(sn.encoded.data(), sn.encoded_size, sn.base.data(), sn.count, out.data());
+    }
+    s.set_result(picobench::result_t(size + out.front()));
+}
+
+void snapshot_decode_dequantize(picobench::state& s)
+{
+    auto& sn = snapshots::get();
+    std::vector<uint32_t> out(codec_t::snapshot_size(sn.count));
+    std::vector<vector3_t<float>> p(sn.count);
+    std::vector<quaternion_t<float>> r(sn.count);
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(sn.count))
+    {
+        codec_t::decode(sn.encoded.data(), sn.encoded_size, sn.base.data(), sn.count, out.data());
+        sn.codec.dequantize(out.data(), sn.count, p.data(), r.data());
+    }
+    s.set_result(picobench::result_t(p.front().x + r.front().w));
+}
+
+}
+
+PICOBENCH_SUITE("snapshot");
+PICOBENCH(snapshot_encode);
+PICOBENCH(snapshot_decode);
+PICOBENCH(snapshot_decode_dequantize);
@@ -0,0 +1,93 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/sweep_and_prune.hpp"
+#include <random>
+
+using namespace yama;
+
+namespace
+{
+
+using box3 = boxnt<3, float>;
+
+// 10k boxes scattered in a cube with a side of 200 and a small step for each of them
+struct sap_scene
+{
+    static constexpr size_t count = 10000;
+
+    std::vector<box3> boxes;
+    std::vector<vector3> steps;
+
+    sap_scene()
+    {
+        std::minstd_rand rnd(13);
+        std::uniform_real_distribution<float> pos(0, 200), size(0.5f, 5), step(-0.1f, 0.1f);
+        auto rand_vec = [&](std::uniform_real_distribution<float>& d) { return v(d(rnd), d(rnd), d(rnd)); };
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            boxes.push_back(box3::pos_size(rand_vec(pos), rand_vec(size)));
+            steps.push_back(rand_vec(step));
+        }
+    }
+
+    static const sap_scene& get()
+    {
+        static sap_scene s;
+        return s;
+    }
+};
+
+// one iteration is one box
+void sap_build(picobench::state& s)
+{
+    auto& d = sap_scene::get();
+    size_t pairs = 0;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(sap_scene::count))
+    {
+        sweep_and_prune<3, float> sap(d.boxes.data(), std::min(sap_scene::count, size_t(s.iterations() - done)));
+        pairs += sap.pair_count();
+    }
+    s.set_result(picobench::result_t(pairs));
+}
+
+// one iteration is one box moved by its step (coherent frames)
+void sap_update(picobench::state& s)
+{
+    auto& d = sap_scene::get();
+    auto boxes = d.boxes;
+    sweep_and_prune<3, float> sap(boxes.data(), boxes.size());
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        const size_t j = size_t(i) % sap_scene::count;
+        auto& b = boxes[j];
+        b = box3::min_max(b.min + d.steps[j], b.max + d.steps[j]);
+        sap.update(uint32_t(j), b);
+    }
+    s.set_result(picobench::result_t(sap.pair_count()));
+}
+
+// the pairs of the boxes by brute force, one iteration is one box
+void pairs_brute(picobench::state& s)
+{
+    auto& d = sap_scene::get();
+    size_t pairs = 0;
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        const size_t j = size_t(i) % sap_scene::count;
+        for (size_t k = j + 1; k < sap_scene::count; ++k) pairs += d.boxes[j].intersects(d.boxes[k]);
+    }
+    s.set_result(picobench::result_t(pairs));
+}
+
+}
+
+PICOBENCH_SUITE("sweep_and_prune");
+PICOBENCH(sap_build).iterations({10000, 40000});
+PICOBENCH(sap_update).iterations({10000, 40000});
+PICOBENCH(pairs_brute).iterations({10000});
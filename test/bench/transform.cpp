@@ -0,0 +1,114 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+template <typename T>
+void matrix4x4_transform_coord(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) { return transform_coord(d.vectors3[i], d.matrices[(i + 1) & bench::data_mask]); });
+}
+
+template <typename T>
+void matrix4x4_transform_normal(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    bench::run(s, [&](size_t i) { return transform_normal(d.vectors3[i], d.matrices[(i + 1) & bench::data_mask]); });
+}
+
+template <typename T>
+void matrix3x4_transform_coord(picobench::state& s)
+{
+    auto& d = bench::data<T>::get();
+    std::vector<matrix3x4_t<T>> m(d.matrices.size());
+    std::transform(d.matrices.begin(), d.matrices.end(), m.begin(), [](const matrix4x4_t<T>& a) {
+        return matrix3x4_t<T>::rows(a.m00, a.m01, a.m02, a.m03, a.m10, a.m11, a.m12, a.m13, a.m20, a.m21, a.m22, a.m23);
+    });
+    bench::run(s, [&](size_t i) { return transform_coord(d.vectors3[i], m[(i + 1) & bench::data_mask]); });
+}
+
+// batch transforms: one iteration is one point
+// transform(in, count, out) is called on chunks of the points
+template <typename T, typename Transform>
+void batch_bench(picobench::state& s, Transform transform)
+{
+    auto& ps = bench::data<T>::get().vectors3;
+    std::vector<vector3_t<T>> out(ps.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(ps.size()))
+    {
+        const size_t count = std::min(ps.size(), size_t(s.iterations() - done));
+        transform(ps.data(), count, out.data());
+    }
+    s.set_result(picobench::result_t(out.front().x));
+}
+
+template <typename T>
+const matrix4x4_t<T>& affine()
+{
+    return bench::data<T>::get().matrices.front();
+}
+
+template <typename T>
+matrix4x4_t<T> projective()
+{
+    return matrix4x4_t<T>::perspective_fov_rh(1, T(1.5), 1, 100) * affine<T>();
+}
+
+template <typename T>
+void transform_affine_batch(picobench::state& s)
+{
+    const auto& m = affine<T>();
+    batch_bench<T>(s, [&](const vector3_t<T>* in, size_t count, vector3_t<T>* out) {
+        transform_coord(in, count, m, out);
+    });
+}
+
+template <typename T>
+void transform_projective_batch(picobench::state& s)
+{
+    const auto m = projective<T>();
+    batch_bench<T>(s, [&](const vector3_t<T>* in, size_t count, vector3_t<T>* out) {
+        transform_coord(in, count, m, out);
+    });
+}
+
+template <typename P>
+void simd_bench(picobench::state& s, const matrix4x4_t<float>& m)
+{
+    batch_bench<float>(s, [&](const vector3_t<float>* in, size_t count, vector3_t<float>* out) {
+        simd::transform_coord<4, P>(m.data(), in->data(), count, out->data(), !m.is_affine());
+    });
+}
+
+void transform_affine_f32x4(picobench::state& s) { simd_bench<simd::f32x4>(s, affine<float>()); }
+void transform_affine_f32x8(picobench::state& s) { simd_bench<simd::f32x8>(s, affine<float>()); }
+void transform_projective_f32x4(picobench::state& s) { simd_bench<simd::f32x4>(s, projective<float>()); }
+void transform_projective_f32x8(picobench::state& s) { simd_bench<simd::f32x8>(s, projective<float>()); }
+
+}
+
+PICOBENCH_SUITE("transform");
+PICOBENCH(matrix4x4_transform_coord<float>);
+PICOBENCH(matrix4x4_transform_coord<double>);
+PICOBENCH(matrix4x4_transform_normal<float>);
+PICOBENCH(matrix4x4_transform_normal<double>);
+PICOBENCH(matrix3x4_transform_coord<float>);
+PICOBENCH(matrix3x4_transform_coord<double>);
+
+PICOBENCH_SUITE("transform batch");
+PICOBENCH(transform_affine_batch<float>);
+PICOBENCH(transform_affine_batch<double>);
+PICOBENCH(transform_affine_f32x4);
+PICOBENCH(transform_affine_f32x8);
+PICOBENCH(transform_projective_batch<float>);
+PICOBENCH(transform_projective_batch<double>);
+PICOBENCH(transform_projective_f32x4);
+PICOBENCH(transform_projective_f32x8);
@@ -0,0 +1,74 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/transform_hierarchy.hpp"
+
+using namespace yama;
+
+namespace
+{
+
+// a hierarchy of data_size nodes: chains of up to 8 nodes under a few roots
+template <typename T>
+struct hierarchy_data
+{
+    transform_hierarchy<T> h;
+
+    hierarchy_data()
+    {
+        auto& d = bench::data<T>::get();
+        const auto scaling = vector3_t<T>::uniform(1);
+        for (size_t i = 0; i < bench::data_size; ++i)
+        {
+            const auto parent = i % 64 == 0 ? transform_hierarchy<T>::no_parent : uint32_t(i % 8 == 0 ? i - i % 64 : i - 1);
+            h.add(parent, d.vectors3[i], d.quaternions[i], scaling);
+        }
+        h.update();
+    }
+};
+
+// what users did by hand: rebuild all local and world matrices
+// one iteration is one node
+template <typename T>
+void hierarchy_naive(picobench::state& s)
+{
+    hierarchy_data<T> d;
+    std::vector<matrix3x4_t<T>> world(bench::data_size);
+    picobench::scope time(s);
+    for (auto i : s)
+    {
+        const size_t j = size_t(i) & bench::data_mask;
+        const auto local = matrix3x4_t<T>::translation_rotation_scaling(d.h.translation(j), d.h.rotation(j), d.h.scaling(j));
+        const auto p = d.h.parent(j);
+        world[j] = p == transform_hierarchy<T>::no_parent ? local : world[p] * local;
+    }
+    s.set_result(picobench::result_t(world.back().m03));
+}
+
+// one iteration is one node, DirtyEvery is how many nodes there are per dirty one (the ends of chains for 8 and 16)
+template <typename T, size_t DirtyEvery>
+void hierarchy_update(picobench::state& s)
+{
+    hierarchy_data<T> d;
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(bench::data_size))
+    {
+        if (DirtyEvery)
+        {
+            for (size_t i = DirtyEvery - 1; i < bench::data_size; i += DirtyEvery) d.h.set_translation(i, d.h.translation(i));
+        }
+        d.h.update(0, std::min(bench::data_size, size_t(s.iterations() - done)));
+    }
+    s.set_result(picobench::result_t(d.h.world_matrices().back().m03));
+}
+
+}
+
+PICOBENCH_SUITE("transform_hierarchy");
+PICOBENCH(hierarchy_naive<float>);
+PICOBENCH(hierarchy_naive<double>);
+PICOBENCH((hierarchy_update<float, 1>));
+PICOBENCH((hierarchy_update<double, 1>));
+PICOBENCH((hierarchy_update<float, 16>));
+PICOBENCH((hierarchy_update<float, 0>));
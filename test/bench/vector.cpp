@@ -0,0 +1,87 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+
+using namespace yama;
+
+namespace
+{
+
+template <typename T>
+void vector3_add(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors3;
+    bench::run(s, [&](size_t i) { return v[i] + v[(i + 1) & bench::data_mask]; });
+}
+
+template <typename T>
+void vector3_dot(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors3;
+    bench::run(s, [&](size_t i) { return dot(v[i], v[(i + 1) & bench::data_mask]); });
+}
+
+template <typename T>
+void vector3_cross(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors3;
+    bench::run(s, [&](size_t i) { return cross(v[i], v[(i + 1) & bench::data_mask]); });
+}
+
+template <typename T>
+void vector3_length(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors3;
+    bench::run(s, [&](size_t i) { return v[i].length(); });
+}
+
+template <typename T>
+void vector3_normalize(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors3;
+    bench::run(s, [&](size_t i) { return normalize(v[i]); });
+}
+
+template <typename T>
+void vector3_distance_sq(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors3;
+    bench::run(s, [&](size_t i) { return distance_sq(v[i], v[(i + 1) & bench::data_mask]); });
+}
+
+template <typename T>
+void vector4_dot(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors4;
+    bench::run(s, [&](size_t i) { return dot(v[i], v[(i + 1) & bench::data_mask]); });
+}
+
+template <typename T>
+void vector4_normalize(picobench::state& s)
+{
+    auto& v = bench::data<T>::get().vectors4;
+    bench::run(s, [&](size_t i) { return normalize(v[i]); });
+}
+
+}
+
+PICOBENCH_SUITE("vector3");
+PICOBENCH(vector3_add<float>);
+PICOBENCH(vector3_add<double>);
+PICOBENCH(vector3_dot<float>);
+PICOBENCH(vector3_dot<double>);
+PICOBENCH(vector3_cross<float>);
+PICOBENCH(vector3_cross<double>);
+PICOBENCH(vector3_length<float>);
+PICOBENCH(vector3_length<double>);
+PICOBENCH(vector3_normalize<float>);
+PICOBENCH(vector3_normalize<double>);
+PICOBENCH(vector3_distance_sq<float>);
+PICOBENCH(vector3_distance_sq<double>);
+
+PICOBENCH_SUITE("vector4");
+PICOBENCH(vector4_dot<float>);
+PICOBENCH(vector4_dot<double>);
+PICOBENCH(vector4_normalize<float>);
+PICOBENCH(vector4_normalize<double>);
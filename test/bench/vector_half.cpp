@@ -0,0 +1,60 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/vector_half.hpp"
+#include <algorithm>
+
+using namespace yama;
+
+namespace
+{
+
+// one iteration is one vector3
+void vector3h_pack(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    bench::run(s, [&](size_t i) { return vector3h::pack(v[i]).bits[0]; });
+}
+
+void vector3h_unpack(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    std::vector<vector3h> h(v.size());
+    pack(v.data(), v.size(), h.data());
+    bench::run(s, [&](size_t i) { return h[i].unpack(); });
+}
+
+void vector3h_pack_batch(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    std::vector<vector3h> out(v.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(v.size()))
+    {
+        pack(v.data(), std::min(v.size(), size_t(s.iterations() - done)), out.data());
+    }
+    s.set_result(picobench::result_t(out.front().bits[0]));
+}
+
+void vector3h_unpack_batch(picobench::state& s)
+{
+    auto& v = bench::data<float>::get().vectors3;
+    std::vector<vector3h> h(v.size());
+    pack(v.data(), v.size(), h.data());
+    std::vector<vector3_t<float>> out(v.size());
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(v.size()))
+    {
+        unpack(h.data(), std::min(v.size(), size_t(s.iterations() - done)), out.data());
+    }
+    s.set_result(picobench::result_t(out.front().x));
+}
+
+}
+
+PICOBENCH_SUITE("vector_half");
+PICOBENCH(vector3h_pack);
+PICOBENCH(vector3h_unpack);
+PICOBENCH(vector3h_pack_batch);
+PICOBENCH(vector3h_unpack_batch);
@@ -0,0 +1,85 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "common.hpp"
+#include "yama/vector_soa.hpp"
+
+// Arrays of vector3_t vs vector3_soa_t
+// One iteration is one vector
+
+using namespace yama;
+
+namespace
+{
+
+const std::vector<vector3_t<float>>& points()
+{
+    return bench::data<float>::get().vectors3;
+}
+
+// f(count) is called on chunks of the points
+template <typename F>
+void chunk_bench(picobench::state& s, F f)
+{
+    const size_t size = points().size();
+    picobench::scope time(s);
+    for (int done = 0; done < s.iterations(); done += int(size))
+    {
+        f(std::min(size, size_t(s.iterations() - done)));
+    }
+}
+
+void normalize_aos(picobench::state& s)
+{
+    auto& ps = points();
+    std::vector<vector3_t<float>> out(ps.size());
+    chunk_bench(s, [&](size_t count) {
+        for (size_t i = 0; i < count; ++i) out[i] = normalize(ps[i]);
+    });
+    s.set_result(picobench::result_t(out.front().x * 1000));
+}
+
+void normalize_soa(picobench::state& s)
+{
+    auto& ps = points();
+    vector3_soa_t<float> in(ps.data(), ps.size()), out(ps.size());
+    chunk_bench(s, [&](size_t count) {
+        in.resize(count); // the kernel processes the whole stream
+        normalize(in, out);
+    });
+    s.set_result(picobench::result_t(out.x()[0] * 1000));
+}
+
+void distance_sq_aos(picobench::state& s)
+{
+    auto& ps = points();
+    std::vector<float> out(ps.size());
+    const auto p = vector3_t<float>::coord(1, 2, 3);
+    chunk_bench(s, [&](size_t count) {
+        for (size_t i = 0; i < count; ++i) out[i] = distance_sq(ps[i], p);
+    });
+    s.set_result(picobench::result_t(out.front()));
+}
+
+void distance_sq_soa(picobench::state& s)
+{
+    auto& ps = points();
+    vector3_soa_t<float> in(ps.data(), ps.size());
+    std::vector<float> out(ps.size());
+    const auto p = vector3_t<float>::coord(1, 2, 3);
+    chunk_bench(s, [&](size_t count) {
+        in.resize(count);
+        distance_sq(in, p, out.data());
+    });
+    s.set_result(picobench::result_t(out.front()));
+}
+
+}
+
+PICOBENCH_SUITE("vector3 normalize");
+PICOBENCH(normalize_aos);
+PICOBENCH(normalize_soa);
+
+PICOBENCH_SUITE("vector3 distance_sq");
+PICOBENCH(distance_sq_aos);
+PICOBENCH(distance_sq_soa);
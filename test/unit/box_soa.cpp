@@ -0,0 +1,113 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/box_soa.hpp"
+#include "common.hpp"
+
+#include <vector>
+#include <random>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("box_soa");
+
+namespace
+{
+template <size_t D, typename T>
+std::vector<boxnt<D, T>> random_boxes(size_t count)
+{
+    using vec = typename boxnt<D, T>::dim_vector;
+    std::minstd_rand rnd(3);
+    std::uniform_real_distribution<T> d(-10, 10);
+    auto rand_vec = [&]() {
+        vec ret;
+        for (size_t i = 0; i < D; ++i) ret.at(i) = d(rnd);
+        return ret;
+    };
+
+    std::vector<boxnt<D, T>> ret;
+    for (size_t i = 0; i < count; ++i) ret.push_back(boxnt<D, T>::pos_size(rand_vec(), abs(rand_vec()) / T(3)));
+    return ret;
+}
+
+template <size_t D, typename T>
+void test_soa()
+{
+    using box = boxnt<D, T>;
+
+    for (size_t count : {0, 1, 3, 4, 8, 9, 31, 32, 33, 100})
+    {
+        const auto boxes = random_boxes<D, T>(count + 10);
+        box_soa<D, T> soa(boxes.data(), count);
+        CHECK(soa.size() == count);
+        for (size_t i = 0; i < count; ++i) CHECK(soa.get(i) == boxes[i]);
+
+        std::vector<box> copy(count);
+        soa.copy_to(copy.data());
+        CHECK(std::equal(copy.begin(), copy.end(), boxes.begin()));
+
+        auto all = box::inverted();
+        for (size_t i = 0; i < count; ++i) all.merge(boxes[i]);
+        CHECK(bounds(soa) == all);
+
+        const size_t words = (count + 31) / 32;
+        std::vector<uint32_t> hits(words + 1, 0xdeadbeef);
+        std::vector<uint32_t> indices(count + 1, 0xdeadbeef);
+
+        // the extra boxes are the queries
+        for (size_t q = count; q < count + 10; ++q)
+        {
+            intersects(soa, boxes[q], hits.data());
+            const size_t n = intersecting(soa, boxes[q], indices.data());
+
+            std::vector<uint32_t> expected;
+            auto expected_bounds = box::inverted();
+            for (size_t i = 0; i < count; ++i)
+            {
+                const bool hit = boxes[i].intersects(boxes[q]);
+                CHECK(bool(hits[i / 32] & (1u << (i % 32))) == hit);
+                if (hit)
+                {
+                    expected.push_back(uint32_t(i));
+                    expected_bounds.merge(boxes[i]);
+                }
+            }
+            if (count % 32) CHECK(hits[words - 1] >> (count % 32) == 0);
+            CHECK(hits[words] == 0xdeadbeef);
+
+            CHECK(n == expected.size());
+            CHECK(std::equal(expected.begin(), expected.end(), indices.begin()));
+            CHECK(indices[count] == 0xdeadbeef);
+
+            CHECK(bounds(soa, hits.data()) == expected_bounds);
+            CHECK(bounds(soa, indices.data(), n) == expected_bounds);
+        }
+
+        // a query which hits everything
+        const auto big = box::min_max(all.min - all.size(), all.max + all.size());
+        CHECK(intersecting(soa, big, indices.data()) == count);
+        intersects(soa, big, hits.data());
+        CHECK(bounds(soa, hits.data()) == all);
+    }
+
+    // incremental
+    box_soa<D, T> soa;
+    CHECK(soa.empty());
+    const auto boxes = random_boxes<D, T>(20);
+    for (auto& b : boxes) soa.push_back(b);
+    CHECK(soa.size() == 20);
+    soa.set(3, boxes[0]);
+    CHECK(soa.get(3) == boxes[0]);
+    CHECK(soa.min_corners().get(5) == boxes[5].min);
+    CHECK(soa.max_corners().get(5) == boxes[5].max);
+    soa.clear();
+    CHECK(soa.empty());
+}
+}
+
+TEST_CASE("queries")
+{
+    test_soa<3, float>();
+    test_soa<2, float>();
+    test_soa<3, double>();
+}
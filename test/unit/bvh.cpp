@@ -0,0 +1,201 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/bvh.hpp"
+#include "common.hpp"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("bvh");
+
+namespace
+{
+template <size_t D, typename T>
+struct scene
+{
+    using box = boxnt<D, T>;
+    using vec = typename box::dim_vector;
+
+    std::minstd_rand rnd{7};
+    std::vector<box> boxes;
+
+    vec rand_vec(T scale)
+    {
+        std::uniform_real_distribution<T> d(-scale, scale);
+        vec ret;
+        for (size_t i = 0; i < D; ++i) ret.at(i) = d(rnd);
+        return ret;
+    }
+
+    explicit scene(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            boxes.push_back(box::pos_size(rand_vec(50), abs(rand_vec(3)) + vec::uniform(T(0.1))));
+        }
+    }
+
+    template <typename Pred>
+    std::vector<size_t> brute(Pred pred) const
+    {
+        std::vector<size_t> ret;
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            if (pred(boxes[i])) ret.push_back(i);
+        }
+        return ret;
+    }
+};
+
+template <typename Q>
+std::vector<size_t> collect(Q q)
+{
+    std::vector<size_t> ret;
+    q([&](size_t i) { ret.push_back(i); });
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+template <size_t D, typename T>
+void test_queries(size_t count, size_t max_leaf_size)
+{
+    using box = boxnt<D, T>;
+    using vec = typename box::dim_vector;
+
+    scene<D, T> s(count);
+    bvh<D, T> tree(s.boxes.data(), s.boxes.size(), max_leaf_size);
+    CHECK(tree.size() == count);
+
+    // every item is in exactly one leaf
+    auto items = tree.items();
+    std::sort(items.begin(), items.end());
+    for (size_t i = 0; i < items.size(); ++i) CHECK(items[i] == i);
+
+    for (auto& n : tree.nodes())
+    {
+        CHECK(n.count <= max_leaf_size);
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        const auto q = box::pos_size(s.rand_vec(50), abs(s.rand_vec(10)));
+        CHECK(collect([&](auto f) { tree.query(q, f); }) == s.brute([&](const box& b) { return b.intersects(q); }));
+
+        const auto p = s.rand_vec(50);
+        CHECK(collect([&](auto f) { tree.query(p, f); }) == s.brute([&](const box& b) { return b.is_inside(p); }));
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        const auto origin = s.rand_vec(60);
+        const auto dir = s.rand_vec(1);
+        const T max_t = 100;
+
+        // brute force with sampling is not exact, so compare with the slab test itself
+        const auto inv = div(vec::uniform(1), dir);
+        auto hits = s.brute([&](const box& b) { T t; return impl::ray_hits(b, origin, inv, max_t, t); });
+
+        std::vector<size_t> found;
+        tree.query_ray(origin, dir, max_t, [&](size_t index, T&) { found.push_back(index); });
+        std::sort(found.begin(), found.end());
+        CHECK(found == hits);
+
+        // closest hit: reduce max_t
+        // compare distances, since several boxes can be entered at the same t (say 0 for the ones containing the origin)
+        T closest_t = max_t;
+        for (auto h : hits)
+        {
+            T t;
+            impl::ray_hits(s.boxes[h], origin, inv, max_t, t);
+            closest_t = std::min(closest_t, t);
+        }
+
+        T tree_closest_t = max_t;
+        size_t visits = 0;
+        tree.query_ray(origin, dir, max_t, [&](size_t index, T& mt) {
+            ++visits;
+            T t;
+            impl::ray_hits(s.boxes[index], origin, inv, mt, t);
+            if (t < mt) mt = t;
+            tree_closest_t = mt;
+        });
+        CHECK(tree_closest_t == closest_t);
+        CHECK(visits <= hits.size());
+    }
+
+    // early exit
+    size_t visited = 0;
+    tree.query(tree.bounds(), [&](size_t) { ++visited; return visited < 3; });
+    CHECK(visited == std::min(count, size_t(3)));
+}
+}
+
+TEST_CASE("build")
+{
+    bvh<3, float> tree;
+    CHECK(tree.empty());
+    CHECK(tree.nodes().empty());
+    tree.query(boxnt<3, float>::pos_size(vector3::zero(), vector3::uniform(1)), [](size_t) { CHECK(false); });
+    tree.query_ray(vector3::zero(), vector3::unit_x(), 1, [](size_t, float&) { CHECK(false); });
+
+    // all boxes the same
+    std::vector<boxnt<3, float>> same(100, boxnt<3, float>::pos_size(vector3::zero(), vector3::uniform(1)));
+    tree.build(same.data(), same.size());
+    CHECK(tree.size() == 100);
+    CHECK(tree.depth() < 10);
+    size_t count = 0;
+    tree.query(vector3::uniform(0.5f), [&](size_t) { ++count; });
+    CHECK(count == 100);
+    CHECK(tree.bounds() == same.front());
+
+    // a row of boxes is split in the middle
+    std::vector<boxnt<2, double>> row;
+    for (int i = 0; i < 64; ++i)
+    {
+        row.push_back(boxnt<2, double>::pos_size(vector2_t<double>::coord(i, 0), vector2_t<double>::uniform(1)));
+    }
+    bvh<2, double> tree2(row.data(), row.size(), 1);
+    CHECK(tree2.depth() == 7);
+    CHECK(tree2.nodes().size() == 127);
+}
+
+TEST_CASE("queries")
+{
+    test_queries<3, float>(1, 4);
+    test_queries<3, float>(1000, 4);
+    test_queries<3, double>(500, 1);
+    test_queries<2, float>(700, 8);
+}
+
+TEST_CASE("refit")
+{
+    using box = boxnt<3, float>;
+    scene<3, float> s(300);
+    bvh<3, float> tree(s.boxes.data(), s.boxes.size());
+    const auto nodes = tree.nodes();
+
+    for (auto& b : s.boxes) b = b + s.rand_vec(5);
+    tree.refit(s.boxes.data());
+
+    auto all = box::inverted();
+    for (auto& b : s.boxes) all.merge(b);
+    CHECK(tree.bounds() == all);
+
+    // the same structure
+    REQUIRE(tree.nodes().size() == nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        CHECK(tree.nodes()[i].first == nodes[i].first);
+        CHECK(tree.nodes()[i].count == nodes[i].count);
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        const auto q = box::pos_size(s.rand_vec(50), abs(s.rand_vec(10)));
+        CHECK(collect([&](auto f) { tree.query(q, f); }) == s.brute([&](const box& b) { return b.intersects(q); }));
+    }
+}
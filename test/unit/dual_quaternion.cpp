@@ -0,0 +1,111 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/dual_quaternion.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+using namespace yama;
+using doctest::Approx;
+
+TEST_SUITE_BEGIN("dual_quaternion");
+
+TEST_CASE("construction")
+{
+    auto d0 = dual_quaternion::identity();
+    CHECK(d0.real == quaternion::identity());
+    CHECK(d0.dual == quaternion::zero());
+    CHECK(d0.size() == 8);
+
+    const float data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    d0 = dual_quaternion::from_ptr(data);
+    CHECK(d0.real == quaternion::xyzw(1, 2, 3, 4));
+    CHECK(d0.dual == quaternion::xyzw(5, 6, 7, 8));
+    CHECK(d0.data()[0] == 1);
+    CHECK(d0.data()[7] == 8);
+
+    d0 = dual_quaternion::translation(v(1, 2, 3));
+    CHECK(d0.is_normalized());
+    CHECK(YamaApprox(d0.translation()) == v(1, 2, 3));
+    CHECK(YamaApprox(d0.to_matrix3x4()) == matrix3x4::translation(1, 2, 3));
+
+    const auto q = quaternion::rotation_axis(v(1, -2, 3), 0.7f);
+    d0 = dual_quaternion::rotation(q);
+    CHECK(YamaApprox(d0.translation()) == vector3::zero());
+    CHECK(YamaApprox(d0.to_matrix3x4()) == matrix3x4::rotation_quaternion(q));
+
+    d0 = dual_quaternion::rotation_translation(q, v(-1, 0.5f, 2));
+    CHECK(d0.is_normalized());
+    CHECK(YamaApprox(d0.translation()) == v(-1, 0.5f, 2));
+    CHECK(YamaApprox(d0.to_matrix3x4()) == matrix3x4::translation(-1, 0.5f, 2) * matrix3x4::rotation_quaternion(q));
+}
+
+TEST_CASE("rigid matrix")
+{
+    // angles close to pi go through all the branches of the conversion
+    const quaternion qs[] = {
+        quaternion::identity(),
+        quaternion::rotation_axis(v(1, -2, 3), 0.7f),
+        quaternion::rotation_x(3.1f),
+        quaternion::rotation_y(3.1f),
+        quaternion::rotation_z(3.1f),
+        quaternion::rotation_axis(v(1, 1, 0.1f), 3.0f),
+    };
+
+    for (auto& q : qs)
+    {
+        const auto m = matrix3x4::translation(2, -1, 0.5f) * matrix3x4::rotation_quaternion(q);
+        const auto d = dual_quaternion::rigid_matrix(m);
+        CHECK(d.is_normalized());
+        CHECK(YamaApprox(d.to_matrix3x4()) == m);
+        CHECK(YamaApprox(d.translation()) == v(2, -1, 0.5f));
+    }
+}
+
+TEST_CASE("ops")
+{
+    const auto a = dual_quaternion::rotation_translation(quaternion::rotation_axis(v(1, -2, 3), 0.7f), v(-1, 0.5f, 2));
+    const auto b = dual_quaternion::rotation_translation(quaternion::rotation_axis(v(0, 1, 1), -1.3f), v(0.3f, 1, -0.2f));
+    const auto ma = a.to_matrix3x4();
+    const auto mb = b.to_matrix3x4();
+
+    const auto p = v(0.5f, -1, 0.8f);
+    CHECK(YamaApprox(transform_coord(p, a)) == transform_coord(p, ma));
+    CHECK(YamaApprox(transform_normal(p, a)) == transform_normal(p, ma));
+
+    CHECK(YamaApprox((a * b).to_matrix3x4()) == ma * mb);
+    CHECK(YamaApprox(transform_coord(p, a * b)) == transform_coord(transform_coord(p, b), a));
+    auto c = a;
+    c *= b;
+    CHECK(YamaApprox(c) == a * b);
+
+    CHECK(YamaApprox(a * conjugate(a)) == dual_quaternion::identity());
+    CHECK(YamaApprox(transform_coord(transform_coord(p, a), conjugate(a))) == p);
+    c = a;
+    c.conjugate();
+    CHECK(YamaApprox(c) == conjugate(a));
+
+    CHECK(YamaApprox(a + b - b) == a);
+    CHECK(YamaApprox(a * 2.f) == 2.f * a);
+    CHECK(YamaApprox(-a) == a * -1.f);
+    c = a;
+    c += b;
+    c -= a;
+    CHECK(YamaApprox(c) == b);
+
+    // a dual quaternion scaled, and with a dual part which is not orthogonal to the real one
+    c = a * 3.f;
+    c.dual += c.real * 0.1f;
+    CHECK(!c.is_normalized());
+    CHECK(Approx(c.normalize()) == 3);
+    CHECK(c.is_normalized());
+    CHECK(YamaApprox(c) == a);
+    CHECK(YamaApprox(normalize(a * 0.5f)) == a);
+
+    // blending two transformations is a transformation
+    c = normalize(a * 0.3f + b * 0.7f);
+    CHECK(c.is_normalized());
+    CHECK(isfinite(c));
+    CHECK(a != b);
+    CHECK(close(c, c));
+}
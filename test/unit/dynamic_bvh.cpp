@@ -0,0 +1,274 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/dynamic_bvh.hpp"
+#include "common.hpp"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("dynamic_bvh");
+
+namespace
+{
+template <size_t D, typename T>
+struct world
+{
+    using tree_type = dynamic_bvh<D, T>;
+    using box = boxnt<D, T>;
+    using vec = typename box::dim_vector;
+    using id = typename tree_type::index_type;
+
+    std::minstd_rand rnd{13};
+    tree_type tree{T(0.5)};
+    std::vector<std::pair<id, box>> items;
+
+    vec rand_vec(T scale)
+    {
+        std::uniform_real_distribution<T> d(-scale, scale);
+        vec ret;
+        for (size_t i = 0; i < D; ++i) ret.at(i) = d(rnd);
+        return ret;
+    }
+
+    // a move by more than the margin along every axis
+    vec large_move()
+    {
+        auto ret = rand_vec(10);
+        for (size_t i = 0; i < D; ++i) ret.at(i) += ret.at(i) < 0 ? -1 : 1;
+        return ret;
+    }
+
+    box rand_box()
+    {
+        return box::pos_size(rand_vec(50), abs(rand_vec(3)) + vec::uniform(T(0.1)));
+    }
+
+    void add(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto b = rand_box();
+            items.push_back({tree.insert(b), b});
+        }
+    }
+
+    // checks the links, bounds, and heights of every node
+    // returns the number of leaves under i
+    size_t validate(id i, id parent) const
+    {
+        const auto& n = tree.nodes()[i];
+        CHECK(n.parent == parent);
+        if (n.is_leaf())
+        {
+            CHECK(n.height == 0);
+            return 1;
+        }
+
+        const auto& c0 = tree.nodes()[n.children[0]];
+        const auto& c1 = tree.nodes()[n.children[1]];
+        auto bounds = c0.bounds;
+        bounds.merge(c1.bounds);
+        CHECK(n.bounds == bounds);
+        CHECK(n.height == 1 + std::max(c0.height, c1.height));
+        return validate(n.children[0], i) + validate(n.children[1], i);
+    }
+
+    void validate() const
+    {
+        CHECK(tree.size() == items.size());
+        if (items.empty())
+        {
+            CHECK(tree.root() == tree_type::null_index);
+            return;
+        }
+        CHECK(validate(tree.root(), tree_type::null_index) == items.size());
+
+        for (auto& item : items)
+        {
+            CHECK(tree.fat_bounds(item.first).contains(item.second));
+        }
+
+        // the rotations keep the tree roughly balanced
+        CHECK(tree.height() <= 2 * std::log2(double(items.size())) + 1);
+    }
+
+    template <typename Pred>
+    std::vector<size_t> brute(Pred pred) const
+    {
+        std::vector<size_t> ret;
+        for (auto& item : items)
+        {
+            if (pred(tree.fat_bounds(item.first))) ret.push_back(item.first);
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    void check_queries()
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            const auto q = box::pos_size(rand_vec(50), abs(rand_vec(10)));
+            std::vector<size_t> found;
+            tree.query(q, [&](size_t f) { found.push_back(f); });
+            std::sort(found.begin(), found.end());
+            CHECK(found == brute([&](const box& b) { return b.intersects(q); }));
+
+            const auto p = rand_vec(50);
+            found.clear();
+            tree.query(p, [&](size_t f) { found.push_back(f); });
+            std::sort(found.begin(), found.end());
+            CHECK(found == brute([&](const box& b) { return b.is_inside(p); }));
+
+            const auto origin = rand_vec(60);
+            const auto dir = rand_vec(1);
+            const auto inv = div(vec::uniform(1), dir);
+            found.clear();
+            tree.query_ray(origin, dir, T(100), [&](size_t f, T&) { found.push_back(f); });
+            std::sort(found.begin(), found.end());
+            CHECK(found == brute([&](const box& b) { T t; return impl::ray_hits(b, origin, inv, T(100), t); }));
+        }
+    }
+};
+
+template <size_t D, typename T>
+void test_world()
+{
+    world<D, T> w;
+    w.validate();
+    w.check_queries();
+
+    w.add(1);
+    w.validate();
+    w.check_queries();
+
+    w.add(999);
+    w.validate();
+    w.check_queries();
+
+    // small moves stay in the fat boxes
+    size_t reinserted = 0;
+    for (auto& item : w.items)
+    {
+        const auto d = w.rand_vec(T(0.2));
+        item.second = item.second + d;
+        reinserted += w.tree.update(item.first, item.second, d);
+    }
+    CHECK(reinserted == 0);
+    w.validate();
+
+    // large moves don't
+    for (auto& item : w.items)
+    {
+        const auto d = w.large_move();
+        item.second = item.second + d;
+        CHECK(w.tree.update(item.first, item.second, d));
+    }
+    w.validate();
+    w.check_queries();
+
+    // stopping shrinks the fat boxes which were grown by the displacement
+    for (auto& item : w.items)
+    {
+        w.tree.update(item.first, item.second);
+    }
+    w.validate();
+    for (auto& item : w.items)
+    {
+        CHECK(!w.tree.update(item.first, item.second));
+    }
+
+    // remove half and reuse the ids
+    decltype(w.items) kept;
+    size_t removed = 0;
+    for (size_t i = 0; i < w.items.size(); ++i)
+    {
+        if (i % 2)
+        {
+            kept.push_back(w.items[i]);
+        }
+        else
+        {
+            w.tree.remove(w.items[i].first);
+            ++removed;
+        }
+    }
+    w.items.swap(kept);
+    w.validate();
+    w.check_queries();
+
+    const auto node_count = w.tree.nodes().size();
+    w.add(removed);
+    CHECK(w.tree.nodes().size() == node_count);
+    w.validate();
+    w.check_queries();
+
+    while (!w.items.empty())
+    {
+        w.tree.remove(w.items.back().first);
+        w.items.pop_back();
+    }
+    w.validate();
+    CHECK(w.tree.empty());
+}
+
+}
+
+TEST_CASE("basic")
+{
+    dynamic_bvh<3, float> tree(0.1f);
+    CHECK(tree.empty());
+    CHECK(tree.height() == 0);
+    tree.query(vector3::zero(), [](size_t) { CHECK(false); });
+
+    const auto a = tree.insert(boxnt<3, float>::pos_size(vector3::zero(), vector3::uniform(1)));
+    CHECK(tree.size() == 1);
+    CHECK(tree.root() == a);
+    CHECK(tree.bounds() == boxnt<3, float>::min_max(vector3::uniform(-0.1f), vector3::uniform(1.1f)));
+
+    const auto b = tree.insert(boxnt<3, float>::pos_size(v(5, 0, 0), vector3::uniform(1)));
+    CHECK(tree.size() == 2);
+    CHECK(tree.height() == 1);
+
+    // the near box is visited first and reducing max_t skips the far one
+    std::vector<size_t> hits;
+    tree.query_ray(v(10, 0.5f, 0.5f), v(-1, 0, 0), 100, [&](size_t i, float& max_t) {
+        hits.push_back(i);
+        max_t = 5;
+    });
+    CHECK(hits == std::vector<size_t>{b});
+
+    // early exit
+    size_t visited = 0;
+    tree.query(tree.bounds(), [&](size_t) { ++visited; return false; });
+    CHECK(visited == 1);
+
+    tree.remove(a);
+    CHECK(tree.root() == b);
+    CHECK(tree.height() == 0);
+    tree.clear();
+    CHECK(tree.empty());
+    CHECK(tree.nodes().empty());
+}
+
+TEST_CASE("sorted insertion is balanced")
+{
+    // items in a row make an unbalanced tree without rotations
+    dynamic_bvh<2, float> tree(0);
+    for (int i = 0; i < 1024; ++i)
+    {
+        tree.insert(boxnt<2, float>::pos_size(vector2::coord(float(i), 0), vector2::uniform(1)));
+    }
+    CHECK(tree.height() <= 20);
+}
+
+TEST_CASE("world")
+{
+    test_world<3, float>();
+    test_world<2, double>();
+}
@@ -0,0 +1,165 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/frustum.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+
+using namespace yama;
+using doctest::Approx;
+
+TEST_SUITE_BEGIN("frustum");
+
+TEST_CASE("planes")
+{
+    const auto pi = constants::PI;
+    const auto lh = frustum::from_matrix(matrix::perspective_fov_lh(pi / 2, 1, 1, 100));
+    const auto lh_cube = frustum::from_matrix_cube(matrix::perspective_fov_lh_cube(pi / 2, 1, 1, 100));
+
+    for (auto& f : {lh, lh_cube})
+    {
+        // near and far
+        CHECK(f.distance(4, v(0, 0, 5)) == Approx(4));
+        CHECK(f.distance(5, v(0, 0, 5)) == Approx(95));
+        // 90 degrees: the sides are at 45
+        CHECK(f.distance(0, v(0, 0, 5)) == Approx(5 / std::sqrt(2.f)));
+        CHECK(f.distance(1, v(5, 0, 5)) == Approx(0).epsilon(0.001));
+        CHECK(f.distance(3, v(0, 5, 5)) == Approx(0).epsilon(0.001));
+
+        CHECK(f.contains(v(0, 0, 50)));
+        CHECK(f.contains(v(-40, 40, 50)));
+        CHECK(!f.contains(v(0, 0, 0.5f)));
+        CHECK(!f.contains(v(0, 0, 101)));
+        CHECK(!f.contains(v(0, 0, -50)));
+        CHECK(!f.contains(v(60, 0, 50)));
+        CHECK(!f.contains(v(0, -60, 50)));
+    }
+
+    const auto rh = frustum::from_matrix_cube(matrix::perspective_fov_rh_cube(pi / 2, 1, 1, 100));
+    CHECK(rh.contains(v(0, 0, -50)));
+    CHECK(!rh.contains(v(0, 0, 50)));
+
+    // with a view
+    const auto view = matrix::look_at_lh(v(10, 0, 0), v(10, 0, 1), v(0, 1, 0));
+    const auto f = frustum::from_matrix(matrix::perspective_fov_lh(pi / 2, 1, 1, 100) * view);
+    CHECK(f.contains(v(10, 0, 50)));
+    CHECK(!f.contains(v(-50, 0, 50)));
+}
+
+TEST_CASE("objects")
+{
+    const auto f = frustum::from_matrix(matrix::ortho_lh(-10, 10, -10, 10, 0, 100));
+
+    CHECK(f.intersects(v(0, 0, 50), 1));
+    CHECK(f.intersects(v(11, 0, 50), 2));
+    CHECK(!f.intersects(v(13, 0, 50), 2));
+
+    using box = boxnt<3, float>;
+    CHECK(f.intersects(box::min_max(v(-1, -1, -1), v(1, 1, 1))));
+    CHECK(!f.intersects(box::min_max(v(-1, -1, -2), v(1, 1, -1))));
+    CHECK(f.intersects(box::min_max(v(-100, -100, -100), v(100, 100, 200))));
+    CHECK(!f.intersects(box::min_max(v(-100, 11, -100), v(100, 12, 200))));
+
+    // hints
+    uint8_t hint = 0;
+    CHECK(!f.intersects(v(0, 0, 150), 1, &hint));
+    CHECK(hint == 5);
+    CHECK(!f.intersects(v(0, 0, 150), 1, &hint));
+    CHECK(hint == 5);
+    CHECK(!f.intersects(v(-20, 0, 50), 1, &hint));
+    CHECK(hint == 0);
+    CHECK(f.intersects(v(0, 0, 50), 1, &hint));
+    CHECK(hint == 0);
+}
+
+namespace
+{
+template <typename T>
+void test_batch()
+{
+    using vec = vector3_t<T>;
+    using box = boxnt<3, T>;
+
+    const auto view = matrix4x4_t<T>::look_at_rh(vec::coord(1, 2, 3), vec::coord(5, -2, 20), vec::coord(0, 1, 0));
+    const auto f = frustum_t<T>::from_matrix(matrix4x4_t<T>::perspective_fov_rh(1, T(1.5), T(0.5), 30) * view);
+
+    std::minstd_rand rnd(31);
+    std::uniform_real_distribution<T> d(-30, 30);
+    std::uniform_real_distribution<T> size(0, 5);
+    auto rand_vec = [&]() { return vec::coord(d(rnd), d(rnd), d(rnd)); };
+
+    for (size_t count : {0, 1, 7, 8, 9, 31, 32, 33, 200})
+    {
+        std::vector<vec> centers;
+        std::vector<T> radii;
+        std::vector<box> boxes;
+        for (size_t i = 0; i < count; ++i)
+        {
+            centers.push_back(rand_vec());
+            radii.push_back(size(rnd));
+            boxes.push_back(box::pos_size(rand_vec(), vec::coord(size(rnd), size(rnd), size(rnd))));
+        }
+
+        const size_t words = (count + 31) / 32;
+        std::vector<uint32_t> hits(words + 1, 0xdeadbeef);
+        std::vector<uint8_t> hints(count, 0);
+
+        // the hint of a culled object must be a plane which culls it: testing with it keeps it
+        auto check_hint = [&](size_t i, auto test) {
+            uint8_t h = hints[i];
+            CHECK(h < 6);
+            CHECK(!test(&h));
+            CHECK(h == hints[i]);
+        };
+
+        // a few frames, so the hints are used
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            intersects(f, centers.data(), radii.data(), count, hits.data(), hints.data());
+            for (size_t i = 0; i < count; ++i)
+            {
+                const bool hit = hits[i / 32] & (1u << (i % 32));
+                CHECK(hit == f.intersects(centers[i], radii[i]));
+                if (!hit) check_hint(i, [&](uint8_t* h) { return f.intersects(centers[i], radii[i], h); });
+            }
+            if (count % 32) CHECK(hits[words - 1] >> (count % 32) == 0);
+            CHECK(hits[words] == 0xdeadbeef);
+
+            const auto h = hits;
+            intersects(f, centers.data(), radii.data(), count, hits.data());
+            CHECK(hits == h);
+
+            // move a little
+            for (auto& c : centers) c += vec::coord(T(0.5), 0, 0);
+        }
+
+        std::fill(hints.begin(), hints.end(), uint8_t(0));
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            intersects(f, boxes.data(), count, hits.data(), hints.data());
+            for (size_t i = 0; i < count; ++i)
+            {
+                const bool hit = hits[i / 32] & (1u << (i % 32));
+                CHECK(hit == f.intersects(boxes[i]));
+                if (!hit) check_hint(i, [&](uint8_t* h) { return f.intersects(boxes[i], h); });
+            }
+            CHECK(hits[words] == 0xdeadbeef);
+
+            const auto h = hits;
+            intersects(f, boxes.data(), count, hits.data());
+            CHECK(hits == h);
+
+            for (auto& b : boxes) b = box::min_max(b.min + vec::coord(0, T(0.5), 0), b.max + vec::coord(0, T(0.5), 0));
+        }
+    }
+}
+}
+
+TEST_CASE("batch")
+{
+    test_batch<float>();
+    test_batch<double>();
+}
@@ -0,0 +1,132 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/hash_grid.hpp"
+#include "common.hpp"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("hash_grid");
+
+TEST_CASE("empty")
+{
+    hash_grid<float> grid;
+    int found = 0;
+    grid.query_radius(v(0, 0, 0), 10, [&](uint32_t, float) { ++found; });
+    grid.query(boxnt<3, float>::min_max(v(-1, -1, -1), v(1, 1, 1)), [&](uint32_t) { ++found; });
+    CHECK(found == 0);
+
+    grid.build(nullptr, 0, 1);
+    CHECK(grid.size() == 0);
+    CHECK(grid.buckets() == 1);
+    grid.query_radius(v(0, 0, 0), 10, [&](uint32_t, float) { ++found; });
+    CHECK(found == 0);
+}
+
+namespace
+{
+template <typename T>
+void test_grid()
+{
+    using vec = vector3_t<T>;
+    using box = boxnt<3, T>;
+
+    std::minstd_rand rnd(17);
+    std::uniform_real_distribution<T> d(-20, 20);
+    auto rand_vec = [&]() { return vec::coord(d(rnd), d(rnd), d(rnd)); };
+
+    std::vector<vec> points;
+    for (int i = 0; i < 2000; ++i) points.push_back(rand_vec());
+    // points on the cell borders and duplicates
+    points[0] = vec::zero();
+    points[1] = vec::coord(2, -2, 4);
+    points[2] = points[3];
+
+    // few buckets, so many cells share them
+    for (size_t buckets : {0, 16})
+    {
+        hash_grid<T> grid(points.data(), points.size(), 2, buckets);
+        CHECK(grid.size() == points.size());
+        CHECK(grid.buckets() == (buckets ? buckets : 2048));
+        CHECK(grid.bucket_starts().back() == points.size());
+
+        // the contents are a permutation of the points sorted by bucket
+        auto idx = grid.indices();
+        for (size_t i = 0; i < idx.size(); ++i) CHECK(grid.points()[i] == points[idx[i]]);
+        std::sort(idx.begin(), idx.end());
+        for (size_t i = 0; i < idx.size(); ++i) CHECK(idx[i] == i);
+        for (size_t b = 0; b < grid.buckets(); ++b)
+        {
+            for (auto i = grid.bucket_starts()[b]; i < grid.bucket_starts()[b + 1]; ++i) CHECK(grid.bucket(grid.cells()[i]) == b);
+        }
+
+        for (int q = 0; q < 50; ++q)
+        {
+            const auto center = q == 0 ? points[0] : rand_vec();
+            const T radius = T(q % 5 + 1);
+
+            std::vector<uint32_t> found, expected;
+            grid.query_radius(center, radius, [&](uint32_t i, T d2) {
+                CHECK(d2 == distance_sq(points[i], center));
+                found.push_back(i);
+            });
+            for (uint32_t i = 0; i < points.size(); ++i)
+            {
+                if (distance_sq(points[i], center) <= radius * radius) expected.push_back(i);
+            }
+            std::sort(found.begin(), found.end());
+            CHECK(found == expected);
+
+            const auto b = box::pos_size(center, vec::coord(radius, 2 * radius, T(0.5)));
+            found.clear();
+            expected.clear();
+            grid.query(b, [&](uint32_t i) { found.push_back(i); });
+            for (uint32_t i = 0; i < points.size(); ++i)
+            {
+                if (b.is_inside(points[i])) expected.push_back(i);
+            }
+            std::sort(found.begin(), found.end());
+            CHECK(found == expected);
+        }
+    }
+}
+}
+
+TEST_CASE("queries")
+{
+    test_grid<float>();
+    test_grid<double>();
+}
+
+TEST_CASE("large ranges")
+{
+    using box = boxnt<3, float>;
+
+    // many more cells than buckets and points
+    const vector3 points[] = {v(0, 0, 0), v(1, -2, 0.5f), v(1e20f, 0, 0), v(-1e20f, 3e9f, 0)};
+    hash_grid<float> grid(points, 4, 0.01f);
+
+    // the cells of far points are clamped
+    CHECK(grid.cell_of(points[2]).x == INT32_MAX);
+    CHECK(grid.cell_of(points[3]).x == INT32_MIN);
+    CHECK(grid.cell_of(points[3]).y == INT32_MAX);
+
+    std::vector<uint32_t> found;
+    grid.query(box::min_max(v(-3, -3, -3), v(3, 3, 3)), [&](uint32_t i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    CHECK(found == std::vector<uint32_t>{0, 1});
+
+    found.clear();
+    grid.query_radius(v(0, 0, 0), 1e30f, [&](uint32_t i, float) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    CHECK(found == std::vector<uint32_t>{0, 1, 2, 3});
+
+    // as many cells as buckets on the last cell along x
+    found.clear();
+    grid.query(box::min_max(v(1e20f, -0.001f, -0.001f), v(3e38f, 0.001f, 0.001f)), [&](uint32_t i) { found.push_back(i); });
+    CHECK(found == std::vector<uint32_t>{2});
+}
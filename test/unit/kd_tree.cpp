@@ -0,0 +1,134 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/kd_tree.hpp"
+#include "common.hpp"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("kd_tree");
+
+TEST_CASE("basic")
+{
+    kd_tree<2, float> tree;
+    CHECK(tree.empty());
+    CHECK(tree.nearest(vector2::coord(1, 2)) == uint32_t(-1));
+
+    const vector2 points[] = {
+        vector2::coord(0, 0),
+        vector2::coord(10, 0),
+        vector2::coord(0, 10),
+        vector2::coord(10, 10),
+        vector2::coord(5, 5),
+    };
+    tree.build(points, 5);
+    CHECK(tree.size() == 5);
+    CHECK(tree.depth() == 1); // a single leaf
+
+    float d2;
+    CHECK(tree.nearest(vector2::coord(6, 6), d2) == 4);
+    CHECK(d2 == 2);
+    CHECK(tree.nearest(vector2::coord(9, 1)) == 1);
+    CHECK(tree.nearest(vector2::coord(9, 1), d2, 1) == uint32_t(-1));
+    CHECK(d2 == 1);
+
+    uint32_t idx[3];
+    float dist[3];
+    CHECK(tree.nearest_k(vector2::coord(1, 2), 3, idx, dist) == 3);
+    CHECK(idx[0] == 0);
+    CHECK(dist[0] == 5);
+    CHECK(idx[1] == 4);
+    CHECK(idx[2] == 2);
+    CHECK(tree.nearest_k(vector2::coord(1, 2), 3, idx, dist, 40) == 2);
+
+    std::vector<uint32_t> found;
+    tree.query_radius(vector2::coord(5, 0), 5, [&](uint32_t i, float d) {
+        CHECK(d == 25);
+        found.push_back(i);
+    });
+    std::sort(found.begin(), found.end());
+    CHECK(found == std::vector<uint32_t>{0, 1, 4});
+}
+
+namespace
+{
+template <size_t D, typename T>
+void test_tree(size_t count)
+{
+    using vec = typename dim<D>::template vector_t<T>;
+
+    std::minstd_rand rnd(23);
+    std::uniform_real_distribution<T> d(-10, 10);
+    auto rand_vec = [&]() {
+        vec ret;
+        for (size_t i = 0; i < D; ++i) ret.at(i) = d(rnd);
+        return ret;
+    };
+
+    std::vector<vec> points;
+    for (size_t i = 0; i < count; ++i) points.push_back(rand_vec());
+    // duplicates and points on a line
+    for (size_t i = 0; i + 1 < count; i += 17) points[i + 1] = points[i];
+    for (size_t i = 2; i < count; i += 13) points[i].at(0) = 1;
+
+    kd_tree<D, T> tree(points.data(), count);
+    CHECK(tree.size() == count);
+    CHECK(tree.depth() <= int(std::log2(std::max(count, size_t(1)))) + 1);
+
+    // the tree order is a permutation and the nodes split their ranges
+    auto idx = tree.indices();
+    for (size_t i = 0; i < count; ++i) CHECK(tree.points()[i] == points[idx[i]]);
+    std::sort(idx.begin(), idx.end());
+    for (size_t i = 0; i < count; ++i) CHECK(idx[i] == i);
+
+    std::vector<uint32_t> knn(8);
+    std::vector<T> knn_d2(8);
+    for (int q = 0; q < 100; ++q)
+    {
+        const auto p = q < 5 ? points[size_t(q) % count] : rand_vec();
+
+        std::vector<std::pair<T, uint32_t>> expected;
+        for (uint32_t i = 0; i < count; ++i) expected.push_back({distance_sq(points[i], p), i});
+        std::sort(expected.begin(), expected.end());
+
+        T d2;
+        const auto n = tree.nearest(p, d2);
+        CHECK(d2 == expected[0].first);
+        CHECK(distance_sq(points[n], p) == d2);
+
+        const size_t k = std::min(count, size_t(8));
+        CHECK(tree.nearest_k(p, 8, knn.data(), knn_d2.data()) == k);
+        for (size_t i = 0; i < k; ++i)
+        {
+            CHECK(knn_d2[i] == expected[i].first);
+            CHECK(distance_sq(points[knn[i]], p) == knn_d2[i]);
+        }
+
+        const T radius = T(q % 4 + 1);
+        std::vector<uint32_t> found, in_radius;
+        tree.query_radius(p, radius, [&](uint32_t i, T) { found.push_back(i); });
+        for (auto& e : expected)
+        {
+            if (e.first <= radius * radius) in_radius.push_back(e.second);
+        }
+        std::sort(found.begin(), found.end());
+        std::sort(in_radius.begin(), in_radius.end());
+        CHECK(found == in_radius);
+    }
+}
+}
+
+TEST_CASE("queries")
+{
+    for (size_t count : {1, 2, 3, 10, 1000})
+    {
+        test_tree<2, float>(count);
+        test_tree<3, float>(count);
+        test_tree<3, double>(count);
+    }
+}
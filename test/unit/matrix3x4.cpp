@@ -5,6 +5,8 @@
 #include "common.hpp"
 #include "yama/ext/ostream.hpp"
 
+#include <algorithm>
+
 using namespace yama;
 using doctest::Approx;
 
@@ -214,6 +216,11 @@ TEST_CASE("special_construction")
     m0.m00 = 2; m0.m11 = 4; m0.m22 = 6;
     CHECK(m0 == matrix3x4::scaling(2, 4, 6));
     CHECK(m0 == matrix3x4::scaling(v(2, 4, 6)));
+
+    auto q = quaternion::rotation_axis(v(1, -2, 3), 0.7f);
+    m0 = matrix3x4::translation_rotation_scaling(v(3, -1, 0.5f), q, v(2, 3, 4));
+    CHECK(YamaApprox(m0) ==
+        matrix3x4::translation(3, -1, 0.5f) * matrix3x4::rotation_quaternion(q) * matrix3x4::scaling(2, 3, 4));
 }
 
 TEST_CASE("access")
@@ -453,6 +460,26 @@ TEST_CASE("ops")
     CHECK(YamaApprox(m2 * m1) == matrix3x4::identity());
 }
 
+TEST_CASE("rigid inverse")
+{
+    auto i = matrix3x4::identity();
+    i.inverse_rigid();
+    CHECK(i == matrix3x4::identity());
+
+    const auto rigid = matrix3x4::translation(3, -1, 0.5f) * matrix3x4::rotation_axis(v(1, -2, 3), 0.7f);
+    const auto ref = inverse(rigid);
+
+    auto m = rigid;
+    m.inverse_rigid();
+    CHECK(YamaApprox(m) == ref);
+    CHECK(YamaApprox(inverse_rigid(rigid)) == ref);
+    CHECK(YamaApprox(inverse_rigid(rigid) * rigid) == matrix3x4::identity());
+
+    const auto affine = rigid * matrix3x4::scaling(2, -3, 4);
+    CHECK(YamaApprox(inverse(affine) * affine) == matrix3x4::identity());
+    CHECK(YamaApprox(affine * inverse(affine)) == matrix3x4::identity());
+}
+
 TEST_CASE("transform")
 {
     const auto i = matrix3x4::identity();
@@ -542,3 +569,80 @@ TEST_CASE("transform")
     CHECK(YamaApprox(transform_coord(v(1, 2, 3), m0)) == v(-1, -2, -3));
     CHECK(YamaApprox(transform_normal(v(1, 2, 3), m0)) == v(-1, -2, -3));
 }
+
+TEST_CASE("batch transform")
+{
+    vector3 vs[19];
+    for (int i = 0; i < 19; ++i)
+    {
+        vs[i] = v(float(i) - 9, float(i % 5) * 0.5f, 3 - float(i % 7));
+    }
+
+    const auto m = matrix3x4::translation(3, -1, 0.5f) * matrix3x4::rotation_axis(v(1, -2, 3), 0.7f) * matrix3x4::scaling(2, 3, 4);
+
+    for (size_t count = 0; count <= 19; ++count)
+    {
+        vector3 out[19];
+        transform_coord(vs, count, m, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(YamaApprox(out[i]) == transform_coord(vs[i], m));
+        }
+
+        transform_normal(vs, count, m, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(YamaApprox(out[i]) == transform_normal(vs[i], m));
+        }
+    }
+
+    // in place
+    vector3 out[19];
+    std::copy(vs, vs + 19, out);
+    transform_normal(out, 19, m, out);
+    for (size_t i = 0; i < 19; ++i)
+    {
+        CHECK(YamaApprox(out[i]) == transform_normal(vs[i], m));
+    }
+}
+
+TEST_CASE("batch translation_rotation_scaling")
+{
+    vector3 ts[11], ss[11];
+    quaternion qs[11];
+    for (int i = 0; i < 11; ++i)
+    {
+        const float f = float(i);
+        ts[i] = v(f - 5, f * 0.5f, 1);
+        ss[i] = v(1 + f * 0.1f, 2 - f * 0.1f, 0.5f);
+        qs[i] = quaternion::rotation_axis(v(std::sin(f), 1, std::cos(f)), f * 0.6f);
+    }
+
+    for (size_t count = 0; count <= 11; ++count)
+    {
+        matrix3x4 out[11];
+        translation_rotation_scaling(ts, qs, ss, count, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(YamaApprox(out[i]) == matrix3x4::translation_rotation_scaling(ts[i], qs[i], ss[i]));
+        }
+    }
+
+    matrix3x4 out[11];
+    translation_rotation_scaling(nullptr, qs, ss, 11, out);
+    for (size_t i = 0; i < 11; ++i)
+    {
+        CHECK(YamaApprox(out[i]) == matrix3x4::rotation_quaternion(qs[i]) * matrix3x4::scaling(ss[i]));
+    }
+
+    translation_rotation_scaling(ts, qs, nullptr, 11, out);
+    for (size_t i = 0; i < 11; ++i)
+    {
+        CHECK(YamaApprox(out[i]) == matrix3x4::translation(ts[i]) * matrix3x4::rotation_quaternion(qs[i]));
+    }
+
+    const auto qd = quaternion_t<double>::rotation_z(0.5);
+    matrix3x4_t<double> outd;
+    translation_rotation_scaling(nullptr, &qd, nullptr, 1, &outd);
+    CHECK(YamaApprox(outd) == matrix3x4_t<double>::rotation_quaternion(qd));
+}
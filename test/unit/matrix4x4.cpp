@@ -5,6 +5,8 @@
 #include "common.hpp"
 #include "yama/ext/ostream.hpp"
 
+#include <algorithm>
+
 using namespace yama;
 using doctest::Approx;
 
@@ -675,3 +677,234 @@ TEST_CASE("camera")
     vec0 = v(0, 0, -10);
     CHECK(YamaApprox(transform_coord(vec0, p)) == v(0, 0, 1));
 }
+
+#if YAMA_SIMD_SSE
+TEST_CASE("simd mul")
+{
+    const auto a = matrix::rows(
+        0.1f, 0.2f, -0.3f, 0.4f,
+        0.5f, -0.6f, 0.7f, 0.8f,
+        0.9f, 1, 0.25f, -1.2f,
+        -1.3f, 1.4f, 1.5f, 1.6f
+    );
+    const auto b = matrix::rotation_axis(v(1, -2, 3), 0.7f) * matrix::translation(3, -1, 0.5f) * matrix::scaling(2, 3, 4);
+
+    const auto ref = (a.as_matrix4x4_t<double>() * b.as_matrix4x4_t<double>()).as_matrix4x4_t<float>();
+    CHECK(YamaApprox(a * b) == ref);
+
+    matrix m = a;
+    m *= b;
+    CHECK(YamaApprox(m) == ref);
+
+    simd::matrix4x4_mul_sse(m.data(), a.data(), b.data());
+    CHECK(YamaApprox(m) == ref);
+
+    // aliasing
+    m = a;
+    simd::matrix4x4_mul_sse(m.data(), m.data(), b.data());
+    CHECK(YamaApprox(m) == ref);
+    m = b;
+    simd::matrix4x4_mul_sse(m.data(), a.data(), m.data());
+    CHECK(YamaApprox(m) == ref);
+
+#if YAMA_SIMD_AVX
+    simd::matrix4x4_mul_avx(m.data(), a.data(), b.data());
+    CHECK(YamaApprox(m) == ref);
+    m = a;
+    simd::matrix4x4_mul_avx(m.data(), m.data(), b.data());
+    CHECK(YamaApprox(m) == ref);
+    m = b;
+    simd::matrix4x4_mul_avx(m.data(), a.data(), m.data());
+    CHECK(YamaApprox(m) == ref);
+#endif
+
+    simd::matrix4x4_mul(m.data(), a.data(), b.data());
+    CHECK(YamaApprox(m) == ref);
+}
+#endif
+
+TEST_CASE("bulk inverse")
+{
+    matrix ms[5] = {
+        matrix::identity(),
+        matrix::rows(1, 2, 3, 4, 5, 3, 2, 2, 2, 1, 1, 1, 5, 6, 10, 2),
+        matrix::rows(3, 22, 12, 5, 17, 8, 24, 6, 19, 27, 3, 7, 10, 7, 11, 8),
+        matrix::rotation_axis(v(1, -2, 3), 0.7f) * matrix::translation(3, -1, 0.5f),
+        matrix::perspective_fov_rh(1, 1.5f, 1, 100),
+    };
+    matrix inv[5];
+    inverse(ms, 5, inv);
+    for (int i = 0; i < 5; ++i)
+    {
+        CHECK(YamaApprox(ms[i] * inv[i]) == matrix::identity());
+    }
+
+    // in place
+    inverse(ms, 5, ms);
+    for (int i = 0; i < 5; ++i)
+    {
+        CHECK(YamaApprox(ms[i]) == inv[i]);
+    }
+
+    auto md = matrix4x4_t<double>::rows(3, 22, 12, 5, 17, 8, 24, 6, 19, 27, 3, 7, 10, 7, 11, 8);
+    matrix4x4_t<double> mdi;
+    inverse(&md, 1, &mdi);
+    CHECK(YamaApprox(md * mdi) == matrix4x4_t<double>::identity());
+}
+
+#if YAMA_SIMD_SSE
+TEST_CASE("simd inverse")
+{
+    const matrix ms[4] = {
+        matrix::rows(1, 2, 3, 4, 5, 3, 2, 2, 2, 1, 1, 1, 5, 6, 10, 2),
+        matrix::rows(3, 22, 12, 5, 17, 8, 24, 6, 19, 27, 3, 7, 10, 7, 11, 8),
+        matrix::rotation_axis(v(1, -2, 3), 0.7f) * matrix::translation(3, -1, 0.5f) * matrix::scaling(2, 3, 4),
+        matrix::perspective_fov_lh_cube(1, 1.5f, 1, 100),
+    };
+
+    for (auto& m : ms)
+    {
+        const auto md = m.as_matrix4x4_t<double>();
+        const auto ref = inverse(md).as_matrix4x4_t<float>();
+        const auto det = float(md.determinant());
+
+        CHECK(Approx(simd::matrix4x4_determinant_sse(m.data())) == det);
+
+        matrix i;
+        CHECK(Approx(simd::matrix4x4_inverse_sse(i.data(), m.data())) == det);
+        CHECK(YamaApprox(i) == ref);
+
+        // aliasing
+        i = m;
+        CHECK(Approx(simd::matrix4x4_inverse_sse(i.data(), i.data())) == det);
+        CHECK(YamaApprox(i) == ref);
+    }
+
+    CHECK(simd::matrix4x4_determinant_sse(ms[0].data()) == 43);
+    CHECK(simd::matrix4x4_determinant_sse(ms[1].data()) == 47634);
+
+    matrix i[4];
+#if YAMA_SIMD_AVX
+    simd::matrix4x4_inverse2_avx(i[0].data(), ms[0].data());
+    CHECK(YamaApprox(i[0]) == inverse(ms[0]));
+    CHECK(YamaApprox(i[1]) == inverse(ms[1]));
+#endif
+
+    simd::matrix4x4_inverse(i[0].data(), ms[0].data(), 3);
+    for (int j = 0; j < 3; ++j)
+    {
+        CHECK(YamaApprox(i[j]) == inverse(ms[j]));
+    }
+}
+#endif
+
+TEST_CASE("affine inverse")
+{
+    CHECK(matrix::identity().is_affine());
+    CHECK(matrix::translation(1, 2, 3).is_affine());
+    CHECK(!matrix::perspective_fov_lh(1, 1.5f, 1, 100).is_affine());
+
+    auto i = matrix::identity();
+    i.inverse_affine();
+    CHECK(i == matrix::identity());
+    i.inverse_rigid();
+    CHECK(i == matrix::identity());
+
+    const auto rigid = matrix::translation(3, -1, 0.5f) * matrix::rotation_axis(v(1, -2, 3), 0.7f);
+    const auto affine = rigid * matrix::scaling(2, -3, 4) * matrix::rotation_x(0.2f);
+    const auto projective = matrix::perspective_fov_rh(1, 1.5f, 1, 100) * affine;
+
+    float det_ref, det;
+    auto ref = inverse(affine, det_ref);
+
+    auto m = affine;
+    det = m.inverse_affine();
+    CHECK(Approx(det) == det_ref);
+    CHECK(YamaApprox(m) == ref);
+    CHECK(m.is_affine());
+    CHECK(YamaApprox(inverse_affine(affine, det)) == ref);
+    CHECK(Approx(det) == det_ref);
+    CHECK(YamaApprox(inverse_affine(affine) * affine) == matrix::identity());
+
+    m = affine;
+    det = m.inverse_auto();
+    CHECK(Approx(det) == det_ref);
+    CHECK(YamaApprox(m) == ref);
+
+    ref = inverse(projective, det_ref);
+    CHECK(YamaApprox(inverse_auto(projective, det)) == ref);
+    CHECK(Approx(det) == det_ref);
+
+    ref = inverse(rigid);
+    m = rigid;
+    m.inverse_rigid();
+    CHECK(YamaApprox(m) == ref);
+    CHECK(YamaApprox(inverse_rigid(rigid)) == ref);
+    CHECK(YamaApprox(inverse_auto(rigid)) == ref);
+
+    // reflections are rigid too
+    const auto mirror = matrix::scaling(1, -1, 1) * rigid;
+    CHECK(YamaApprox(inverse_rigid(mirror) * mirror) == matrix::identity());
+}
+
+TEST_CASE("batch transform")
+{
+    vector3 vs[19];
+    for (int i = 0; i < 19; ++i)
+    {
+        vs[i] = v(float(i) - 9, float(i % 5) * 0.5f, 3 - float(i % 7));
+    }
+
+    const matrix ms[2] = {
+        matrix::translation(3, -1, 0.5f) * matrix::rotation_axis(v(1, -2, 3), 0.7f) * matrix::scaling(2, 3, 4),
+        matrix::perspective_fov_rh(1, 1.5f, 1, 100) * matrix::translation(0, 0, -30),
+    };
+
+    for (auto& m : ms)
+    {
+        // all counts to cover the tail
+        for (size_t count = 0; count <= 19; ++count)
+        {
+            vector3 out[19];
+            transform_coord(vs, count, m, out);
+            for (size_t i = 0; i < count; ++i)
+            {
+                CHECK(YamaApprox(out[i]) == transform_coord(vs[i], m));
+            }
+
+            transform_normal(vs, count, m, out);
+            for (size_t i = 0; i < count; ++i)
+            {
+                CHECK(YamaApprox(out[i]) == transform_normal(vs[i], m));
+            }
+        }
+
+        // in place
+        vector3 out[19];
+        std::copy(vs, vs + 19, out);
+        transform_coord(out, 19, m, out);
+        for (size_t i = 0; i < 19; ++i)
+        {
+            CHECK(YamaApprox(out[i]) == transform_coord(vs[i], m));
+        }
+
+        // all pack widths
+        auto check_kernel = [&](auto pack) {
+            using P = decltype(pack);
+            simd::transform_coord<4, P>(m.data(), vs[0].data(), 19, out[0].data(), !m.is_affine());
+            for (size_t i = 0; i < 19; ++i)
+            {
+                CHECK(YamaApprox(out[i]) == transform_coord(vs[i], m));
+            }
+        };
+        check_kernel(simd::f32x4{});
+        check_kernel(simd::f32x8{});
+        check_kernel(simd::basic_f32_pack<4>{});
+    }
+
+    matrix4x4_t<double> md = matrix4x4_t<double>::perspective_fov_rh(1, 1.5, 1, 100);
+    vector3_t<double> vd[2] = {{1, 2, -10}, {3, 1, -20}};
+    vector3_t<double> od[2];
+    transform_coord(vd, 2, md, od);
+    CHECK(YamaApprox(od[1]) == transform_coord(vd[1], md));
+}
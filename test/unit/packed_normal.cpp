@@ -0,0 +1,128 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/packed_normal.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("packed_normal");
+
+namespace
+{
+template <typename T>
+std::vector<vector3_t<T>> random_normals(size_t count)
+{
+    std::minstd_rand rnd(3);
+    std::normal_distribution<T> d;
+    std::vector<vector3_t<T>> ret;
+    while (ret.size() < count)
+    {
+        const auto n = vector3_t<T>::coord(d(rnd), d(rnd), d(rnd));
+        if (n.length() < T(0.01)) continue;
+        ret.push_back(normalize(n));
+    }
+    return ret;
+}
+
+// in degrees
+template <typename T>
+double angle(const vector3_t<T>& a, const vector3_t<T>& b)
+{
+    return std::acos(std::min(1.0, double(dot(a, b)))) * 180 / constants_t<double>::PI;
+}
+
+template <int Bits>
+void test_error(double max_angle, double max_precise_angle)
+{
+    using packed = packed_normal_t<Bits>;
+    double max = 0, max_precise = 0;
+    for (auto& n : random_normals<double>(50000))
+    {
+        const auto u = packed::pack(n).template unpack<double>();
+        const auto p = packed::pack_precise(n).template unpack<double>();
+        CHECK(u.length() == doctest::Approx(1));
+        CHECK(dot(p, n) >= dot(u, n));
+        max = std::max(max, angle(u, n));
+        max_precise = std::max(max_precise, angle(p, n));
+    }
+    CHECK(max <= max_angle);
+    CHECK(max_precise <= max_precise_angle);
+}
+}
+
+TEST_CASE("pack")
+{
+    static_assert(sizeof(packed_normal16) == 2, "16 bits");
+    static_assert(sizeof(packed_normal32) == 4, "32 bits");
+
+    // the axes are exact
+    const vector3 axes[] = {v(1, 0, 0), v(-1, 0, 0), v(0, 1, 0), v(0, -1, 0), v(0, 0, 1), v(0, 0, -1)};
+    for (auto& a : axes)
+    {
+        CHECK(packed_normal16::pack(a).unpack() == a);
+        CHECK(packed_normal32::pack(a).unpack() == a);
+        CHECK(packed_normal16::pack_precise(a).unpack() == a);
+    }
+    CHECK(packed_normal16::pack(v(0, 0, 1)) == packed_normal16{0, 0});
+    CHECK(packed_normal16::pack(v(1, 0, 0)) == packed_normal16{127, 0});
+    CHECK(packed_normal32::pack(v(0, -1, 0)) == packed_normal32{0, -32767});
+    CHECK(packed_normal32::pack(v(0, 0, -1)) == packed_normal32{32767, 32767});
+
+    // not normalized
+    CHECK(packed_normal16::pack(v(0, 3, 4)) == packed_normal16::pack(v(0, 0.6f, 0.8f)));
+    CHECK(packed_normal16::pack(v(0, 3, 4)).unpack() == YamaApprox(v(0, 0.6f, 0.8f)).epsilon(0.02f));
+
+    test_error<16>(0.96, 0.64);
+    test_error<32>(0.0037, 0.0025);
+}
+
+namespace
+{
+template <int Bits, typename T>
+void test_batch()
+{
+    using packed = packed_normal_t<Bits>;
+    auto ns = random_normals<T>(100);
+    // the folds of the octahedron
+    ns[0] = vector3_t<T>::coord(0, 0, -1);
+    ns[1] = normalize(vector3_t<T>::coord(-1, 1, 0));
+    ns[2] = normalize(vector3_t<T>::coord(-1, -2, -1));
+    ns[3] = vector3_t<T>::coord(0, -1, 0);
+
+    for (size_t count : {0, 1, 3, 4, 5, 8, 9, 17, 100})
+    {
+        std::vector<packed> p(count + 1, packed{1, 2}), pp(count + 1, packed{1, 2});
+        pack(ns.data(), count, p.data());
+        pack_precise(ns.data(), count, pp.data());
+        CHECK(p.back() == packed{1, 2});
+        CHECK(pp.back() == packed{1, 2});
+
+        std::vector<vector3_t<T>> u(count + 1, vector3_t<T>::zero());
+        unpack(p.data(), count, u.data());
+        CHECK(u.back() == vector3_t<T>::zero());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(p[i] == packed::pack(ns[i]));
+            CHECK(u[i] == YamaApprox(p[i].template unpack<T>()).epsilon(T(1e-6)));
+
+            // the precise codes may differ when candidates are equally close
+            const auto precise = packed::pack_precise(ns[i]).template unpack<T>();
+            CHECK(dot(pp[i].template unpack<T>(), ns[i]) == doctest::Approx(dot(precise, ns[i])).epsilon(1e-6));
+        }
+    }
+}
+}
+
+TEST_CASE("batch")
+{
+    test_batch<16, float>();
+    test_batch<32, float>();
+    test_batch<16, double>();
+    test_batch<32, double>();
+}
@@ -0,0 +1,131 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/packed_quaternion.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("packed_quaternion");
+
+namespace
+{
+// the largest difference of the components of a and b or -b
+template <typename T>
+T component_error(const quaternion_t<T>& a, const quaternion_t<T>& b)
+{
+    T pos = 0, neg = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        pos = std::max(pos, std::abs(a[i] - b[i]));
+        neg = std::max(neg, std::abs(a[i] + b[i]));
+    }
+    return std::min(pos, neg);
+}
+
+template <typename T>
+std::vector<quaternion_t<T>> random_quaternions(size_t count)
+{
+    std::minstd_rand rnd(5);
+    std::uniform_real_distribution<T> d(-1, 1);
+    std::vector<quaternion_t<T>> ret;
+    while (ret.size() < count)
+    {
+        auto q = quaternion_t<T>::xyzw(d(rnd), d(rnd), d(rnd), d(rnd));
+        const T len = q.length();
+        if (len < T(0.1)) continue;
+        ret.push_back(q / len);
+    }
+    return ret;
+}
+
+template <int Bits, typename T>
+void test_error()
+{
+    using packed = packed_quaternion_t<Bits>;
+    T max_error = 0;
+    for (auto& q : random_quaternions<T>(20000))
+    {
+        const auto u = packed::pack(q).template unpack<T>();
+        CHECK(u.length() == doctest::Approx(1).epsilon(1e-5));
+        max_error = std::max(max_error, component_error(q, u));
+    }
+    CHECK(max_error <= packed::max_error);
+    CHECK(max_error > packed::max_error / 3); // the bound is not too loose
+}
+}
+
+TEST_CASE("pack")
+{
+    static_assert(sizeof(packed_quaternion32) == 4, "32 bits");
+    static_assert(sizeof(packed_quaternion48) == 6, "48 bits");
+    CHECK(packed_quaternion32::component_bits == 10);
+    CHECK(packed_quaternion48::component_bits == 15);
+
+    const auto id = packed_quaternion32::pack(quaternion::identity());
+    CHECK(id.unpack() == YamaApprox(quaternion::identity()).epsilon(packed_quaternion32::max_error));
+    CHECK(id == packed_quaternion32::pack(quaternion::xyzw(0, 0, 0, -1)));
+    CHECK(id != packed_quaternion32::pack(quaternion::xyzw(0, 0, 1, 0)));
+
+    // the largest is made positive
+    const auto q = normalize(quaternion::xyzw(0.1f, -0.9f, 0.2f, 0.3f));
+    const auto u = packed_quaternion48::pack(q).unpack();
+    CHECK(u == YamaApprox(-q).epsilon(packed_quaternion48::max_error));
+    CHECK(u.y > 0);
+
+    // the first one of equal components is the largest
+    const auto half = packed_quaternion32::pack(quaternion::xyzw(0.5f, 0.5f, -0.5f, 0.5f));
+    CHECK(half.words[1] >> 14 == 0);
+    CHECK(half.unpack() == YamaApprox(quaternion::xyzw(0.5f, 0.5f, -0.5f, 0.5f)).epsilon(packed_quaternion32::max_error));
+
+    // a smaller component at the end of the range: z and w are 1/sqrt(2)
+    const auto r = quaternion::rotation_z(constants::PI_HALF);
+    CHECK(packed_quaternion32::pack(r).unpack() == YamaApprox(r).epsilon(packed_quaternion32::max_error));
+
+    test_error<32, float>();
+    test_error<48, float>();
+    test_error<32, double>();
+    test_error<48, double>();
+}
+
+namespace
+{
+template <int Bits, typename T>
+void test_batch()
+{
+    using packed = packed_quaternion_t<Bits>;
+    const auto qs = random_quaternions<T>(100);
+
+    for (size_t count : {0, 1, 3, 4, 5, 8, 9, 17, 100})
+    {
+        std::vector<packed> p(count + 1);
+        p.back() = packed::pack(quaternion_t<T>::identity());
+        const auto guard = p.back();
+        pack(qs.data(), count, p.data());
+        CHECK(p.back() == guard);
+
+        std::vector<quaternion_t<T>> u(count + 1, quaternion_t<T>::zero());
+        unpack(p.data(), count, u.data());
+        CHECK(u.back() == quaternion_t<T>::zero());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(p[i] == packed::pack(qs[i]));
+            CHECK(u[i] == YamaApprox(p[i].template unpack<T>()).epsilon(T(1e-6)));
+            CHECK(component_error(qs[i], u[i]) <= packed::max_error);
+        }
+    }
+}
+}
+
+TEST_CASE("batch")
+{
+    test_batch<32, float>();
+    test_batch<48, float>();
+    test_batch<32, double>();
+    test_batch<48, double>();
+}
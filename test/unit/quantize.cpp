@@ -0,0 +1,132 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/quantize.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+#include <cmath>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("quantize");
+
+TEST_CASE("basic")
+{
+    static_assert(std::is_same<quantized_t<8>, uint8_t>::value, "8 bits");
+    static_assert(std::is_same<quantized_t<10>, uint16_t>::value, "10 bits");
+    static_assert(std::is_same<quantized_t<16>, uint16_t>::value, "16 bits");
+    static_assert(std::is_same<quantized_t<20>, uint32_t>::value, "20 bits");
+
+    const auto b = boxnt<3, float>::min_max(v(-1, 0, 10), v(1, 4, 10));
+    CHECK(quantization_error(b) == YamaApprox(v(1.f / 65535, 2.f / 65535, 0)));
+    CHECK(quantization_error<8>(b) == YamaApprox(v(1.f / 255, 2.f / 255, 0)));
+
+    const vector3 p[] = {
+        v(-1, 0, 10),
+        v(1, 4, 10),
+        v(0, 2, 10),
+        v(-2, 5, 11), // outside: clamped
+    };
+
+    uint16_t q[12];
+    auto e = quantize(b, p, 4, q);
+    CHECK(q[0] == 0);
+    CHECK(q[1] == 0);
+    CHECK(q[2] == 0); // zero size
+    CHECK(q[3] == 65535);
+    CHECK(q[4] == 65535);
+    CHECK(q[5] == 0);
+    CHECK(q[6] == 32768); // 32767.5 rounds to even
+    CHECK(q[7] == 32768);
+    CHECK(q[9] == 0);
+    CHECK(q[10] == 65535);
+    CHECK(q[11] == 0);
+    CHECK(e == YamaApprox(v(1, 1, 1)));
+
+    vector3 u[4];
+    dequantize(b, q, 4, u);
+    CHECK(u[0] == YamaApprox(v(-1, 0, 10)));
+    CHECK(u[1] == YamaApprox(v(1, 4, 10)));
+    CHECK(u[2] == YamaApprox(p[2]).epsilon(quantization_error(b).y));
+    CHECK(u[3] == YamaApprox(v(-1, 4, 10)));
+
+    // inside the box
+    e = quantize(b, p, 3, q);
+    CHECK(e.x <= quantization_error(b).x);
+    CHECK(e.y <= quantization_error(b).y);
+    CHECK(e.z == 0);
+}
+
+namespace
+{
+template <int Bits, typename T>
+void test_batch()
+{
+    const auto b = boxnt<3, T>::min_max(vector3_t<T>::coord(-100, 3, -0.5), vector3_t<T>::coord(50, 4, 0.5));
+    const auto bound = quantization_error<Bits>(b);
+    const T qmax = T((uint64_t(1) << Bits) - 1);
+    // allow for the rounding of the floats themselves
+    // (the scale is rounded too, which moves the codes by up to size * epsilon at the highest bit counts)
+    vector3_t<T> ulp;
+    for (size_t k = 0; k < 3; ++k) ulp[k] = (std::max(std::abs(b.min[k]), std::abs(b.max[k])) + b.size()[k]) * std::numeric_limits<T>::epsilon();
+
+    std::minstd_rand rnd(7);
+    std::uniform_real_distribution<T> d(0, 1);
+    std::vector<vector3_t<T>> ps(100);
+    for (auto& p : ps)
+    {
+        for (size_t k = 0; k < 3; ++k) p[k] = b.min[k] + d(rnd) * b.size()[k];
+    }
+    // the corners of the box get the extreme codes
+    ps[2] = b.max;
+    ps[4] = b.min;
+    ps[7] = vector3_t<T>::coord(b.max.x, b.min.y, b.max.z);
+
+    for (size_t count : {0, 1, 3, 4, 5, 8, 9, 17, 100})
+    {
+        std::vector<quantized_t<Bits>> q(3 * count + 1, 42);
+        const auto e = quantize<Bits>(b, ps.data(), count, q.data());
+        CHECK(q.back() == 42);
+
+        std::vector<vector3_t<T>> u(count + 1, vector3_t<T>::zero());
+        dequantize<Bits>(b, q.data(), count, u.data());
+        CHECK(u.back() == vector3_t<T>::zero());
+
+        vector3_t<T> max_error = vector3_t<T>::zero();
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const T s = b.size()[k];
+                const T ref = std::nearbyint(std::fmin(std::fmax((ps[i][k] - b.min[k]) * (qmax / s), T(0)), qmax));
+                CHECK(q[3 * i + k] == quantized_t<Bits>(ref));
+                CHECK(std::abs(u[i][k] - (b.min[k] + ref * (s / qmax))) <= 2 * ulp[k]);
+                max_error[k] = std::max(max_error[k], std::abs(u[i][k] - ps[i][k]));
+            }
+        }
+
+        if (count > 2) CHECK(q[6] == quantized_t<Bits>(qmax));
+
+        for (size_t k = 0; k < 3; ++k)
+        {
+            CHECK(e[k] == doctest::Approx(max_error[k]).epsilon(T(1e-3)));
+            CHECK(e[k] <= bound[k] + ulp[k]);
+        }
+    }
+}
+}
+
+TEST_CASE("batch")
+{
+    test_batch<16, float>();
+    test_batch<8, float>();
+    test_batch<12, float>();
+    test_batch<20, float>();
+    test_batch<22, float>();
+    test_batch<16, double>();
+    test_batch<24, double>();
+    test_batch<32, double>();
+}
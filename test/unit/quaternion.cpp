@@ -5,6 +5,8 @@
 #include "common.hpp"
 #include "yama/ext/quaternion_ostream.hpp"
 #include "yama/ext/vector3_ostream.hpp"
+#include <vector>
+#include <algorithm>
 
 using namespace yama;
 using doctest::Approx;
@@ -385,6 +387,74 @@ TEST_CASE("ops")
 
     CHECK(YamaApprox(q0) ==
         quaternion::xyzw(0.30942556881258626f, 0.527364923066248f, 0.33413672218578583f, 0.6741185090656765f));
+
+    // shorter arc
+    q1 = quaternion::rotation_z(0.2f);
+    q2 = quaternion::rotation_z(0.8f);
+    CHECK(YamaApprox(slerp(q1, -q2, 0.5f)) == quaternion::rotation_z(0.5f));
+    CHECK(YamaApprox(nlerp(q1, -q2, 0.5f)) == quaternion::rotation_z(0.5f));
+    CHECK(YamaApprox(nlerp(q1, q2, 0.f)) == q1);
+
+    // same rotation
+    CHECK(YamaApprox(slerp(q1, q1, 0.3f)) == q1);
+    CHECK(YamaApprox(slerp(q1, -q1, 0.3f)) == q1);
+}
+
+TEST_CASE("batch slerp")
+{
+    std::vector<quaternion> from, to;
+    std::vector<float> ratios;
+    for (int i = 0; i < 19; ++i)
+    {
+        const float f = float(i);
+        auto axis = normalize(vector3::coord(std::sin(f), std::cos(f * 2), 0.5f));
+        from.push_back(quaternion::rotation_axis(axis, f * 0.3f));
+        // a mix of small and large angles, some on the longer arc
+        auto b = from.back() * quaternion::rotation_x(i % 3 ? f * 0.2f : 0.001f);
+        to.push_back(i % 2 ? -b : b);
+        ratios.push_back(f / 18);
+    }
+
+    std::vector<quaternion> out(from.size());
+
+    slerp(from.data(), to.data(), from.size(), 0.3f, out.data());
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        CHECK(YamaApprox(out[i]) == slerp(from[i], to[i], 0.3f));
+    }
+
+    slerp(from.data(), to.data(), from.size(), ratios.data(), out.data());
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        CHECK(YamaApprox(out[i]) == slerp(from[i], to[i], ratios[i]));
+    }
+
+    nlerp(from.data(), to.data(), from.size(), 0.7f, out.data());
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        CHECK(YamaApprox(out[i]) == nlerp(from[i], to[i], 0.7f));
+    }
+
+    // in place
+    out = from;
+    nlerp(out.data(), to.data(), out.size(), ratios.data(), out.data());
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        CHECK(YamaApprox(out[i]) == nlerp(from[i], to[i], ratios[i]));
+    }
+
+    std::vector<quaternion_t<double>> fd, td, od(from.size());
+    for (size_t i = 0; i < from.size(); ++i)
+    {
+        fd.push_back(quaternion_t<double>::xyzw(from[i].x, from[i].y, from[i].z, from[i].w));
+        td.push_back(quaternion_t<double>::xyzw(to[i].x, to[i].y, to[i].z, to[i].w));
+    }
+    slerp(fd.data(), td.data(), fd.size(), 0.6, od.data());
+    for (size_t i = 0; i < od.size(); ++i)
+    {
+        // double doesn't go through the float approximations
+        CHECK(YamaApprox(od[i]).epsilon(1e-12) == slerp(fd[i], td[i], 0.6));
+    }
 }
 
 TEST_CASE("rotate")
@@ -471,3 +541,42 @@ TEST_CASE("rotate")
     CHECK(isfinite(q0));
     CHECK(YamaApprox(rotate(v(1, 2, 3), q0)) == v(-1, -2, -3));
 }
+
+TEST_CASE("batch rotate")
+{
+    vector3 vs[19];
+    quaternion qs[19];
+    for (int i = 0; i < 19; ++i)
+    {
+        const float f = float(i);
+        vs[i] = v(f * 0.3f - 3, float(i % 5) * 0.5f, 1 - float(i % 3));
+        qs[i] = quaternion::rotation_axis(v(std::cos(f), std::sin(f), 0.3f), f * 0.4f);
+    }
+
+    const auto q = quaternion::rotation_axis(v(1, -2, 3), 0.7f);
+
+    for (size_t count = 0; count <= 19; ++count)
+    {
+        vector3 out[19];
+        rotate(vs, count, q, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(YamaApprox(out[i]) == rotate(vs[i], q));
+        }
+
+        rotate(vs, count, qs, out);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(YamaApprox(out[i]) == rotate(vs[i], qs[i]));
+        }
+    }
+
+    // in place
+    vector3 out[19];
+    std::copy(vs, vs + 19, out);
+    rotate(out, 19, qs, out);
+    for (size_t i = 0; i < 19; ++i)
+    {
+        CHECK(YamaApprox(out[i]) == rotate(vs[i], qs[i]));
+    }
+}
@@ -0,0 +1,159 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/ray.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+#include <limits>
+
+using namespace yama;
+using doctest::Approx;
+
+TEST_SUITE_BEGIN("ray");
+
+TEST_CASE("construction")
+{
+    auto r = ray::origin_direction(v(1, 2, 3), v(2, 0, -4));
+    CHECK(r.origin == v(1, 2, 3));
+    CHECK(r.direction == v(2, 0, -4));
+    CHECK(r.inv_direction.x == 0.5f);
+    CHECK(r.inv_direction.y == std::numeric_limits<float>::infinity());
+    CHECK(r.inv_direction.z == -0.25f);
+    CHECK(r.sign[0] == 0);
+    CHECK(r.sign[1] == 0);
+    CHECK(r.sign[2] == 1);
+    CHECK(r.at(0.5f) == v(2, 2, 1));
+
+    r = ray::from_to(v(1, 1, 1), v(3, -1, 1));
+    CHECK(r.direction == v(2, -2, 0));
+    CHECK(r.at(1) == v(3, -1, 1));
+    CHECK(r.sign[1] == 1);
+}
+
+TEST_CASE("box")
+{
+    const auto b = boxnt<3, float>::min_max(v(0, 0, 0), v(1, 2, 3));
+    float t;
+
+    // from outside
+    auto r = ray::origin_direction(v(-1, 1, 1), v(1, 0, 0));
+    CHECK(r.intersects(b, 10, t));
+    CHECK(t == 1);
+    CHECK(!r.intersects(b, 0.5f, t)); // too short
+    CHECK(r.intersects(b));
+
+    // the other way
+    r = ray::origin_direction(v(3, 1, 1), v(-2, 0, 0));
+    CHECK(r.intersects(b, 10, t));
+    CHECK(t == 1);
+    CHECK(!ray::origin_direction(v(3, 1, 1), v(2, 0, 0)).intersects(b)); // behind
+
+    // from inside
+    r = ray::origin_direction(v(0.5f, 0.5f, 0.5f), v(1, 1, 1));
+    CHECK(r.intersects(b, 10, t));
+    CHECK(t == 0);
+
+    // diagonal
+    r = ray::from_to(v(-1, -1, -1), v(2, 2, 2));
+    CHECK(r.intersects(b, 1, t));
+    CHECK(t == Approx(1.f / 3));
+
+    // parallel to the slabs
+    CHECK(ray::origin_direction(v(0.5f, -1, 1), v(0, 1, 0)).intersects(b));
+    CHECK(!ray::origin_direction(v(1.5f, -1, 1), v(0, 1, 0)).intersects(b));
+    CHECK(!ray::origin_direction(v(-0.5f, -1, 1), v(0, -1, 0)).intersects(b));
+
+    // on the sides
+    CHECK(ray::origin_direction(v(0, -1, 1), v(0, 1, 0)).intersects(b));
+    CHECK(ray::origin_direction(v(1, -1, 1), v(0, 1, 0)).intersects(b));
+    CHECK(ray::origin_direction(v(1, 5, 3), v(0, -1, 0)).intersects(b));
+    CHECK(ray::origin_direction(v(-1, 0, 0), v(1, 0, 0)).intersects(b));
+}
+
+namespace
+{
+template <typename T>
+void test_batch()
+{
+    using vec = vector3_t<T>;
+    using box = boxnt<3, T>;
+
+    std::minstd_rand rnd(5);
+    std::uniform_real_distribution<T> d(-10, 10);
+    auto rand_vec = [&]() { return vec::coord(d(rnd), d(rnd), d(rnd)); };
+
+    for (size_t count : {0, 1, 7, 8, 9, 31, 32, 33, 100})
+    {
+        std::vector<box> boxes;
+        std::vector<vec> origins, inv_directions;
+        std::vector<ray_t<T>> rays;
+        for (size_t i = 0; i < count; ++i)
+        {
+            boxes.push_back(box::pos_size(rand_vec(), abs(rand_vec()) / T(2)));
+            auto dir = rand_vec();
+            if (i % 5 == 0) dir.at(i % 3) = 0; // parallel to some slabs
+            rays.push_back(ray_t<T>::origin_direction(rand_vec(), dir));
+            origins.push_back(rays.back().origin);
+            inv_directions.push_back(rays.back().inv_direction);
+        }
+        // a ray on the side of a box
+        if (count > 3)
+        {
+            boxes[3] = box::min_max(vec::zero(), vec::uniform(1));
+            rays[3] = ray_t<T>::origin_direction(vec::coord(0, -1, T(0.5)), vec::unit_y());
+            origins[3] = rays[3].origin;
+            inv_directions[3] = rays[3].inv_direction;
+        }
+
+        const T max_t = 3;
+        const size_t words = (count + 31) / 32;
+        std::vector<uint32_t> hits(words + 1, 0xdeadbeef);
+        std::vector<T> t_enter(count);
+
+        // one ray against all boxes
+        for (size_t r = 0; r < std::min(count, size_t(4)); ++r)
+        {
+            intersects(rays[r], boxes.data(), count, max_t, hits.data(), t_enter.data());
+            for (size_t i = 0; i < count; ++i)
+            {
+                T t;
+                const bool hit = rays[r].intersects(boxes[i], max_t, t);
+                CHECK(bool(hits[i / 32] & (1u << (i % 32))) == hit);
+                CHECK(t_enter[i] == (hit ? t : std::numeric_limits<T>::infinity()));
+            }
+            if (count % 32) CHECK(hits[words - 1] >> (count % 32) == 0);
+            CHECK(hits[words] == 0xdeadbeef);
+
+            // no distances
+            const auto h = hits;
+            intersects(rays[r], boxes.data(), count, max_t, hits.data());
+            CHECK(hits == h);
+        }
+        if (count > 3) CHECK(hits[0] & (1u << 3));
+
+        // all rays against one box
+        for (size_t b = 0; b < std::min(count, size_t(4)); ++b)
+        {
+            intersects(origins.data(), inv_directions.data(), count, boxes[b], max_t, hits.data(), t_enter.data());
+            for (size_t i = 0; i < count; ++i)
+            {
+                T t;
+                const bool hit = rays[i].intersects(boxes[b], max_t, t);
+                CHECK(bool(hits[i / 32] & (1u << (i % 32))) == hit);
+                CHECK(t_enter[i] == (hit ? t : std::numeric_limits<T>::infinity()));
+            }
+            if (count % 32) CHECK(hits[words - 1] >> (count % 32) == 0);
+            CHECK(hits[words] == 0xdeadbeef);
+        }
+    }
+}
+}
+
+TEST_CASE("batch")
+{
+    test_batch<float>();
+    test_batch<double>();
+}
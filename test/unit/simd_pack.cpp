@@ -0,0 +1,134 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/simd/pack.hpp"
+#include "doctest/doctest.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace yama::simd;
+
+TEST_SUITE_BEGIN("simd pack");
+
+namespace
+{
+template <typename P>
+void test_pack()
+{
+    constexpr size_t W = P::width;
+    float a[W], b[W], buf[6 * W];
+    for (size_t i = 0; i < W; ++i)
+    {
+        a[i] = float(i) - 2.5f;
+        b[i] = float(W - i) * 0.5f;
+    }
+
+    const auto pa = P::load(a);
+    const auto pb = P::load(b);
+    for (size_t i = 0; i < W; ++i)
+    {
+        CHECK(pa.at(i) == a[i]);
+        CHECK((pa + pb).at(i) == a[i] + b[i]);
+        CHECK((pa - pb).at(i) == a[i] - b[i]);
+        CHECK((pa * pb).at(i) == a[i] * b[i]);
+        CHECK((pa / pb).at(i) == a[i] / b[i]);
+        CHECK((-pa).at(i) == -a[i]);
+        CHECK(fmadd(pa, pb, pa).at(i) == doctest::Approx(a[i] * b[i] + a[i]));
+        CHECK(fnmadd(pa, pb, pa).at(i) == doctest::Approx(a[i] - a[i] * b[i]));
+        CHECK(min(pa, pb).at(i) == std::min(a[i], b[i]));
+        CHECK(max(pa, pb).at(i) == std::max(a[i], b[i]));
+        // NaN gives the second argument
+        CHECK(min(P::uniform(NAN), pb).at(i) == b[i]);
+        CHECK(max(P::uniform(NAN), pb).at(i) == b[i]);
+        CHECK(abs(pa).at(i) == std::abs(a[i]));
+        CHECK(sqrt(pb).at(i) == std::sqrt(b[i]));
+        CHECK(select(pa < pb, pa, pb).at(i) == std::min(a[i], b[i]));
+        CHECK(P::uniform(3).at(i) == 3);
+        CHECK(P::zero().at(i) == 0);
+    }
+
+    int bits = 0;
+    float sum = 0;
+    for (size_t i = 0; i < W; ++i)
+    {
+        if (a[i] < b[i]) bits |= 1 << i;
+        sum += a[i];
+    }
+    CHECK(mask_bits(pa < pb) == bits);
+    CHECK(mask_bits(pa >= pb) == (~bits & ((1 << W) - 1)));
+    CHECK(mask_bits(pa == pa) == (1 << W) - 1);
+    CHECK(mask_bits(pa != pa) == 0);
+    CHECK(mask_bits((pa < pb) & (pa == pa)) == bits);
+    CHECK(mask_bits((pa < pb) | (pa != pa)) == bits);
+    CHECK(mask_bits(andnot(pa < pb, pa == pa)) == mask_bits(pa >= pb));
+    CHECK(mask_bits(P::from_mask_bits(bits)) == bits);
+    CHECK(mask_bits(P::from_mask_bits(0)) == 0);
+    CHECK(mask_bits(P::from_mask_bits((1 << W) - 1)) == (1 << W) - 1);
+    CHECK(mask_bits(select(P::from_mask_bits(bits), pa, pb) == pa) == (bits | mask_bits(pa == pb)));
+
+    CHECK(hsum(pa) == doctest::Approx(sum));
+    CHECK(hmin(pa) == a[0]);
+    CHECK(hmax(pa) == a[W - 1]);
+    CHECK(hmin(pb) == b[W - 1]);
+    CHECK(hmax(pb) == b[0]);
+
+    pa.store(buf);
+    CHECK(std::equal(a, a + W, buf));
+
+    for (size_t i = 0; i < 6 * W; ++i) buf[i] = float(i);
+
+    P x, y, z, w;
+    load3(buf, x, y, z);
+    for (size_t i = 0; i < W; ++i)
+    {
+        CHECK(x.at(i) == float(3 * i));
+        CHECK(y.at(i) == float(3 * i + 1));
+        CHECK(z.at(i) == float(3 * i + 2));
+    }
+    float out[4 * W] = {};
+    store3(out, x, y, z);
+    CHECK(std::equal(buf, buf + 3 * W, out));
+
+    load4(buf, x, y, z, w);
+    for (size_t i = 0; i < W; ++i)
+    {
+        CHECK(x.at(i) == float(4 * i));
+        CHECK(y.at(i) == float(4 * i + 1));
+        CHECK(z.at(i) == float(4 * i + 2));
+        CHECK(w.at(i) == float(4 * i + 3));
+    }
+    store4(out, x, y, z, w);
+    CHECK(std::equal(buf, buf + 4 * W, out));
+
+    P bx, by, bz;
+    load3_pairs(buf, x, y, z, bx, by, bz);
+    for (size_t i = 0; i < W; ++i)
+    {
+        CHECK(x.at(i) == float(6 * i));
+        CHECK(y.at(i) == float(6 * i + 1));
+        CHECK(z.at(i) == float(6 * i + 2));
+        CHECK(bx.at(i) == float(6 * i + 3));
+        CHECK(by.at(i) == float(6 * i + 4));
+        CHECK(bz.at(i) == float(6 * i + 5));
+    }
+}
+}
+
+TEST_CASE("f32x4")
+{
+    test_pack<f32x4>();
+}
+
+TEST_CASE("f32x8")
+{
+    test_pack<f32x8>();
+}
+
+TEST_CASE("fallback")
+{
+    test_pack<basic_f32_pack<4>>();
+    test_pack<basic_f32_pack<8>>();
+    test_pack<basic_f32_pack<3>>();
+    CHECK(f32xn::width >= 4);
+}
@@ -0,0 +1,205 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/skinning.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("skinning");
+
+namespace
+{
+template <size_t Influences, typename T, typename Index>
+struct mesh
+{
+    std::vector<quaternion_t<T>> rotations;
+    std::vector<vector3_t<T>> translations;
+    std::vector<matrix3x4_t<T>> palette; // with scaling
+    std::vector<Index> indices;
+    std::vector<T> weights;
+    std::vector<vector3_t<T>> positions, normals, out_positions, out_normals;
+
+    explicit mesh(size_t count)
+    {
+        for (int i = 0; i < 7; ++i)
+        {
+            const T f = T(i);
+            rotations.push_back(quaternion_t<T>::rotation_axis(vector3_t<T>::coord(std::sin(f), std::cos(f), 1), f * T(0.4)));
+            translations.push_back(vector3_t<T>::coord(f - 3, 1, f * T(0.5)));
+            palette.push_back(matrix3x4_t<T>::translation_rotation_scaling(
+                translations.back(), rotations.back(), vector3_t<T>::uniform(1 + f * T(0.1))));
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const T f = T(i);
+            positions.push_back(vector3_t<T>::coord(f * T(0.1) - 1, T(0.5) - f * T(0.05), T(0.2)));
+            normals.push_back(normalize(vector3_t<T>::coord(std::sin(f), 1, std::cos(f))));
+
+            // the last influence is unused for some vertices
+            T sum = 0;
+            for (size_t k = 0; k < Influences; ++k)
+            {
+                indices.push_back(Index((i + k * 3) % palette.size()));
+                const T w = (k == Influences - 1 && i % 2) ? T(0) : T(k + 1 + i % 3);
+                weights.push_back(w);
+                sum += w;
+            }
+            for (size_t k = 0; k < Influences; ++k) weights[i * Influences + k] /= sum;
+        }
+
+        out_positions.resize(count);
+        out_normals.resize(count);
+    }
+
+    skinned_vertices_t<Influences, T, Index> vertices()
+    {
+        skinned_vertices_t<Influences, T, Index> ret;
+        ret.count = positions.size();
+        ret.indices = indices.data();
+        ret.weights = weights.data();
+        ret.positions = positions.data();
+        ret.normals = normals.data();
+        ret.out_positions = out_positions.data();
+        ret.out_normals = out_normals.data();
+        return ret;
+    }
+
+    matrix3x4_t<T> blended(size_t i) const
+    {
+        auto ret = matrix3x4_t<T>::zero();
+        for (size_t k = 0; k < Influences; ++k)
+        {
+            ret += weights[i * Influences + k] * palette[indices[i * Influences + k]];
+        }
+        return ret;
+    }
+
+    void check(size_t begin, size_t end) const
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto m = blended(i);
+            CHECK(YamaApprox(out_positions[i]) == transform_coord(positions[i], m));
+            CHECK(YamaApprox(out_normals[i]) == normalize(transform_normal(normals[i], m)));
+        }
+    }
+};
+
+template <size_t Influences, typename T, typename Index>
+void test_linear()
+{
+    for (size_t count : {0, 1, 7, 8, 9, 23})
+    {
+        mesh<Influences, T, Index> m(count);
+        skin_linear(m.palette.data(), m.vertices());
+        m.check(0, count);
+    }
+
+    // split ranges
+    mesh<Influences, T, Index> m(37);
+    auto v = m.vertices();
+    skin_linear(m.palette.data(), v, 0, 13);
+    skin_linear(m.palette.data(), v, 13, 14);
+    skin_linear(m.palette.data(), v, 14, 37);
+    m.check(0, 37);
+
+    // no normals
+    const auto n = m.out_normals;
+    v.normals = nullptr;
+    v.out_normals = nullptr;
+    skin_linear(m.palette.data(), v);
+    CHECK(m.out_normals == n);
+
+    // in place
+    const auto skinned = m.out_positions;
+    v.out_positions = m.positions.data();
+    skin_linear(m.palette.data(), v);
+    for (size_t i = 0; i < skinned.size(); ++i)
+    {
+        CHECK(YamaApprox(m.positions[i]) == skinned[i]);
+    }
+}
+}
+
+TEST_CASE("linear")
+{
+    test_linear<4, float, uint16_t>();
+    test_linear<8, float, uint8_t>();
+    test_linear<4, double, uint32_t>();
+}
+
+namespace
+{
+template <size_t Influences, typename T, typename Index>
+void test_dual_quaternion()
+{
+    for (size_t count : {0, 1, 7, 8, 9, 23, 37})
+    {
+        mesh<Influences, T, Index> m(count);
+
+        std::vector<dual_quaternion_t<T>> palette;
+        for (size_t i = 0; i < m.rotations.size(); ++i)
+        {
+            palette.push_back(dual_quaternion_t<T>::rotation_translation(m.rotations[i], m.translations[i]));
+        }
+        palette.back() = -palette.back(); // the same transformation in the other hemisphere
+
+        auto v = m.vertices();
+        skin_dual_quaternion(palette.data(), v, 0, count / 2);
+        skin_dual_quaternion(palette.data(), v, count / 2, count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto first = palette[m.indices[i * Influences]];
+            auto blended = dual_quaternion_t<T>::zero();
+            for (size_t k = 0; k < Influences; ++k)
+            {
+                const auto& dq = palette[m.indices[i * Influences + k]];
+                const T w = m.weights[i * Influences + k];
+                blended += dot(dq.real, first.real) < 0 ? dq * -w : dq * w;
+            }
+            blended.normalize();
+
+            CHECK(YamaApprox(m.out_positions[i]) == transform_coord(m.positions[i], blended));
+            CHECK(YamaApprox(m.out_normals[i]) == transform_normal(m.normals[i], blended));
+        }
+    }
+}
+}
+
+TEST_CASE("dual quaternion")
+{
+    test_dual_quaternion<4, float, uint16_t>();
+    test_dual_quaternion<8, float, uint8_t>();
+    test_dual_quaternion<4, double, uint32_t>();
+
+    // a single bone is the same as linear blend skinning
+    mesh<4, float, uint16_t> m(11);
+    std::fill(m.weights.begin(), m.weights.end(), 0.f);
+    for (size_t i = 0; i < 11; ++i) m.weights[i * 4] = 1;
+
+    std::vector<dual_quaternion> palette;
+    for (size_t i = 0; i < m.palette.size(); ++i)
+    {
+        m.palette[i] = matrix3x4::translation(m.translations[i]) * matrix3x4::rotation_quaternion(m.rotations[i]);
+        palette.push_back(dual_quaternion::rigid_matrix(m.palette[i]));
+    }
+
+    auto v = m.vertices();
+    skin_linear(m.palette.data(), v);
+    const auto p = m.out_positions;
+    const auto n = m.out_normals;
+    skin_dual_quaternion(palette.data(), v);
+    for (size_t i = 0; i < 11; ++i)
+    {
+        CHECK(YamaApprox(m.out_positions[i]) == p[i]);
+        CHECK(YamaApprox(m.out_normals[i]) == n[i]);
+    }
+}
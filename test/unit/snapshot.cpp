@@ -0,0 +1,180 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/snapshot.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("snapshot");
+
+TEST_CASE("deltas")
+{
+    using simd::encode_deltas;
+    using simd::decode_deltas;
+
+    // zig-zag: 2, 1, 4 in 3 bits each
+    const uint32_t in[] = {1, uint32_t(-1), 2};
+    uint8_t out[16];
+    CHECK(encode_deltas(in, nullptr, 3, out) == 3);
+    CHECK(out[0] == 3);
+    CHECK(out[1] == 0x0a);
+    CHECK(out[2] == 0x01);
+
+    uint32_t d[3];
+    CHECK(decode_deltas(out, 3, nullptr, 3, d) == 3);
+    CHECK(d[0] == 1);
+    CHECK(d[1] == uint32_t(-1));
+    CHECK(d[2] == 2);
+
+    // against a baseline
+    // zig-zag: 0, 11 (for -6), 4 in 4 bits each
+    const uint32_t base[] = {1, 5, 0};
+    CHECK(encode_deltas(in, base, 3, out) == 3);
+    CHECK(out[0] == 4);
+    CHECK(out[1] == 0xb0);
+    CHECK(out[2] == 0x04);
+    CHECK(decode_deltas(out, 2, base, 3, d) == 0); // truncated
+    CHECK(decode_deltas(out, 16, base, 3, d) == 3);
+    CHECK(d[0] == 1);
+    CHECK(d[1] == uint32_t(-1));
+    CHECK(d[2] == 2);
+
+    // malformed
+    CHECK(decode_deltas(out, 0, nullptr, 1, d) == 0);
+    out[0] = 33;
+    CHECK(decode_deltas(out, 16, nullptr, 1, d) == 0);
+}
+
+namespace
+{
+void test_deltas(size_t count, int bits, bool with_base)
+{
+    std::minstd_rand rnd(unsigned(count * 33 + bits));
+    std::vector<uint32_t> base(count), in(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        base[i] = uint32_t(rnd()) * 7919u;
+        // deltas of up to bits bits either way
+        const uint32_t d = bits ? uint32_t(rnd()) & simd::impl::bit_mask(bits) : 0;
+        in[i] = (with_base ? base[i] : 0) + ((i & 1) ? d : 0u - d);
+    }
+    const uint32_t* b = with_base ? base.data() : nullptr;
+
+    std::vector<uint8_t> enc(simd::max_deltas_size(count) + 1, 42);
+    const size_t size = simd::encode_deltas(in.data(), b, count, enc.data());
+    CHECK(size <= simd::max_deltas_size(count));
+    CHECK(enc[size] == 42);
+
+    // one byte per block and at most bits + 1 bits per value
+    const size_t blocks = (count + simd::delta_block_size - 1) / simd::delta_block_size;
+    CHECK(size <= blocks + (count * size_t(bits + 1) + 7) / 8 + blocks);
+
+    std::vector<uint32_t> out(count + 1, 42);
+    CHECK(simd::decode_deltas(enc.data(), size, b, count, out.data()) == size);
+    CHECK(out.back() == 42);
+    out.pop_back();
+    CHECK(out == in);
+
+    if (size)
+    {
+        CHECK(simd::decode_deltas(enc.data(), size - 1, b, count, out.data()) == 0);
+    }
+}
+}
+
+TEST_CASE("batch deltas")
+{
+    for (size_t count : {0, 1, 5, 127, 128, 129, 256, 300, 1000})
+    {
+        for (int bits : {0, 1, 3, 7, 8, 13, 16, 24, 31, 32})
+        {
+            test_deltas(count, bits, true);
+            test_deltas(count, bits, false);
+        }
+    }
+
+    // equal snapshots take a byte per block
+    std::vector<uint32_t> s(300, 12345);
+    std::vector<uint8_t> enc(simd::max_deltas_size(300));
+    CHECK(simd::encode_deltas(s.data(), s.data(), 300, enc.data()) == 3);
+}
+
+namespace
+{
+template <typename T, int PositionBits, int RotationBits>
+void test_codec()
+{
+    using codec_t = snapshot_codec<T, PositionBits, RotationBits>;
+    const auto bounds = boxnt<3, T>::min_max(vector3_t<T>::coord(-500, -10, -500), vector3_t<T>::coord(500, 100, 500));
+    const codec_t codec(bounds);
+    CHECK(codec.bounds() == bounds);
+
+    const size_t count = 300;
+    std::minstd_rand rnd(3);
+    std::uniform_real_distribution<T> d(0, 1);
+    std::uniform_real_distribution<T> angle(-constants::PI, constants::PI);
+
+    std::vector<vector3_t<T>> positions(count);
+    std::vector<quaternion_t<T>> rotations(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t k = 0; k < 3; ++k) positions[i][k] = bounds.min[k] + d(rnd) * bounds.size()[k];
+        rotations[i] = quaternion_t<T>::rotation_axis(normalize(vector3_t<T>::coord(d(rnd) - T(0.5), 1, d(rnd))), angle(rnd));
+    }
+
+    std::vector<uint32_t> base(codec_t::snapshot_size(count));
+    const auto e = codec.quantize(positions.data(), rotations.data(), count, base.data());
+    const auto bound = quantization_error<PositionBits>(bounds);
+    for (size_t k = 0; k < 3; ++k) CHECK(e[k] <= bound[k] * T(1.001));
+
+    std::vector<vector3_t<T>> p(count);
+    std::vector<quaternion_t<T>> r(count);
+    codec.dequantize(base.data(), count, p.data(), r.data());
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t k = 0; k < 3; ++k) CHECK(std::abs(p[i][k] - positions[i][k]) <= e[k]);
+        CHECK(r[i] == YamaApprox(packed_quaternion_t<RotationBits>::pack(rotations[i]).template unpack<T>()).epsilon(T(1e-5)));
+    }
+
+    // a full snapshot
+    std::vector<uint8_t> full(codec_t::max_encoded_size(count));
+    const size_t full_size = codec_t::encode(base.data(), nullptr, count, full.data());
+    std::vector<uint32_t> s(codec_t::snapshot_size(count));
+    CHECK(codec_t::decode(full.data(), full_size, nullptr, count, s.data()) == full_size);
+    CHECK(s == base);
+
+    // the next tick: a few entities move a bit
+    for (size_t i = 0; i < count; i += 10)
+    {
+        positions[i].x += T(0.1);
+        positions[i].z -= T(0.2);
+        rotations[i] = normalize(rotations[i] * quaternion_t<T>::rotation_y(T(0.01)));
+    }
+    std::vector<uint32_t> next(codec_t::snapshot_size(count));
+    const auto ne = codec.quantize(positions.data(), rotations.data(), count, next.data());
+
+    std::vector<uint8_t> delta(codec_t::max_encoded_size(count));
+    const size_t delta_size = codec_t::encode(next.data(), base.data(), count, delta.data());
+    CHECK(delta_size < full_size / 2);
+    CHECK(codec_t::decode(delta.data(), delta_size, base.data(), count, s.data()) == delta_size);
+    CHECK(s == next);
+
+    codec.dequantize(s.data(), count, p.data(), r.data());
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t k = 0; k < 3; ++k) CHECK(std::abs(p[i][k] - positions[i][k]) <= ne[k]);
+    }
+}
+}
+
+TEST_CASE("codec")
+{
+    test_codec<float, 16, 48>();
+    test_codec<float, 12, 32>();
+    test_codec<double, 20, 48>();
+}
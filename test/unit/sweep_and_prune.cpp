@@ -0,0 +1,182 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/sweep_and_prune.hpp"
+#include "common.hpp"
+
+#include <vector>
+#include <random>
+#include <set>
+#include <utility>
+#include <algorithm>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("sweep_and_prune");
+
+namespace
+{
+using box = boxnt<3, float>;
+using sap = sweep_and_prune<3, float>;
+using pair_set = std::set<std::pair<uint32_t, uint32_t>>;
+
+pair_set pairs(const sap& s)
+{
+    pair_set ret;
+    s.for_each_pair([&](uint32_t a, uint32_t b) {
+        CHECK(a < b);
+        ret.emplace(a, b);
+    });
+    CHECK(ret.size() == s.pair_count());
+    return ret;
+}
+
+// brute force over the ids which are alive
+pair_set brute_force(const std::vector<box>& boxes, const std::vector<bool>& alive)
+{
+    pair_set ret;
+    for (uint32_t i = 0; i < boxes.size(); ++i)
+    {
+        for (uint32_t j = i + 1; j < boxes.size(); ++j)
+        {
+            if (alive[i] && alive[j] && boxes[i].intersects(boxes[j])) ret.emplace(i, j);
+        }
+    }
+    return ret;
+}
+
+void check_sorted(const sap& s)
+{
+    for (size_t d = 0; d < 3; ++d)
+    {
+        auto& ep = s.endpoints(d);
+        CHECK(ep.size() == 2 * s.size());
+        for (size_t i = 1; i < ep.size(); ++i) CHECK(!(ep[i] < ep[i - 1]));
+    }
+}
+}
+
+TEST_CASE("basic")
+{
+    sap s;
+    const auto a = s.insert(box::min_max(v(0, 0, 0), v(2, 2, 2)));
+    const auto b = s.insert(box::min_max(v(1, 1, 1), v(3, 3, 3)));
+    const auto c = s.insert(box::min_max(v(2, 0, 0), v(4, 1, 1))); // touches a
+    CHECK(s.size() == 3);
+    CHECK(s.pair_count() == 1);
+    CHECK(s.overlaps(a, b));
+    CHECK(s.overlaps(b, a));
+    CHECK(!s.overlaps(a, c));
+    CHECK(!s.overlaps(b, c));
+
+    s.update(c, box::min_max(v(1.5f, 0, 0), v(4, 1.5f, 1.5f)));
+    CHECK(s.pair_count() == 3);
+    CHECK(s.get(c).min.x == 1.5f);
+
+    s.update(a, box::min_max(v(-5, 0, 0), v(-4, 2, 2)));
+    CHECK(s.pair_count() == 1);
+    CHECK(s.overlaps(b, c));
+
+    s.remove(b);
+    CHECK(s.size() == 2);
+    CHECK(s.pair_count() == 0);
+    check_sorted(s);
+
+    // the id is reused
+    CHECK(s.insert(box::min_max(v(-4.5f, 1, 1), v(2, 2, 2))) == b);
+    CHECK(s.pair_count() == 2);
+    CHECK(s.overlaps(a, b));
+    CHECK(s.overlaps(b, c));
+    check_sorted(s);
+}
+
+TEST_CASE("zero width")
+{
+    // a point and a flat box in the middle of open boxes on the sweep axis
+    const std::vector<box> boxes = {
+        box::min_max(v(0, 0, 0), v(10, 1, 1)),
+        box::min_max(v(1, 0, 0), v(9, 1, 1)),
+        box::min_max(v(5, 0.5f, 0.5f), v(5, 0.5f, 0.5f)),
+        box::min_max(v(6, 0, 0), v(8, 1, 1)),
+        box::min_max(v(7, 0, 0), v(7, 1, 1)),
+        box::min_max(v(7.5f, 0, 0), v(8.5f, 1, 1)),
+    };
+
+    sap s(boxes.data(), boxes.size());
+    check_sorted(s);
+    CHECK(s.overlaps(1, 3));
+    CHECK(s.overlaps(3, 5));
+    CHECK(s.overlaps(3, 4));
+    CHECK(!s.overlaps(2, 3));
+
+    sap inserted;
+    for (auto& b : boxes) inserted.insert(b);
+    CHECK(pairs(s) == pairs(inserted));
+    CHECK(pairs(s) == brute_force(boxes, std::vector<bool>(boxes.size(), true)));
+}
+
+TEST_CASE("moving boxes")
+{
+    std::minstd_rand rnd(7);
+    std::uniform_real_distribution<float> pos(0, 50);
+    std::uniform_real_distribution<float> size(0.5f, 3);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    auto rand_box = [&]() { return box::pos_size(v(pos(rnd), pos(rnd), pos(rnd)), v(size(rnd), size(rnd), size(rnd))); };
+
+    std::vector<box> boxes;
+    for (int i = 0; i < 300; ++i) boxes.push_back(rand_box());
+    // some touching and degenerate ones
+    boxes[1] = box::min_max(boxes[0].max, boxes[0].max + v(1, 1, 1));
+    boxes[2] = box::min_max(boxes[0].center(), boxes[0].center());
+    std::vector<bool> alive(boxes.size(), true);
+
+    sap s(boxes.data(), boxes.size());
+    check_sorted(s);
+    CHECK(pairs(s) == brute_force(boxes, alive));
+    CHECK(s.overlaps(0, 2));
+    CHECK(!s.overlaps(0, 1));
+
+    // the same as inserting one by one
+    sap inserted;
+    for (auto& b : boxes) inserted.insert(b);
+    CHECK(pairs(inserted) == pairs(s));
+
+    for (uint32_t frame = 0; frame < 50; ++frame)
+    {
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            if (!alive[i]) continue;
+            const auto d = v(step(rnd), step(rnd), step(rnd));
+            boxes[i] = box::min_max(boxes[i].min + d, boxes[i].max + d);
+            if (i % 7 == frame % 7) boxes[i] = rand_box(); // teleport
+            s.update(i, boxes[i]);
+        }
+
+        // churn
+        if (frame % 5 == 0)
+        {
+            for (uint32_t i = frame % 3; i < boxes.size(); i += 13)
+            {
+                if (alive[i]) s.remove(i);
+                alive[i] = false;
+            }
+        }
+        else if (frame % 5 == 2)
+        {
+            // the ids are reused, so the new boxes get exactly the free ones
+            const auto dead = std::count(alive.begin(), alive.end(), false);
+            for (int i = 0; i < dead; ++i)
+            {
+                const auto b = rand_box();
+                const auto id = s.insert(b);
+                REQUIRE(id < boxes.size());
+                CHECK(!alive[id]);
+                boxes[id] = b;
+                alive[id] = true;
+            }
+        }
+
+        check_sorted(s);
+        REQUIRE(pairs(s) == brute_force(boxes, alive));
+    }
+}
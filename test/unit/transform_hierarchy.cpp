@@ -0,0 +1,166 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/transform_hierarchy.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("transform_hierarchy");
+
+namespace
+{
+template <typename T>
+using hierarchy = transform_hierarchy<T>;
+
+// the world matrix of a node by walking up to its root
+template <typename T>
+matrix3x4_t<T> world(const hierarchy<T>& h, uint32_t i)
+{
+    auto ret = matrix3x4_t<T>::translation_rotation_scaling(h.translation(i), h.rotation(i), h.scaling(i));
+    for (auto p = h.parent(i); p != hierarchy<T>::no_parent; p = h.parent(p))
+    {
+        ret = matrix3x4_t<T>::translation_rotation_scaling(h.translation(p), h.rotation(p), h.scaling(p)) * ret;
+    }
+    return ret;
+}
+
+template <typename T>
+void check_worlds(const hierarchy<T>& h)
+{
+    for (uint32_t i = 0; i < h.size(); ++i)
+    {
+        CHECK(h.world_matrix(i) == YamaApprox(world(h, i)).epsilon(T(1e-4)));
+    }
+}
+}
+
+TEST_CASE("basic")
+{
+    using h3 = hierarchy<float>;
+    h3 h;
+    CHECK(h.empty());
+    CHECK(h.is_depth_first());
+
+    const auto root = h.add(h3::no_parent, v(1, 0, 0));
+    const auto arm = h.add(root, v(0, 2, 0), quaternion_t<float>::rotation_z(constants::PI_HALF));
+    const auto hand = h.add(arm, v(3, 0, 0), quaternion_t<float>::identity(), v(2, 2, 2));
+    const auto leg = h.add(root, v(0, -1, 0));
+    CHECK(h.size() == 4);
+    CHECK(h.parent(root) == h3::no_parent);
+    CHECK(h.parent(hand) == arm);
+    CHECK(h.is_dirty(hand));
+    CHECK(h.is_depth_first());
+    CHECK(h.subtree_end(root) == 4);
+    CHECK(h.subtree_end(arm) == 3);
+    CHECK(h.subtree_end(hand) == 3);
+    CHECK(h.subtree_end(leg) == 4);
+
+    h.update();
+    CHECK(!h.is_dirty(hand));
+    for (uint32_t i = 0; i < 4; ++i) CHECK(h.is_world_changed(i));
+    check_worlds(h);
+    CHECK(transform_coord(v(0, 0, 0), h.world_matrix(hand)) == YamaApprox(v(1, 5, 0)));
+    CHECK(transform_coord(v(1, 0, 0), h.world_matrix(hand)) == YamaApprox(v(1, 7, 0)));
+
+    // nothing changed
+    h.update();
+    for (uint32_t i = 0; i < 4; ++i) CHECK(!h.is_world_changed(i));
+
+    // only the arm and its descendants
+    h.set_rotation(arm, quaternion_t<float>::identity());
+    CHECK(h.is_dirty(arm));
+    h.update();
+    CHECK(!h.is_world_changed(root));
+    CHECK(h.is_world_changed(arm));
+    CHECK(h.is_world_changed(hand));
+    CHECK(!h.is_world_changed(leg));
+    check_worlds(h);
+    CHECK(transform_coord(v(0, 0, 0), h.world_matrix(hand)) == YamaApprox(v(4, 2, 0)));
+
+    h.set_translation(root, v(0, 0, 0));
+    h.set_scaling(leg, v(1, 3, 1));
+    h.update();
+    for (uint32_t i = 0; i < 4; ++i) CHECK(h.is_world_changed(i));
+    check_worlds(h);
+
+    // not after the subtree of the arm
+    h.add(arm);
+    CHECK(!h.is_depth_first());
+
+    h.clear();
+    CHECK(h.empty());
+    CHECK(h.is_depth_first());
+}
+
+namespace
+{
+template <typename T>
+void test_random()
+{
+    using vec = vector3_t<T>;
+    using quat = quaternion_t<T>;
+
+    std::minstd_rand rnd(11);
+    std::uniform_real_distribution<T> d(-1, 1);
+    auto rand_vec = [&]() { return vec::coord(d(rnd), d(rnd), d(rnd)); };
+    auto rand_quat = [&]() { return quat::rotation_axis(rand_vec() + vec::coord(0, 0, T(1.5)), d(rnd) * 3); };
+
+    // a few roots with subtrees in depth-first order
+    hierarchy<T> h;
+    std::vector<uint32_t> roots;
+    std::vector<uint32_t> stack;
+    for (int i = 0; i < 300; ++i)
+    {
+        // go back up a random number of levels
+        while (!stack.empty() && rnd() % 3 == 0) stack.pop_back();
+        const auto parent = stack.empty() ? hierarchy<T>::no_parent : stack.back();
+        const auto n = h.add(parent, rand_vec() * T(3), rand_quat(), vec::uniform(1) + rand_vec() * T(0.2));
+        if (parent == hierarchy<T>::no_parent) roots.push_back(n);
+        stack.push_back(n);
+    }
+    REQUIRE(h.is_depth_first());
+    CHECK(roots.size() > 1);
+
+    h.update();
+    check_worlds(h);
+
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        std::vector<bool> changed(h.size(), false);
+        for (uint32_t i = 0; i < h.size(); ++i)
+        {
+            if (rnd() % 8) continue;
+            h.set_local(i, rand_vec() * T(3), rand_quat(), vec::uniform(1) + rand_vec() * T(0.2));
+            changed[i] = true;
+        }
+        for (uint32_t i = 0; i < h.size(); ++i)
+        {
+            if (h.parent(i) != hierarchy<T>::no_parent && changed[h.parent(i)]) changed[i] = true;
+        }
+
+        // the subtrees separately, as different threads would
+        if (frame % 2)
+        {
+            for (auto r : roots) h.update(r, h.subtree_end(r));
+        }
+        else
+        {
+            h.update();
+        }
+
+        for (uint32_t i = 0; i < h.size(); ++i) CHECK(h.is_world_changed(i) == changed[i]);
+        check_worlds(h);
+    }
+}
+}
+
+TEST_CASE("random")
+{
+    test_random<float>();
+    test_random<double>();
+}
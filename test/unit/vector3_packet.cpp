@@ -0,0 +1,152 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/vector3_packet.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <algorithm>
+
+using namespace yama;
+using doctest::Approx;
+
+TEST_SUITE_BEGIN("vector3_packet");
+
+namespace
+{
+template <typename V>
+V reflect_and_scale(const V& v, const V& n)
+{
+    // written against vector3_t
+    auto d = dot(v, n);
+    return (v - n * (2.f * d)) * 0.5f + cross(v, n) / 2.f;
+}
+
+template <typename Packet>
+void test_packet()
+{
+    constexpr size_t N = Packet::width;
+    vector3 vs[N], ns[N];
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto f = float(i);
+        vs[i] = v(f * 0.3f - 1, 0.5f - f * 0.1f, f * f * 0.05f + 0.1f);
+        ns[i] = normalize(v(1, f, 2 - f));
+    }
+
+    const auto pv = Packet::from_ptr(vs);
+    const auto pn = Packet::from_ptr(ns);
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        CHECK(pv.get(i) == vs[i]);
+    }
+
+    vector3 out[N];
+    pv.store(out);
+    CHECK(std::equal(vs, vs + N, out));
+
+    float lx[N], ly[N], lz[N];
+    pv.store_lanes(lx, ly, lz);
+    CHECK(Packet::from_lanes(lx, ly, lz) == pv);
+    CHECK(lz[N - 1] == vs[N - 1].z);
+
+    CHECK(Packet::broadcast(v(1, 2, 3)).get(N - 1) == v(1, 2, 3));
+    CHECK(Packet::uniform(2).get(0) == v(2, 2, 2));
+    CHECK(Packet::zero().get(1) == vector3::zero());
+    CHECK(Packet::unit_y().get(2) == vector3::unit_y());
+
+    CHECK(pv == pv);
+    CHECK(pv != pn);
+    CHECK(close(pv, pv + Packet::uniform(1e-6f)));
+    CHECK(!close(pv, pv + Packet::uniform(1e-3f)));
+
+    const auto sum = pv + pn;
+    const auto diff = pv - pn;
+    const auto neg = -pv;
+    const auto scaled = pv * 3.f;
+    const auto divided = pv / 2.f;
+    const auto lanes = pv * dot(pv, pn);
+    const auto m = mul(pv, pn);
+    const auto mn = min(pv, pn);
+    const auto mx = max(pv, pn);
+    const auto cl = clamp(pv, Packet::uniform(-0.5f), Packet::uniform(0.5f));
+    const auto cr = cross(pv, pn);
+    const auto nr = normalize(pv);
+    const auto ab = abs(pv);
+    const auto len = pv.length();
+    const auto dist = distance_sq(pv, pn);
+    const auto rs = reflect_and_scale(pv, pn);
+
+    auto acc = pv;
+    acc += pn;
+    acc -= pv;
+    acc *= 2.f;
+    acc /= 4.f;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        const auto a = vs[i], b = ns[i];
+        CHECK(sum.get(i) == a + b);
+        CHECK(diff.get(i) == a - b);
+        CHECK(neg.get(i) == -a);
+        CHECK(scaled.get(i) == a * 3.f);
+        CHECK(divided.get(i) == a / 2.f);
+        CHECK(YamaApprox(lanes.get(i)) == a * dot(a, b));
+        CHECK(m.get(i) == mul(a, b));
+        CHECK(mn.get(i) == min(a, b));
+        CHECK(mx.get(i) == max(a, b));
+        CHECK(cl.get(i) == clamp(a, vector3::uniform(-0.5f), vector3::uniform(0.5f)));
+        CHECK(YamaApprox(cr.get(i)) == cross(a, b));
+        CHECK(YamaApprox(nr.get(i)) == normalize(a));
+        CHECK(ab.get(i) == abs(a));
+        CHECK(Approx(len.at(i)) == a.length());
+        CHECK(Approx(dist.at(i)) == distance_sq(a, b));
+        CHECK(YamaApprox(rs.get(i)) == reflect_and_scale(a, b));
+        CHECK(YamaApprox(acc.get(i)) == b * 0.5f);
+    }
+
+    // select the vectors which are closer to the first normal
+    const auto n0 = Packet::broadcast(ns[0]);
+    const auto mask = dot(pv, n0) > dot(pn, n0);
+    const auto sel = select(mask, pv, pn);
+    for (size_t i = 0; i < N; ++i)
+    {
+        const bool pick = dot(vs[i], ns[0]) > dot(ns[i], ns[0]);
+        CHECK((mask_bits(mask) >> i & 1) == int(pick));
+        CHECK(sel.get(i) == (pick ? vs[i] : ns[i]));
+    }
+
+    auto hs = vector3::zero();
+    auto hmn = vs[0], hmx = vs[0];
+    for (size_t i = 0; i < N; ++i)
+    {
+        hs += vs[i];
+        hmn = min(hmn, vs[i]);
+        hmx = max(hmx, vs[i]);
+    }
+    CHECK(YamaApprox(hsum(pv)) == hs);
+    CHECK(hmin(pv) == hmn);
+    CHECK(hmax(pv) == hmx);
+}
+}
+
+TEST_CASE("vector3x4")
+{
+    test_packet<vector3x4>();
+}
+
+TEST_CASE("vector3x8")
+{
+    test_packet<vector3x8>();
+}
+
+TEST_CASE("generic")
+{
+    vector3_packet_t<double, 2> d = vector3_packet_t<double, 2>::broadcast(vector3_t<double>::coord(3, 0, 4));
+    CHECK(d.length().at(1) == 5);
+    CHECK(hsum(d) == vector3_t<double>::coord(6, 0, 8));
+    auto l = d.normalize();
+    CHECK(l.at(0) == 5);
+    CHECK(YamaApprox(d.get(0)) == vector3_t<double>::coord(0.6, 0, 0.8));
+}
@@ -0,0 +1,165 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/vector_half.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <random>
+#include <limits>
+
+using namespace yama;
+
+TEST_SUITE_BEGIN("vector_half");
+
+namespace
+{
+float from_bits(uint32_t u)
+{
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+uint32_t to_bits(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+}
+
+TEST_CASE("conversion")
+{
+    using simd::float_to_half;
+    using simd::half_to_float;
+
+    CHECK(float_to_half(0.f) == 0);
+    CHECK(float_to_half(-0.f) == 0x8000);
+    CHECK(float_to_half(1.f) == 0x3c00);
+    CHECK(float_to_half(-2.f) == 0xc000);
+    CHECK(float_to_half(0.5f) == 0x3800);
+    CHECK(float_to_half(65504.f) == 0x7bff); // the largest
+    CHECK(float_to_half(65519.f) == 0x7bff);
+    CHECK(float_to_half(65520.f) == 0x7c00); // rounds to infinity
+    CHECK(float_to_half(-1e10f) == 0xfc00);
+    CHECK(float_to_half(std::numeric_limits<float>::infinity()) == 0x7c00);
+    CHECK(float_to_half(std::ldexp(1.f, -14)) == 0x0400); // the smallest normal
+    CHECK(float_to_half(std::ldexp(1.f, -24)) == 0x0001); // the smallest subnormal
+    CHECK(float_to_half(std::ldexp(1.f, -25)) == 0); // a tie rounds to even
+    CHECK(float_to_half(std::ldexp(1.5f, -25)) == 0x0001);
+    CHECK(float_to_half(std::ldexp(3.f, -25)) == 0x0002);
+    CHECK(float_to_half(1.f + std::ldexp(1.f, -11)) == 0x3c00); // a tie rounds to even
+    CHECK(float_to_half(1.f + std::ldexp(3.f, -11)) == 0x3c02);
+    CHECK((float_to_half(std::numeric_limits<float>::quiet_NaN()) & 0x7e00) == 0x7e00);
+    CHECK((float_to_half(from_bits(0x7f800001)) & 0x7e00) == 0x7e00); // signaling NaNs become quiet
+
+    CHECK(half_to_float(0x3c00) == 1);
+    CHECK(half_to_float(0x7bff) == 65504);
+    CHECK(half_to_float(0x0001) == std::ldexp(1.f, -24));
+    CHECK(half_to_float(0x03ff) == std::ldexp(1023.f, -24));
+    CHECK(to_bits(half_to_float(0x8000)) == 0x80000000);
+    CHECK(half_to_float(0xfc00) == -std::numeric_limits<float>::infinity());
+    CHECK(std::isnan(half_to_float(0x7c01)));
+
+    // all halves are exact as floats
+    for (uint32_t h = 0; h < 0x10000; ++h)
+    {
+        const float f = half_to_float(uint16_t(h));
+        if (std::isnan(f)) CHECK((float_to_half(f) & 0x7fff) == ((h & 0x7fff) | 0x200));
+        else CHECK(float_to_half(f) == h);
+    }
+
+    // the nearest half
+    std::minstd_rand rnd(9);
+    std::uniform_real_distribution<float> d(-70000, 70000);
+    for (int i = 0; i < 10000; ++i)
+    {
+        const float f = i % 2 ? d(rnd) : d(rnd) * 1e-6f;
+        const uint16_t h = float_to_half(f);
+        if (std::abs(f) >= 65520) continue;
+        const float r = half_to_float(h);
+        // the neighbors are no closer
+        for (int k : {-1, 1})
+        {
+            const uint16_t n = uint16_t(h + k);
+            if ((n & 0x7c00) == 0x7c00 || ((n ^ h) & 0x8000)) continue;
+            CHECK(std::abs(half_to_float(n) - f) >= std::abs(r - f));
+        }
+    }
+}
+
+TEST_CASE("software")
+{
+    // the same as the instructions when they're used
+    for (uint32_t h = 0; h < 0x10000; ++h)
+    {
+        CHECK(to_bits(simd::impl::half_to_float(uint16_t(h))) == to_bits(simd::half_to_float(uint16_t(h))));
+    }
+
+    std::minstd_rand rnd(21);
+    for (int i = 0; i < 100000; ++i)
+    {
+        // all exponents, and the rounding boundaries of the low bits
+        uint32_t u = uint32_t(rnd()) ^ uint32_t(rnd()) << 16;
+        if (i % 2) u = (u & 0xffff0000) | (0x1000 + (i % 5) - 2);
+        const float f = from_bits(u);
+        CHECK(simd::impl::float_to_half(f) == simd::float_to_half(f));
+    }
+}
+
+namespace
+{
+template <size_t D>
+void test_batch()
+{
+    using fvec = typename dim<D>::template vector_t<float>;
+    std::minstd_rand rnd(17);
+    std::uniform_real_distribution<float> d(-100, 100);
+    std::vector<fvec> vs(40);
+    for (auto& v : vs)
+    {
+        for (size_t i = 0; i < D; ++i) v.at(i) = d(rnd);
+    }
+    vs[0].at(0) = 1e6f;
+    vs[1].at(D - 1) = std::ldexp(1.f, -20);
+    vs[2].at(1) = std::numeric_limits<float>::quiet_NaN();
+
+    for (size_t count : {0, 1, 2, 3, 4, 5, 8, 9, 40})
+    {
+        std::vector<vector_half_t<D>> h(count + 1);
+        for (auto& b : h.back().bits) b = 0x1234;
+        pack(vs.data(), count, h.data());
+        CHECK(h.back().bits[0] == 0x1234);
+
+        std::vector<fvec> u(count + 1, fvec::uniform(7));
+        unpack(h.data(), count, u.data());
+        CHECK(u.back() == fvec::uniform(7));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(h[i] == vector_half_t<D>::pack(vs[i]));
+            for (size_t j = 0; j < D; ++j) CHECK(to_bits(u[i].at(j)) == to_bits(h[i].unpack().at(j)));
+        }
+    }
+
+    const auto h = vector_half_t<D>::pack(vs[3]);
+    CHECK(h.unpack() == YamaApprox(vs[3]).epsilon(0.05f));
+    CHECK(h != vector_half_t<D>::pack(vs[4]));
+}
+}
+
+TEST_CASE("vectors")
+{
+    static_assert(sizeof(vector2h) == 4, "2 halves");
+    static_assert(sizeof(vector3h) == 6, "3 halves");
+    static_assert(sizeof(vector4h) == 8, "4 halves");
+
+    CHECK(vector3h::pack(v(1, -2, 0.5f)).unpack() == v(1, -2, 0.5f));
+    CHECK(vector2h::pack(vector2::coord(1, 3)).bits[1] == 0x4200);
+
+    test_batch<2>();
+    test_batch<3>();
+    test_batch<4>();
+}
@@ -0,0 +1,189 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include "yama/vector_soa.hpp"
+#include "common.hpp"
+#include "yama/ext/ostream.hpp"
+
+#include <vector>
+#include <cstdint>
+
+using namespace yama;
+using doctest::Approx;
+
+TEST_SUITE_BEGIN("vector_soa");
+
+namespace
+{
+std::vector<vector3> points(size_t count)
+{
+    std::vector<vector3> ret(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto f = float(i);
+        ret[i] = v(f * 0.1f - 0.9f, f * 0.05f + 0.1f, 0.3f - f * f * 0.001f);
+    }
+    return ret;
+}
+}
+
+TEST_CASE("storage")
+{
+    vector3_soa s;
+    CHECK(s.empty());
+    CHECK(s.size() == 0);
+    CHECK(s.pack_end() == 0);
+
+    // copies of empty streams, with and without lanes
+    auto empty_copy = s;
+    CHECK(empty_copy.empty());
+    vector3_soa full(3);
+    full = s;
+    CHECK(full.empty());
+    CHECK(full.capacity() >= 3);
+
+    s.resize(5);
+    CHECK(s.size() == 5);
+    CHECK(s.capacity() >= 5);
+    CHECK(s.capacity() % vector3_soa::lane_granularity == 0);
+    for (size_t d = 0; d < 3; ++d)
+    {
+        CHECK(reinterpret_cast<uintptr_t>(s.lane(d)) % vector3_soa::lane_alignment == 0);
+    }
+    CHECK(s.get(4) == vector3::zero());
+    CHECK(s.x() == s.lane(0));
+    CHECK(s.z() == s.lane(2));
+
+    s.set(2, v(1, 2, 3));
+    CHECK(s.get(2) == v(1, 2, 3));
+    CHECK(s.y()[2] == 2);
+
+    for (int i = 0; i < 40; ++i)
+    {
+        s.push_back(v(float(i), 0, 0));
+    }
+    CHECK(s.size() == 45);
+    CHECK(s.get(2) == v(1, 2, 3));
+    CHECK(s.get(44) == v(39, 0, 0));
+
+    auto copy = s;
+    CHECK(copy.size() == 45);
+    CHECK(copy.get(2) == v(1, 2, 3));
+    CHECK(copy.get(44) == v(39, 0, 0));
+
+    auto moved = std::move(copy);
+    CHECK(moved.size() == 45);
+    CHECK(moved.get(44) == v(39, 0, 0));
+
+    s.clear();
+    CHECK(s.empty());
+    s.resize(3);
+    CHECK(s.get(2) == vector3::zero());
+}
+
+TEST_CASE("conversion")
+{
+    for (size_t count : {0, 1, 7, 8, 9, 16, 37})
+    {
+        auto ps = points(count);
+        vector3_soa s(ps.data(), count);
+        CHECK(s.size() == count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(s.get(i) == ps[i]);
+        }
+
+        std::vector<vector3> out(count);
+        s.copy_to(out.data());
+        CHECK(out == ps);
+
+        std::vector<float> flat(count * 3);
+        s.copy_to(flat.data());
+        vector3_soa s2;
+        s2.assign(flat.data(), count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(s2.get(i) == ps[i]);
+        }
+    }
+
+    vector4 v4[5];
+    for (int i = 0; i < 5; ++i) v4[i] = vector4::coord(float(i), 1, 2, float(-i));
+    vector4_soa s4(v4, 5);
+    CHECK(s4.get(3) == v4[3]);
+    CHECK(s4.w()[4] == -4);
+
+    vector2_t<double> v2[3] = {{1, 2}, {3, 4}, {5, 6}};
+    vector_soa_t<2, double> s2(v2, 3);
+    vector2_t<double> o2[3];
+    s2.copy_to(o2);
+    CHECK(o2[2] == v2[2]);
+}
+
+TEST_CASE("arithmetic")
+{
+    auto ps = points(19);
+    vector3_soa a(ps.data(), ps.size());
+    auto b = a;
+
+    b += a;
+    for (size_t i = 0; i < ps.size(); ++i) CHECK(b.get(i) == ps[i] * 2.f);
+    b -= a;
+    for (size_t i = 0; i < ps.size(); ++i) CHECK(b.get(i) == ps[i]);
+    b += v(1, 2, 3);
+    for (size_t i = 0; i < ps.size(); ++i) CHECK(b.get(i) == ps[i] + v(1, 2, 3));
+    b -= v(1, 2, 3);
+    b *= 3.f;
+    for (size_t i = 0; i < ps.size(); ++i) CHECK(YamaApprox(b.get(i)) == ps[i] * 3.f);
+    b /= 3.f;
+    for (size_t i = 0; i < ps.size(); ++i) CHECK(YamaApprox(b.get(i)) == ps[i]);
+}
+
+TEST_CASE("kernels")
+{
+    auto pa = points(21);
+    auto pb = points(30);
+    pb.erase(pb.begin(), pb.begin() + 9);
+    vector3_soa a(pa.data(), pa.size());
+    vector3_soa b(pb.data(), pb.size());
+
+    std::vector<float> out(pa.size() + 1, 42.f);
+    dot(a, b, out.data());
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(Approx(out[i]) == dot(pa[i], pb[i]));
+    CHECK(out.back() == 42); // no overrun
+
+    length_sq(a, out.data());
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(Approx(out[i]) == pa[i].length_sq());
+
+    length(a, out.data());
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(Approx(out[i]) == pa[i].length());
+
+    distance_sq(a, b, out.data());
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(Approx(out[i]) == distance_sq(pa[i], pb[i]));
+
+    distance_sq(a, v(1, 2, 3), out.data());
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(Approx(out[i]) == distance_sq(pa[i], v(1, 2, 3)));
+    CHECK(out.back() == 42);
+
+    vector3_soa c;
+    cross(a, b, c);
+    CHECK(c.size() == a.size());
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(YamaApprox(c.get(i)) == cross(pa[i], pb[i]));
+
+    normalize(a, c);
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(YamaApprox(c.get(i)) == normalize(pa[i]));
+
+    // in place
+    cross(a, b, a);
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(YamaApprox(a.get(i)) == cross(pa[i], pb[i]));
+    normalize(a, a);
+    for (size_t i = 0; i < pa.size(); ++i) CHECK(YamaApprox(a.get(i)) == normalize(cross(pa[i], pb[i])));
+
+    vector4_t<double> d4[3] = {{1, 2, 3, 4}, {0, 0, 1, 0}, {2, 0, 0, 0}};
+    vector_soa_t<4, double> s4(d4, 3);
+    double dd[3];
+    length(s4, dd);
+    CHECK(Approx(dd[0]) == d4[0].length());
+    CHECK(dd[1] == 1);
+    CHECK(dd[2] == 2);
+}